@@ -0,0 +1,244 @@
+/** @file bench.c
+ * @brief Microbenchmarks of the parser and launcher hot paths
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Programme *minishell-bench* (cible *make bench*), lié à libminishell.a. Chaque mesure est répétée en
+ *    BENCH_SAMPLES échantillons ; un échantillon chronomètre un lot d'opérations dont la taille est calibrée pour durer
+ *    au moins BENCH_MIN_SAMPLE_NS (une seule opération par échantillon pour les lancements de processus).
+ *
+ *    Une ligne JSON par mesure est écrite sur la sortie standard : nom, nombre total d'opérations, moyenne, minimum,
+ *    percentiles 50, 90 et 99 et maximum des échantillons, en nanosecondes par opération. Un argument optionnel
+ *    restreint l'exécution aux mesures dont le nom contient cette chaîne (ex: *minishell-bench parse*).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "parser.h"
+#include "processus.h"
+#include "options.h"
+#include "vars.h"
+
+/// Nombre d'échantillons par mesure
+#define BENCH_SAMPLES 200
+
+/// Durée minimale d'un échantillon lors de la calibration de la taille des lots
+#define BENCH_MIN_SAMPLE_NS 50000
+
+/// Taille des tampons des mesures substenv et replace
+#define BENCH_STR_SIZE 8192
+
+/** @brief Description d'une mesure.
+ * @struct bench_t
+ */
+typedef struct {
+    const char* name;      ///< Nom de la mesure (champ *bench* de la ligne JSON)
+    void (*fn)(void* arg); ///< Opération mesurée
+    void* arg;             ///< Argument de l'opération
+    int single;            ///< 1 : ligne *arg* analysée avant chaque échantillon, puis une seule opération chronométrée
+    const char* option;    ///< Option du shell fixée pendant la mesure (voir set_option()), NULL si aucune
+    const char* value;     ///< Valeur de l'option
+} bench_t;
+
+/** @brief Lignes représentatives pour parse_command_line(). */
+static const char* const parse_corpus[] = {
+    "ls -l",
+    "echo \"$HOME\" 'a b' c\\ d ~/x $? > /dev/null",
+    "ls | sort | uniq -c | sort -rn | head -n 5 > /dev/null",
+    "true && echo ok > /dev/null || echo ko 2> /dev/null; false",
+    "cat < /dev/null 2>&1 | wc -l >> /dev/null &",
+};
+
+/// Nombre de lignes du corpus
+#define PARSE_CORPUS_SIZE (sizeof(parse_corpus) / sizeof(parse_corpus[0]))
+
+static command_line_t bench_cmdl;          ///< Ligne de commande réutilisée par toutes les mesures
+static char subst_src[BENCH_STR_SIZE];     ///< Entrée de la mesure substenv (64 variables)
+static char replace_src[BENCH_STR_SIZE];   ///< Entrée de la mesure replace (128 occurrences)
+static char work[BENCH_STR_SIZE];          ///< Copie de travail des mesures substenv et replace
+
+/** @brief Lecture de l'horloge des mesures (ns). */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/** @brief Instanciation de tous les tubes de la ligne analysée (mots, tubes, redirections), sans lancement. */
+static void instantiate_all(void) {
+    for (control_flow_t* cf = bench_cmdl.flow; cf != NULL; ) {
+        instantiate_pipeline(cf);
+        while (cf->pipe_next) cf = cf->pipe_next;
+        if (cf->on_success_next) cf = cf->on_success_next;
+        else if (cf->on_failure_next) cf = cf->on_failure_next;
+        else cf = cf->unconditionnal_next;
+    }
+}
+
+/** @brief Analyse et instanciation d'une ligne, puis fermeture des tubes et fichiers ouverts par l'instanciation. */
+static void bench_parse(void* arg) {
+    const char* line = arg;
+    init_command_line(&bench_cmdl);
+    if (parse_command_line(&bench_cmdl, line, strlen(line)) != 0) {
+        fprintf(stderr, "bench: analyse impossible : %s\n", line);
+        exit(1);
+    }
+    instantiate_all();
+    close_fds(&bench_cmdl);
+}
+
+/** @brief Analyse de toutes les lignes du corpus. */
+static void bench_parse_corpus(void* arg) {
+    (void)arg;
+    for (size_t i = 0; i < PARSE_CORPUS_SIZE; i++) bench_parse((void*)parse_corpus[i]);
+}
+
+/** @brief Substitution des variables de subst_src. */
+static void bench_substenv(void* arg) {
+    (void)arg;
+    strcpy(work, subst_src);
+    substenv(work, sizeof(work));
+}
+
+/** @brief Remplacement de toutes les occurrences de "ab" dans replace_src. */
+static void bench_replace(void* arg) {
+    (void)arg;
+    strcpy(work, replace_src);
+    replace(work, "ab", "xyz", sizeof(work));
+}
+
+/** @brief Remise à zéro de la ligne de commande. */
+static void bench_init(void* arg) {
+    (void)arg;
+    init_command_line(&bench_cmdl);
+}
+
+/** @brief Lancement et attente de la première commande de la ligne analysée par run_single(). */
+static void bench_launch(void* arg) {
+    (void)arg;
+    launch_processus(bench_cmdl.flow->proc);
+}
+
+/** @brief Comparaison de deux durées pour qsort(). */
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Percentile *p* (0 à 100) d'un tableau trié de *n* valeurs (rang le plus proche). */
+static double percentile(const double* sorted, int n, double p) {
+    return sorted[(int)(p / 100.0 * (n - 1) + 0.5)];
+}
+
+/** @brief Échantillon d'une mesure *single* : analyse de la ligne hors chronométrage, puis une opération. */
+static double run_single(const bench_t* b) {
+    const char* line = b->arg;
+    init_command_line(&bench_cmdl);
+    if (parse_command_line(&bench_cmdl, line, strlen(line)) != 0) {
+        fprintf(stderr, "bench: analyse impossible : %s\n", line);
+        exit(1);
+    }
+    instantiate_pipeline(bench_cmdl.flow);
+
+    uint64_t start = now_ns();
+    b->fn(NULL);
+    double ns = (double)(now_ns() - start);
+    close_fds(&bench_cmdl);
+    return ns;
+}
+
+/** @brief Exécution d'une mesure et écriture de sa ligne JSON. */
+static void run_bench(const bench_t* b) {
+    double samples[BENCH_SAMPLES];
+    double total = 0;
+    long batch = 1;
+
+    shell_options_t saved = shell_options;
+    if (b->option && set_option(b->option, b->value) != 0) {
+        fprintf(stderr, "bench: option invalide %s=%s\n", b->option, b->value);
+        exit(1);
+    }
+
+    // Calibration : le lot double jusqu'à durer BENCH_MIN_SAMPLE_NS (elle sert aussi de préchauffage)
+    if (b->single) {
+        run_single(b);
+    } else {
+        while (1) {
+            uint64_t start = now_ns();
+            for (long i = 0; i < batch; i++) b->fn(b->arg);
+            if (now_ns() - start >= BENCH_MIN_SAMPLE_NS) break;
+            batch *= 2;
+        }
+    }
+
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+        if (b->single) {
+            samples[s] = run_single(b);
+        } else {
+            uint64_t start = now_ns();
+            for (long i = 0; i < batch; i++) b->fn(b->arg);
+            samples[s] = (double)(now_ns() - start) / batch;
+        }
+        total += samples[s];
+    }
+    qsort(samples, BENCH_SAMPLES, sizeof(double), compare_double);
+    shell_options = saved;
+
+    printf("{\"bench\":\"%s\",\"ops\":%ld,\"mean_ns\":%.1f,\"min_ns\":%.1f,\"p50_ns\":%.1f,\"p90_ns\":%.1f,"
+           "\"p99_ns\":%.1f,\"max_ns\":%.1f}\n",
+           b->name, batch * BENCH_SAMPLES, total / BENCH_SAMPLES, samples[0], percentile(samples, BENCH_SAMPLES, 50),
+           percentile(samples, BENCH_SAMPLES, 90), percentile(samples, BENCH_SAMPLES, 99), samples[BENCH_SAMPLES - 1]);
+    fflush(stdout);
+}
+
+/** @brief Préparation des entrées des mesures substenv et replace. */
+static void init_strings(void) {
+    char name[32];
+    size_t len = 0;
+
+    for (int i = 0; i < 64; i++) {
+        snprintf(name, sizeof(name), "BENCH_VAR_%d", i);
+        vars_set(name, "valeur", 1);
+        len += snprintf(subst_src + len, sizeof(subst_src) - len, "a$%s ${%s}/", name, name);
+    }
+
+    len = 0;
+    for (int i = 0; i < 128; i++) len += snprintf(replace_src + len, sizeof(replace_src) - len, "ab-");
+}
+
+/** @brief Programme principal des microbenchmarks.
+ * @param argc Nombre d'arguments.
+ * @param argv Tableau des arguments : filtre optionnel sur le nom des mesures.
+ * @return int 0 en cas de succès.
+ */
+int main(int argc, char* argv[]) {
+    const char* filter = (argc > 1) ? argv[1] : NULL;
+    static char names[PARSE_CORPUS_SIZE][32];
+    bench_t benches[PARSE_CORPUS_SIZE + 8];
+    size_t n = 0;
+
+    init_strings();
+
+    for (size_t i = 0; i < PARSE_CORPUS_SIZE; i++) {
+        snprintf(names[i], sizeof(names[i]), "parse_command_line/%zu", i);
+        benches[n++] = (bench_t){names[i], bench_parse, (void*)parse_corpus[i], 0, NULL, NULL};
+    }
+    benches[n++] = (bench_t){"parse_command_line/corpus", bench_parse_corpus, NULL, 0, NULL, NULL};
+    benches[n++] = (bench_t){"parse_command_line/corpus_nocache", bench_parse_corpus, NULL, 0, "plancache", "0"};
+    benches[n++] = (bench_t){"substenv/64_vars", bench_substenv, NULL, 0, NULL, NULL};
+    benches[n++] = (bench_t){"replace/128_matches", bench_replace, NULL, 0, NULL, NULL};
+    benches[n++] = (bench_t){"init_command_line", bench_init, NULL, 0, NULL, NULL};
+    benches[n++] = (bench_t){"launch_processus/builtin", bench_launch, "true", 1, NULL, NULL};
+    benches[n++] = (bench_t){"launch_processus/fork", bench_launch, "/bin/true", 1, "spawn", "fork"};
+    benches[n++] = (bench_t){"launch_processus/posix_spawn", bench_launch, "/bin/true", 1, "spawn", "posix_spawn"};
+
+    for (size_t i = 0; i < n; i++) {
+        if (filter == NULL || strstr(benches[i].name, filter) != NULL) run_bench(&benches[i]);
+    }
+
+    free_command_line(&bench_cmdl);
+    return 0;
+}
@@ -0,0 +1,401 @@
+/** @file replay.c
+ * @brief End-to-end replay of a recorded command log
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Programme *minishell-replay* (cible *make replay*), lié à libminishell.a. Il rejoue un journal de commandes
+ *    (une ligne de commande par ligne de fichier) et mesure le débit soutenu et la latence par ligne :
+ *
+ *        minishell-replay [-m embedded|stdin|c] [-x shell] [-n répétitions] journal
+ *
+ *    Modes :
+ *    - *embedded* (par défaut) : lignes analysées et lancées dans ce processus par parse_command_line() et
+ *      launch_command_line(), comme la boucle de main.c. Une ligne *exit* termine donc le rejeu.
+ *    - *stdin* : le programme *-x* (./minishell par défaut, ou /bin/sh pour comparaison) lit les lignes sur son entrée
+ *      standard ; chaque ligne est suivie de *echo* d'un marqueur attendu sur sa sortie avant d'envoyer la suivante.
+ *    - *c* : tout le journal est passé en une fois à *-x -c* : débit seulement, sans latence par ligne.
+ *
+ *    La sortie des commandes est jetée. Le résultat est une ligne JSON : shell, mode, nombre de lignes, durée totale,
+ *    lignes par seconde, latences p50, p99 et maximale (ns), pic de mémoire résidente du shell (VmHWM) et du plus gros
+ *    de ses fils (Kio), et nombre maximal de descripteurs ouverts par le shell pendant une ligne (mode *embedded*
+ *    uniquement : mesuré après l'ouverture des tubes et redirections, -1 dans les autres modes).
+ */
+
+#define _GNU_SOURCE // pipe2(), memmem()
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "parser.h"
+#include "processus.h"
+#include "jobs.h"
+
+/** @brief Résultats d'un rejeu.
+ * @struct replay_stats_t
+ */
+typedef struct {
+    uint64_t* latencies; ///< Latence de chaque ligne rejouée (ns), NULL en mode *c*
+    size_t num_lines;    ///< Nombre de lignes rejouées
+    uint64_t total_ns;   ///< Durée totale du rejeu
+    long shell_rss_kib;  ///< Pic de mémoire résidente du shell
+    int fd_max;          ///< Nombre maximal de descripteurs ouverts par le shell, -1 si non mesuré
+} replay_stats_t;
+
+/** @brief Lecture de l'horloge des mesures (ns). */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/** @brief Lecture du journal : tableau des lignes non vides, terminé par NULL.
+ * @return char** Lignes (allouées), NULL si le fichier ne peut pas être lu.
+ */
+static char** read_log(const char* path, size_t* num_lines) {
+    FILE* f = fopen(path, "r");
+    if (!f) return NULL;
+
+    char** lines = NULL;
+    size_t count = 0, cap = 0;
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &size, f)) >= 0) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+        if (len == 0) continue;
+        if (count + 1 >= cap) {
+            cap = cap ? cap * 2 : 64;
+            lines = realloc(lines, cap * sizeof(char*));
+            if (!lines) exit(1);
+        }
+        lines[count++] = strdup(line);
+    }
+    free(line);
+    fclose(f);
+    if (count == 0) return NULL;
+    lines[count] = NULL;
+    *num_lines = count;
+    return lines;
+}
+
+/** @brief Nombre de descripteurs ouverts par le processus (hors celui du parcours). */
+static int count_fds(void) {
+    DIR* dir = opendir("/proc/self/fd");
+    if (!dir) return -1;
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') count++;
+    }
+    closedir(dir);
+    return count - 1;
+}
+
+/** @brief Pic de mémoire résidente d'un processus (ligne VmHWM de /proc/PID/status), en Kio. */
+static long peak_rss(pid_t pid) {
+    char path[64], line[256];
+    long kib = -1;
+
+    snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "VmHWM: %ld", &kib) == 1) break;
+    }
+    fclose(f);
+    return kib;
+}
+
+/** @brief Rejeu dans ce processus, avec les fonctions du shell. */
+static void replay_embedded(char** lines, size_t num_lines, int repeat, replay_stats_t* stats) {
+    command_line_t cmdl = {0};
+
+    jobs_init();
+
+    uint64_t start = now_ns();
+    for (int r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < num_lines; i++) {
+            // Comptage des descripteurs entre l'analyse et le lancement, hors latence de la ligne
+            uint64_t t0 = now_ns();
+            init_command_line(&cmdl);
+            jobs_update();
+            int parsed = parse_command_line(&cmdl, lines[i], strlen(lines[i]));
+            uint64_t t1 = now_ns();
+            int fds = count_fds();
+            if (fds > stats->fd_max) stats->fd_max = fds;
+            uint64_t t2 = now_ns();
+            if (parsed == 0) launch_command_line(&cmdl);
+            uint64_t t3 = now_ns();
+
+            stats->latencies[stats->num_lines++] = (t1 - t0) + (t3 - t2);
+            start += t2 - t1;
+        }
+    }
+    jobs_wait_all();
+    stats->total_ns = now_ns() - start;
+    stats->shell_rss_kib = peak_rss(getpid());
+    free_command_line(&cmdl);
+}
+
+/** @brief Création du shell *argv*, entrée et sortie standards reliées à des tubes.
+ * @param to_shell Bout d'écriture vers l'entrée du shell (NULL : entrée sur /dev/null).
+ * @param from_shell Bout de lecture de la sortie du shell.
+ */
+static pid_t start_shell(char* const argv[], int* to_shell, int* from_shell) {
+    int in[2], out[2];
+    if (pipe2(out, O_CLOEXEC) != 0) return -1;
+    if (to_shell && pipe2(in, O_CLOEXEC) != 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        signal(SIGPIPE, SIG_DFL);
+        int null_fd = open("/dev/null", O_RDONLY);
+        dup2(to_shell ? in[0] : null_fd, STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        execvp(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+
+    close(out[1]);
+    *from_shell = out[0];
+    if (to_shell) {
+        close(in[0]);
+        *to_shell = in[1];
+    }
+    return pid;
+}
+
+/** @brief Lecture de la sortie du shell jusqu'au marqueur *marker* (jeté avec tout ce qui le précède).
+ * @param tail Derniers octets lus lors de l'appel précédent (marqueur à cheval sur deux lectures).
+ * @return int 0 si le marqueur a été lu, -1 si le shell s'est terminé avant.
+ */
+static int read_until(int fd, const char* marker, char* tail, size_t* tail_len) {
+    char buf[65536 + 64];
+    size_t mlen = strlen(marker);
+
+    while (1) {
+        memcpy(buf, tail, *tail_len);
+        ssize_t n = read(fd, buf + *tail_len, 65536);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        size_t len = *tail_len + n;
+
+        char* found = memmem(buf, len, marker, mlen);
+        size_t keep = (len < mlen) ? len : mlen - 1;
+        if (found) {
+            // Les octets qui suivent le marqueur appartiennent à la ligne suivante
+            size_t after = len - (found + mlen - buf);
+            if (after > 64) after = 64;
+            memmove(tail, found + mlen, after);
+            *tail_len = after;
+            return 0;
+        }
+        memmove(tail, buf + len - keep, keep);
+        *tail_len = keep;
+    }
+}
+
+/** @brief Écriture complète d'une chaîne dans l'entrée du shell. */
+static int write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief Rejeu ligne à ligne sur l'entrée standard d'un shell externe. */
+static int replay_stdin(const char* shell, char** lines, size_t num_lines, int repeat, replay_stats_t* stats) {
+    char* argv[] = {(char*)shell, NULL};
+    int to_shell, from_shell;
+    pid_t pid = start_shell(argv, &to_shell, &from_shell);
+    if (pid < 0) return -1;
+
+    char* text = NULL;
+    size_t text_size = 0;
+    char marker[64];
+    char tail[64];
+    size_t tail_len = 0;
+    int ret = 0;
+
+    uint64_t start = now_ns();
+    for (int r = 0; r < repeat && ret == 0; r++) {
+        for (size_t i = 0; i < num_lines; i++) {
+            snprintf(marker, sizeof(marker), "@replay%zu@\n", stats->num_lines);
+            size_t need = strlen(lines[i]) + strlen(marker) + 8;
+            if (need > text_size) {
+                text_size = need * 2;
+                text = realloc(text, text_size);
+                if (!text) exit(1);
+            }
+            int len = snprintf(text, text_size, "%s\necho %s", lines[i], marker);
+
+            uint64_t t0 = now_ns();
+            if (write_all(to_shell, text, len) != 0 || read_until(from_shell, marker, tail, &tail_len) != 0) {
+                fprintf(stderr, "minishell-replay: %s s'est terminé à la ligne : %s\n", shell, lines[i]);
+                ret = -1;
+                break;
+            }
+            stats->latencies[stats->num_lines++] = now_ns() - t0;
+        }
+    }
+    stats->total_ns = now_ns() - start;
+    stats->shell_rss_kib = peak_rss(pid);
+
+    close(to_shell);
+    char buf[4096];
+    while (read(from_shell, buf, sizeof(buf)) > 0) {}
+    close(from_shell);
+    waitpid(pid, NULL, 0);
+    free(text);
+    return ret;
+}
+
+/** @brief Rejeu de tout le journal en une seule invocation *shell -c*. */
+static int replay_c(const char* shell, char** lines, size_t num_lines, int repeat, replay_stats_t* stats) {
+    size_t size = 1;
+    for (size_t i = 0; i < num_lines; i++) size += strlen(lines[i]) + 1;
+    char* script = malloc(size * repeat);
+    if (!script) return -1;
+    size_t len = 0;
+    for (int r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < num_lines; i++) len += sprintf(script + len, "%s\n", lines[i]);
+    }
+
+    char* argv[] = {(char*)shell, "-c", script, NULL};
+    int from_shell;
+    char buf[65536];
+    int status;
+
+    uint64_t start = now_ns();
+    pid_t pid = start_shell(argv, NULL, &from_shell);
+    if (pid < 0) {
+        free(script);
+        return -1;
+    }
+
+    // Le pic de mémoire du shell est relevé à chaque lecture de sa sortie ; à défaut, celui que donne wait4()
+    // (shell et commandes confondus)
+    struct rusage rusage;
+    while (read(from_shell, buf, sizeof(buf)) > 0) stats->shell_rss_kib = peak_rss(pid);
+    wait4(pid, &status, 0, &rusage);
+    if (stats->shell_rss_kib < 0) stats->shell_rss_kib = rusage.ru_maxrss;
+    stats->total_ns = now_ns() - start;
+    stats->num_lines = num_lines * repeat;
+
+    close(from_shell);
+    free(script);
+    return 0;
+}
+
+/** @brief Comparaison de deux latences pour qsort(). */
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Écriture de la ligne JSON des résultats. */
+static void print_stats(FILE* out, const char* shell, const char* mode, replay_stats_t* stats) {
+    struct rusage children;
+    getrusage(RUSAGE_CHILDREN, &children);
+
+    double seconds = stats->total_ns / 1e9;
+    fprintf(out, "{\"shell\":\"%s\",\"mode\":\"%s\",\"lines\":%zu,\"seconds\":%.6f,\"lines_per_sec\":%.1f,",
+            shell, mode, stats->num_lines, seconds, stats->num_lines / seconds);
+    if (stats->latencies && stats->num_lines > 0) {
+        size_t n = stats->num_lines;
+        qsort(stats->latencies, n, sizeof(uint64_t), compare_u64);
+        fprintf(out, "\"p50_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu,", (unsigned long long)stats->latencies[(n - 1) / 2],
+                (unsigned long long)stats->latencies[(n - 1) * 99 / 100], (unsigned long long)stats->latencies[n - 1]);
+    } else {
+        fprintf(out, "\"p50_ns\":null,\"p99_ns\":null,\"max_ns\":null,");
+    }
+    fprintf(out, "\"shell_max_rss_kib\":%ld,\"child_max_rss_kib\":%ld,\"fd_max\":%d}\n",
+            stats->shell_rss_kib, children.ru_maxrss, stats->fd_max);
+}
+
+/** @brief Affichage de l'usage. */
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-m embedded|stdin|c] [-x shell] [-n répétitions] journal\n", name);
+}
+
+/** @brief Programme principal du rejeu.
+ * @param argc Nombre d'arguments.
+ * @param argv Tableau des arguments (voir l'en-tête du fichier).
+ * @return int 0 en cas de succès, 1 en cas d'erreur de rejeu, 2 en cas d'usage incorrect.
+ */
+int main(int argc, char* argv[]) {
+    const char* mode = "embedded";
+    const char* shell = "./minishell";
+    int repeat = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:x:n:")) != -1) {
+        switch (opt) {
+            case 'm': mode = optarg; break;
+            case 'x': shell = optarg; break;
+            case 'n': repeat = atoi(optarg); break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind != argc - 1 || repeat <= 0 ||
+        (strcmp(mode, "embedded") != 0 && strcmp(mode, "stdin") != 0 && strcmp(mode, "c") != 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t num_lines;
+    char** lines = read_log(argv[optind], &num_lines);
+    if (!lines) {
+        fprintf(stderr, "%s: journal vide ou illisible : %s\n", argv[0], argv[optind]);
+        return 1;
+    }
+
+    replay_stats_t stats = {NULL, 0, 0, -1, -1};
+    if (strcmp(mode, "c") != 0) {
+        stats.latencies = malloc(num_lines * repeat * sizeof(uint64_t));
+        if (!stats.latencies) return 1;
+    }
+
+    // Résultats sur la sortie d'origine : la sortie standard des commandes rejouées part vers /dev/null
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (!out || null_fd < 0 || dup2(null_fd, STDOUT_FILENO) < 0) return 1;
+    close(null_fd);
+
+    // Comme dans main.c : une écriture vers un tube fermé (shell terminé, commande intégrée) renvoie EPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    int ret;
+    if (strcmp(mode, "embedded") == 0) {
+        positional_params = argv;
+        num_positional_params = 1;
+        replay_embedded(lines, num_lines, repeat, &stats);
+        shell = "minishell";
+        ret = 0;
+    } else if (strcmp(mode, "stdin") == 0) {
+        ret = replay_stdin(shell, lines, num_lines, repeat, &stats);
+    } else {
+        ret = replay_c(shell, lines, num_lines, repeat, &stats);
+    }
+
+    if (ret == 0) print_stats(out, shell, mode, &stats);
+    fclose(out);
+    for (size_t i = 0; i < num_lines; i++) free(lines[i]);
+    free(lines);
+    free(stats.latencies);
+    return ret == 0 ? 0 : 1;
+}
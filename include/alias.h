@@ -0,0 +1,74 @@
+/**
+ * @file alias.h
+ * @brief Header file for command aliases
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table des alias (table de hachage nom → expansion). La valeur d'un alias est découpée en
+ *    tokens par lex_command_line() une seule fois, à sa définition : lors de l'analyse d'une ligne, un mot en position de
+ *    nom de commande est remplacé par ces tokens sans que le texte de la ligne soit réécrit ni analysé de nouveau.
+ *
+ *    Le remplacement a lieu avant la construction du plan (voir parse_command_line()) : une ligne déjà dans le cache des
+ *    plans ne coûte aucune recherche d'alias. Toute modification de la table doit donc vider le cache des plans.
+ */
+
+#ifndef ALIAS_H
+#define ALIAS_H
+
+#include <stddef.h>
+
+#include "processus.h"
+#include "outbuf.h"
+
+/** @brief Alias : nom, valeur telle que définie et tokens de la valeur.
+ * @struct alias_t
+ */
+typedef struct {
+    char* name;        ///< Nom de l'alias
+    char* value;       ///< Valeur telle que définie (affichage)
+    token_t* tokens;   ///< Tokens de la valeur (tranches d'une copie de la valeur propre à l'alias)
+    size_t num_tokens; ///< Nombre de tokens
+    int blank;         ///< La valeur se termine par un blanc : le mot suivant peut aussi être un alias
+} alias_t;
+
+/** @brief Fonction de création ou de modification d'un alias.
+ * @param name Nom de l'alias (non vide, sans blanc, guillemet, '=', '/', '$' ni opérateur).
+ * @param value Valeur de l'alias : commande(s) avec la syntaxe d'une ligne (opérateurs et redirections compris).
+ * @return int 0 en cas de succès, -1 si le nom ou la valeur est invalide (*errno* vaut EINVAL) ou en cas d'échec d'allocation.
+ */
+int alias_set(const char* name, const char* value);
+
+/** @brief Fonction de suppression d'un alias.
+ * @param name Nom de l'alias.
+ * @return int 0 en cas de succès, -1 si l'alias n'existe pas.
+ */
+int alias_unset(const char* name);
+
+/** @brief Fonction de suppression de tous les alias. */
+void alias_clear(void);
+
+/** @brief Fonction de recherche d'un alias dont le nom n'est pas terminé par '\0'.
+ * @param name Début du nom (ex: un token de la ligne de commande).
+ * @param len Longueur du nom.
+ * @return const alias_t* Alias trouvé, NULL s'il n'existe pas. Le pointeur reste valide jusqu'à la prochaine
+ *    modification de l'alias.
+ */
+const alias_t* alias_find(const char* name, size_t len);
+
+/** @brief Fonction de lecture du nombre d'alias définis.
+ * @return size_t Nombre d'alias (0 : l'analyse des lignes ne fait aucune recherche).
+ */
+size_t alias_count(void);
+
+/** @brief Fonction d'affichage d'un alias sous la forme *alias nom='valeur'*, réutilisable comme commande.
+ * @param alias Alias à afficher.
+ * @param out Tampon de sortie.
+ */
+void alias_print(const alias_t* alias, outbuf_t* out);
+
+/** @brief Fonction d'affichage de tous les alias, triés par nom.
+ * @param out Tampon de sortie.
+ */
+void alias_print_all(outbuf_t* out);
+
+#endif // ALIAS_H
@@ -0,0 +1,73 @@
+/**
+ * @file arena.h
+ * @brief Header file for the line arena allocator
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'allocateur par arène ("bump allocator") utilisé pour toutes les données d'une ligne de commande.
+ *    Les allocations sont des incréments de pointeur dans une liste de blocs ; tout est libéré d'un coup par arena_reset().
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/** @brief Bloc mémoire d'une arène.
+ * @struct arena_block_t
+ */
+typedef struct arena_block {
+    struct arena_block* next; ///< Bloc suivant (conservé après remise à zéro pour être réutilisé)
+    size_t size;              ///< Taille de la zone *data*
+    size_t used;              ///< Octets utilisés dans *data*
+    char data[];              ///< Zone d'allocation
+} arena_block_t;
+
+/** @brief Arène mémoire.
+ * @struct arena_t
+ * @details Une arène mise à zéro (ex: `arena_t a = {0};`) est vide et prête à l'emploi.
+ */
+typedef struct {
+    arena_block_t* head;    ///< Premier bloc
+    arena_block_t* current; ///< Bloc dans lequel se font les allocations
+    void* last;             ///< Dernière allocation (peut être agrandie sur place)
+} arena_t;
+
+/** @brief Fonction d'allocation dans une arène.
+ * @param arena Arène.
+ * @param size Taille demandée.
+ * @return void* Zone alignée sur 16 octets, non initialisée, ou NULL en cas d'échec de malloc.
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/** @brief Fonction de redimensionnement d'une zone allouée dans une arène.
+ * @param arena Arène.
+ * @param ptr Zone à redimensionner (NULL : équivalent à arena_alloc()).
+ * @param old_size Taille actuelle de la zone.
+ * @param new_size Nouvelle taille.
+ * @return void* Zone redimensionnée (contenu conservé dans la limite de la plus petite taille), ou NULL en cas d'échec.
+ * @details Si *ptr* est la dernière allocation et que le bloc courant le permet, la zone est agrandie ou réduite sur place ;
+ *    sinon une nouvelle zone est allouée et le contenu y est copié.
+ */
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_size, size_t new_size);
+
+/** @brief Fonction de copie d'une chaîne dans une arène.
+ * @param arena Arène.
+ * @param s Chaîne à copier.
+ * @param len Nombre de caractères à copier.
+ * @return char* Copie terminée par '\\0', ou NULL en cas d'échec.
+ */
+char* arena_strndup(arena_t* arena, const char* s, size_t len);
+
+/** @brief Fonction de remise à zéro d'une arène, en temps constant.
+ * @param arena Arène.
+ * @details Toutes les zones allouées deviennent invalides. Les blocs sont conservés et réutilisés par les allocations suivantes.
+ */
+void arena_reset(arena_t* arena);
+
+/** @brief Fonction de libération de tous les blocs d'une arène.
+ * @param arena Arène, laissée vide et réutilisable.
+ */
+void arena_free(arena_t* arena);
+
+#endif // ARENA_H
@@ -11,58 +11,292 @@
 #define BUILTINS_H
 
 #include "processus.h"
+#include "outbuf.h"
+
+/** @brief Entrées/sorties d'une commande intégrée.
+ * @struct builtin_io_t
+ * @details Les commandes intégrées n'utilisent ni stdio ni les descripteurs 0, 1 et 2 du shell : elles lisent *in* et écrivent
+ *    dans les tampons *out* et *err*, reliés aux descripteurs du processus (redirections, tubes). Le shell n'a donc pas à sauvegarder
+ *    puis restaurer ses propres descripteurs autour de chaque appel.
+ */
+typedef struct {
+    int in;       ///< Descripteur d'entrée
+    outbuf_t out; ///< Sortie standard
+    outbuf_t err; ///< Sortie d'erreur (non tamponnée, vide *out* avant chaque écriture pour garder l'ordre des messages)
+} builtin_io_t;
+
+/// La commande n'a aucun effet sur l'état du shell : dans un tube, elle peut s'exécuter dans le shell sans *fork()*
+#define BUILTIN_PURE 0x01
+/// La commande recopie un flux de taille quelconque : en mode interactif, elle s'exécute dans un fils pour rester
+/// interruptible (Ctrl+C, Ctrl+Z), le shell ignorant les signaux du terminal
+#define BUILTIN_STREAM 0x02
+
+/** @brief Description d'une commande intégrée.
+ * @struct builtin_t
+ */
+typedef struct {
+    const char* name;                                ///< Nom de la commande
+    int (*fn)(processus_t* cmd, builtin_io_t* io);   ///< Fonction d'exécution, retourne le statut de la commande
+    int flags;                                       ///< Combinaison de BUILTIN_PURE, BUILTIN_STREAM
+    int (*accepts)(const processus_t* cmd);          ///< Vérification des arguments (NULL : tous acceptés) ; si elle échoue, la commande externe du même nom est lancée
+} builtin_t;
+
+/** @brief Fonction de recherche d'une commande intégrée.
+ * @param cmd Structure de commande (le nom est *argv[0]*).
+ * @return const builtin_t* Description de la commande, NULL si elle n'est pas intégrée ou si ses arguments
+ *    (options non reconnues) ne sont pas acceptés par l'implémentation intégrée.
+ */
+const builtin_t* find_builtin(const processus_t* cmd);
 
 /** @brief Fonction de vérification si une commande est une commande "built-in".
- * @param cmd Structure de commande à vérifier. (Le champ *path* est utilisé pour vérifier le nom de la commande.)
+ * @param cmd Structure de commande à vérifier. (Le champ *argv[0]* est utilisé pour vérifier le nom de la commande.)
  * @return int 1 si la commande est intégrée, 0 sinon.
  * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd.
  */
 int is_builtin(const processus_t* cmd);
 
+/** @brief Fonction de vérification si une commande est intégrée et sans effet sur l'état du shell (BUILTIN_PURE).
+ * @param cmd Structure de commande à vérifier.
+ * @return int 1 si la commande peut s'exécuter dans le shell comme étage d'un tube, 0 sinon.
+ */
+int is_pure_builtin(const processus_t* cmd);
+
+/** @brief Fonction de vérification si une commande intégrée recopie un flux (BUILTIN_STREAM).
+ * @param cmd Structure de commande à vérifier.
+ * @return int 1 si la commande doit s'exécuter dans un fils en mode interactif, 0 sinon.
+ */
+int is_stream_builtin(const processus_t* cmd);
+
 /** @brief Fonction d'exécution d'une commande intégrée.
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Statut de la commande, -1 si elle n'est pas intégrée.
+ * @details Les entrées/sorties de la commande sont les descripteurs *stdin_fd*, *stdout_fd* et *stderr_fd* de *cmd*
+ *    (*stderr_fd* à -1 : même descripteur que la sortie standard). Les tampons sont vidés avant le retour.
  */
 int exec_builtin(processus_t* cmd);
 
 /** Fonctions spécifiques aux commandes intégrées. */
 /** @brief Fonction d'exécution de la commande "cd".
  * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Déplace le CWD du processus vers le répertoire spécifié dans le premier argument de la commande.
  *  Si aucun argument n'est fourni, le CWD est déplacé vers le répertoire HOME de l'utilisateur.
- *  En cas d'erreur (répertoire inexistant, permission refusée, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ *  En cas d'erreur (répertoire inexistant, permission refusée, etc.), un message d'erreur est affiché sur *io->err* et la fonction retourne un code d'erreur.
  */
-int builtin_cd(processus_t* cmd);
+int builtin_cd(processus_t* cmd, builtin_io_t* io);
 
 /** @brief Fonction d'exécution de la commande "exit".
  * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Termine le shell avec le code de sortie spécifié dans le premier argument de la commande.
- *  Si aucun argument n'est fourni, le shell se termine avec le code de sortie 0.
- *  En cas d'erreur (argument non numérique, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur
+ *  Si aucun argument n'est fourni, le shell se termine avec le statut de la dernière commande ($?).
+ *  En cas d'erreur (argument non numérique, etc.), un message d'erreur est affiché sur *io->err* et la fonction retourne un code d'erreur
  */
-int builtin_exit(processus_t* cmd);
+int builtin_exit(processus_t* cmd, builtin_io_t* io);
 
 /** @brief Fonction d'exécution de la commande "export".
  * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Ajoute ou modifie une variable d'environnement dans l'environnement du shell. En cas d'erreur (format invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Ajoute ou modifie une variable d'environnement dans l'environnement du shell. En cas d'erreur (format invalide, etc.), un message d'erreur est affiché sur *io->err* et la fonction retourne un code d'erreur.
  */
-int builtin_export(processus_t* cmd);
+int builtin_export(processus_t* cmd, builtin_io_t* io);
 
 /** @brief Fonction d'exécution de la commande "unset".
  * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Supprime une variable d'environnement de l'environnement du shell. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Supprime une variable d'environnement de l'environnement du shell. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *io->err* et la fonction retourne un code d'erreur.
  */
-int builtin_unset(processus_t* cmd);
+int builtin_unset(processus_t* cmd, builtin_io_t* io);
 
 /** @brief Fonction d'exécution de la commande "pwd".
  * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Affiche le répertoire de travail actuel (CWD) du processus sur la sortie standard *cmd->stdout*. En cas d'erreur, un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Affiche le répertoire de travail actuel (CWD) du processus sur la sortie standard *io->out*. En cas d'erreur, un message d'erreur est affiché sur *io->err* et la fonction retourne un code d'erreur.
+ */
+int builtin_pwd(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "echo".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Toujours 0.
+ * @details Affiche les arguments séparés par une espace, suivis d'un saut de ligne sur *io->out*.
+ *  Options (éventuellement regroupées, ex: *-ne*) : *-n* supprime le saut de ligne final, *-e* interprète les séquences
+ *  d'échappement (\\n, \\t, \\0nnn, \\xHH, \\c arrête la sortie...), *-E* les désactive (défaut).
+ */
+int builtin_echo(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "printf".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si un argument numérique est invalide ou si le format est incorrect.
+ * @details *printf format [argument...]* : conversions %s, %b, %c, %d, %i, %o, %u, %x, %X, %e, %f, %g et %%, avec drapeaux,
+ *  largeur et précision (y compris '*'). Le format est réutilisé tant qu'il reste des arguments ; les arguments manquants
+ *  valent une chaîne vide ou 0. Un argument numérique commençant par une apostrophe vaut le code de son caractère suivant.
+ */
+int builtin_printf(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "true".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Toujours 0.
+ */
+int builtin_true(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "false".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Toujours 1.
+ */
+int builtin_false(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution des commandes "test" et "[".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 si l'expression est vraie, 1 si elle est fausse, 2 en cas d'erreur de syntaxe.
+ * @details Opérateurs unaires sur les fichiers (-e, -f, -d, -r, -w, -x, -s, -h/-L, -p, -S, -b, -c, -u, -g, -k, -O, -G),
+ *  *-t fd* (0, 1 et 2 désignent les descripteurs de la commande), *-n* et *-z* ; opérateurs binaires sur les chaînes
+ *  (=, ==, !=, <, >), les entiers (-eq, -ne, -lt, -le, -gt, -ge) et les fichiers (-nt, -ot, -ef) ; *!*, *-a*, *-o* et
+ *  parenthèses. Sous la forme "[", le dernier argument doit être "]".
+ */
+int builtin_test(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "cat".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si un fichier n'a pas pu être lu, 128 + SIGPIPE si la sortie est fermée.
+ * @details *cat [fichier...]* recopie les fichiers (ou l'entrée, sans argument ou pour "-") sur la sortie, sans passer
+ *  par l'espace utilisateur quand c'est possible (voir iocopy.h). Les options sont laissées à la commande externe.
+ */
+int builtin_cat(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "tee".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si un fichier n'a pas pu être ouvert ou écrit, 128 + SIGPIPE si la sortie est fermée.
+ * @details *tee [-a] [fichier...]* recopie l'entrée sur la sortie et dans chaque fichier (*-a* : ajout en fin de fichier).
+ */
+int builtin_tee(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "head".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 en cas d'erreur, 128 + SIGPIPE si la sortie est fermée.
+ * @details *head [-n N | -N | -c N] [fichier]* recopie les N premières lignes (10 par défaut) ou les N premiers octets.
+ *  Sur une entrée qui le permet, la position est laissée juste après les données recopiées.
+ */
+int builtin_head(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "wc".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si l'entrée n'a pas pu être lue.
+ * @details *wc -l [fichier]* affiche le nombre de lignes, *wc -c [fichier]* le nombre d'octets (suivi du nom du fichier
+ *  s'il est donné). Les autres combinaisons d'options sont laissées à la commande externe.
+ */
+int builtin_wc(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "set".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 en cas d'erreur.
+ * @details Sans argument (ou avec *-o* seul), affiche les options du shell au format *nom=valeur*.
+ *  *set -o nom=valeur* (ou *set -o nom valeur*) modifie une option (voir options.h). En cas d'option ou de valeur inconnue, un message d'erreur est affiché sur *io->err*.
+ */
+int builtin_set(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "hash".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si une commande est introuvable.
+ * @details Sans argument, affiche le cache de résolution des commandes (voir pathcache.h).
+ *  *hash -r* vide le cache. *hash nom...* résout les commandes données et les ajoute au cache.
+ */
+int builtin_hash(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "plancache".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 en cas d'argument invalide.
+ * @details Sans argument, affiche les statistiques du cache des plans d'exécution (voir plancache.h) : entrées, succès, échecs et évictions.
+ *  *plancache -r* vide le cache et remet les compteurs à zéro. La capacité se règle avec *set -o plancache=N*.
+ */
+int builtin_plancache(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "globcache".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 en cas d'argument invalide.
+ * @details Sans argument, affiche les statistiques du cache des répertoires lus par l'expansion des jokers (voir wildcard.h) :
+ *  répertoires et noms gardés, succès et échecs. *globcache -r* vide le cache et remet les compteurs à zéro.
+ */
+int builtin_globcache(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "alias".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si un alias est introuvable ou si un nom ou une valeur est invalide.
+ * @details Sans argument, affiche tous les alias triés par nom, sous la forme *alias nom='valeur'*. *alias nom=valeur...*
+ *  définit les alias donnés (voir alias.h) ; *alias nom...* affiche les alias donnés. Une définition vide le cache des plans.
+ */
+int builtin_alias(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "unalias".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si un alias est introuvable ou sans argument.
+ * @details *unalias nom...* supprime les alias donnés, *unalias -a* supprime tous les alias. Vide le cache des plans.
+ */
+int builtin_unalias(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "jobs".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Toujours 0.
+ * @details Affiche la table des tâches (voir jobs.h) : numéro, état, durée depuis le lancement et commande.
+ *  Les tâches affichées comme terminées sont retirées de la table.
+ */
+int builtin_jobs(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "wait".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Statut de la dernière tâche attendue, 127 si l'une des tâches désignées est inconnue (même si d'autres ont été
+ *    attendues), 0 sans argument.
+ * @details Sans argument, attend la fin de toutes les tâches en cours. *wait %n* ou *wait pid* attend la tâche désignée.
+ *  Les tâches attendues sont retirées de la table.
+ */
+int builtin_wait(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "fg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Statut de la tâche, 128 + SIGTSTP si elle est de nouveau arrêtée, 1 si elle est inconnue.
+ * @details *fg [%n]* met la tâche désignée (par défaut la plus récente) au premier plan, la relance si elle est arrêtée et attend sa fin.
+ */
+int builtin_fg(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "bg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int 0 en cas de succès, 1 si la tâche est inconnue ou ne peut pas être relancée.
+ * @details *bg [%n]* relance en arrière-plan la tâche arrêtée désignée (par défaut la plus récente).
+ */
+int builtin_bg(processus_t* cmd, builtin_io_t* io);
+
+/** @brief Fonction d'exécution de la commande "parallel".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @param io Entrées/sorties de la commande.
+ * @return int Nombre de commandes en échec (au plus 101), 0 si toutes ont réussi, 1 en cas d'argument invalide.
+ * @details *parallel [-j N] commande [argument...]* lance la commande une fois par ligne lue sur *io->in*, avec au plus N
+ *  commandes simultanées (*-j 0* ou sans *-j* : une par processeur en ligne). Chaque "{}" des arguments est remplacé par
+ *  la ligne ; à défaut, la ligne est ajoutée en dernier argument. Les sorties sont affichées dans l'ordre des lignes et
+ *  chaque commande en échec est signalée sur *io->err* avec son statut, suivie du bilan (voir parallel.h).
  */
-int builtin_pwd(processus_t* cmd);
+int builtin_parallel(processus_t* cmd, builtin_io_t* io);
 
 #endif // BUILTINS_H
\ No newline at end of file
@@ -0,0 +1,87 @@
+/**
+ * @file hashtable.h
+ * @brief Header file for the open-addressing hash table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table de hachage à adressage ouvert (sondage linéaire, suppression par décalage arrière)
+ *    indexée par un nom, commune à la table des variables, à celle des alias et au cache des chemins de commandes.
+ *    Chaque module définit son type d'entrée, dont le premier membre est un *hash_entry_t* ; la table ne gère que
+ *    les cases, le contenu des entrées (et la mémoire du nom) reste à la charge du module.
+ */
+
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief En-tête commun des entrées d'une table.
+ * @struct hash_entry_t
+ */
+typedef struct {
+    const char* key; ///< Nom (pas forcément terminé par '\\0'), NULL si la case est vide
+    size_t key_len;  ///< Longueur du nom
+    uint32_t hash;   ///< Haché du nom (voir hash_name())
+} hash_entry_t;
+
+/** @brief Table de hachage.
+ * @struct hash_table_t
+ * @details Une table initialisée par HASH_TABLE_INIT n'est pas allouée : sa première insertion lui donne *initial_capacity* cases.
+ */
+typedef struct {
+    char* slots;             ///< Cases (*capacity* entrées de *entry_size* octets)
+    size_t entry_size;       ///< Taille d'une entrée du module (au moins sizeof(hash_entry_t))
+    size_t initial_capacity; ///< Capacité de la première allocation (puissance de 2)
+    size_t capacity;         ///< Nombre de cases (puissance de 2, 0 si la table n'est pas allouée)
+    size_t count;            ///< Nombre d'entrées occupées
+} hash_table_t;
+
+/** @brief Initialiseur d'une table vide dont les entrées sont de type *type*. */
+#define HASH_TABLE_INIT(type, initial) {NULL, sizeof(type), (initial), 0, 0}
+
+/** @brief Fonction de hachage FNV-1a d'un nom.
+ * @param s Nom.
+ * @param len Nombre de caractères à hacher.
+ * @return uint32_t Haché.
+ */
+uint32_t hash_name(const char* s, size_t len);
+
+/** @brief Case *i* d'une table (parcours de toutes les cases, vides comprises), de type *hash_entry_t\**. */
+#define HASH_SLOT(table, i) ((hash_entry_t*)((table)->slots + (i) * (table)->entry_size))
+
+/** @brief Fonction de recherche d'un nom.
+ * @param table Table.
+ * @param key Nom recherché.
+ * @param len Longueur du nom.
+ * @param h Haché du nom.
+ * @return hash_entry_t* Entrée du nom, NULL s'il est absent.
+ */
+hash_entry_t* hash_find(const hash_table_t* table, const char* key, size_t len, uint32_t h);
+
+/** @brief Fonction de recherche de la case d'un nom, en vue d'une insertion.
+ * @param table Table, agrandie si besoin (taux de remplissage maximal de 3/4).
+ * @param key Nom.
+ * @param len Longueur du nom.
+ * @param h Haché du nom.
+ * @return hash_entry_t* Entrée du nom si elle existe, sinon nouvelle case (*key* à NULL, *key_len* et *hash* renseignés)
+ *    dans laquelle le module doit écrire son entrée et *key* ; NULL en cas d'échec d'allocation.
+ * @details Une nouvelle case est comptée comme occupée : elle doit être remplie avant toute autre opération
+ *    (les allocations du module se font donc avant l'appel).
+ */
+hash_entry_t* hash_insert(hash_table_t* table, const char* key, size_t len, uint32_t h);
+
+/** @brief Fonction de suppression d'une entrée.
+ * @param table Table.
+ * @param entry Entrée occupée de la table (ses ressources ont déjà été libérées par le module).
+ * @details Les entrées suivantes de la même séquence de sondage reprennent la case libérée (décalage arrière) :
+ *    aucune pierre tombale n'est laissée, les recherches ne ralentissent pas après des suppressions.
+ */
+void hash_remove(hash_table_t* table, hash_entry_t* entry);
+
+/** @brief Fonction de vidage d'une table, dont la capacité est conservée.
+ * @param table Table (les ressources des entrées ont déjà été libérées par le module).
+ */
+void hash_clear(hash_table_t* table);
+
+#endif // HASHTABLE_H
@@ -0,0 +1,72 @@
+/**
+ * @file input.h
+ * @brief Header file for command line input
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des sources de lignes de commande du shell : fichier de script projeté en mémoire,
+ *    chaîne passée par *-c*, ou flux (entrée standard).
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+
+/** @brief Source de lignes de commande.
+ * @struct input_t
+ * @details Pour un script ou une chaîne, *data* contient tout le texte et les lignes sont des tranches de *data* : aucune copie n'est faite.
+ *    Pour un flux, le descripteur *fd* est lu par gros blocs (*read()*) dans le tampon *buf*, et les lignes sont des tranches de *buf*.
+ *    Les octets non consommés sont ramenés au début du tampon avant chaque lecture, et le tampon double de taille si une ligne
+ *    ne tient pas : une ligne est toujours contiguë, quelle que soit sa longueur.
+ */
+typedef struct {
+    const char* data;     ///< Texte complet (fichier projeté ou chaîne), NULL pour un flux
+    size_t size;          ///< Taille du texte
+    size_t pos;           ///< Position de la prochaine ligne dans le texte
+    size_t map_size;      ///< Taille de la projection mémoire, 0 si *data* n'est pas projeté
+    int fd;               ///< Descripteur du flux, -1 pour un texte complet
+    int eof;              ///< Fin du flux atteinte
+    char* buf;            ///< Tampon de lecture du flux (ou d'assemblage des lignes continuées d'un texte)
+    size_t buf_size;      ///< Taille du tampon
+    size_t start;         ///< Début des octets non consommés dans *buf*
+    size_t end;           ///< Fin des octets lus dans *buf*
+} input_t;
+
+/** @brief Fonction d'ouverture d'un script.
+ * @param in Source à initialiser.
+ * @param path Chemin du script.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message sur stderr).
+ * @details Un fichier régulier est projeté en mémoire en lecture seule (*mmap()*) et son descripteur est refermé aussitôt.
+ *    Un fichier non projetable (tube nommé, périphérique) est lu comme un flux.
+ */
+int input_open_file(input_t* in, const char* path);
+
+/** @brief Fonction d'ouverture d'une chaîne de commandes (option *-c*).
+ * @param in Source à initialiser.
+ * @param str Chaîne de commandes, éventuellement sur plusieurs lignes (non copiée : elle doit rester valide).
+ */
+void input_open_string(input_t* in, const char* str);
+
+/** @brief Fonction d'ouverture d'un flux.
+ * @param in Source à initialiser.
+ * @param fd Descripteur à lire (ex: STDIN_FILENO).
+ */
+void input_open_stream(input_t* in, int fd);
+
+/** @brief Fonction de lecture de la ligne suivante.
+ * @param in Source de lignes.
+ * @param len Adresse de la longueur de la ligne (saut de ligne exclu).
+ * @return const char* Début de la ligne, NULL en fin d'entrée ou en cas d'erreur de lecture.
+ * @details La ligne n'est pas terminée par '\0' (c'est une tranche du texte ou du tampon de lecture) : seule la longueur *len* la délimite.
+ *    Elle reste valide jusqu'au prochain appel. Une ligne terminée par une barre oblique inverse non protégée est continuée sur la
+ *    ligne suivante (la barre et le saut de ligne sont retirés).
+ */
+const char* input_read_line(input_t* in, size_t* len);
+
+/** @brief Fonction de fermeture d'une source (libération de la projection, du tampon, et fermeture du descripteur s'il a été ouvert par input_open_file()).
+ * @param in Source à fermer.
+ */
+void input_close(input_t* in);
+
+#endif // INPUT_H
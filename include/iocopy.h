@@ -0,0 +1,60 @@
+/**
+ * @file iocopy.h
+ * @brief Header file for in-kernel data transfers between file descriptors
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des fonctions de transfert de données utilisées par les commandes intégrées cat, tee, head et wc.
+ *    Les octets sont déplacés dans le noyau quand les descripteurs le permettent, dans l'ordre de préférence :
+ *    - *copy_file_range()* entre deux fichiers réguliers ;
+ *    - *splice()* quand l'une des extrémités est un tube (et *tee()* pour dupliquer un tube vers un autre) ;
+ *    - *sendfile()* depuis un fichier régulier ;
+ *    - à défaut, *read()* et *write()* avec un tampon de IO_BUFFER_SIZE octets.
+ *    Les positions des descripteurs avancent comme avec *read()* et *write()* : une méthode qui échoue (ex: EINVAL pour
+ *    un fichier ouvert en O_APPEND) est remplacée par la suivante sans perte ni duplication de données.
+ */
+
+#ifndef IOCOPY_H
+#define IOCOPY_H
+
+/// Taille du tampon de la méthode *read()* et *write()*
+#define IO_BUFFER_SIZE (128 * 1024)
+
+/** @brief Fonction de copie des données d'un descripteur vers un autre.
+ * @param in Descripteur source.
+ * @param out Descripteur destination.
+ * @param limit Nombre maximal d'octets à copier, -1 pour copier jusqu'à la fin de la source.
+ * @return long long Nombre d'octets copiés, -1 en cas d'erreur (*errno* positionné).
+ */
+long long io_copy(int in, int out, long long limit);
+
+/** @brief Fonction de copie des données d'un descripteur vers plusieurs autres (commande tee).
+ * @param in Descripteur source.
+ * @param outs Descripteurs destination.
+ * @param num_outs Nombre de descripteurs destination.
+ * @return long long Nombre d'octets lus, -1 en cas d'erreur (*errno* positionné).
+ * @details Quand la source et la première destination sont des tubes et qu'il y a deux destinations, les données
+ *    sont dupliquées par *tee()* puis déplacées vers la seconde par *splice()*, sans passer par l'espace utilisateur.
+ */
+long long io_tee(int in, const int* outs, int num_outs);
+
+/** @brief Fonction de copie des *count* premières lignes d'un descripteur (commande head -n).
+ * @param in Descripteur source.
+ * @param out Descripteur destination.
+ * @param count Nombre de lignes à copier.
+ * @return long long Nombre de lignes copiées, -1 en cas d'erreur (*errno* positionné).
+ * @details Si la source permet *lseek()*, sa position est ramenée juste après la dernière ligne copiée.
+ */
+long long io_head_lines(int in, int out, long long count);
+
+/** @brief Fonction de comptage des lignes et des octets d'un descripteur jusqu'à sa fin (commande wc).
+ * @param in Descripteur source.
+ * @param lines Nombre de sauts de ligne, NULL si seul le nombre d'octets est demandé.
+ * @param bytes Nombre d'octets.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (*errno* positionné).
+ * @details Les sauts de ligne sont comptés avec *memchr()* (vectorisée par la libc). Sans comptage des lignes,
+ *    la taille d'un fichier régulier est obtenue par *fstat()* sans aucune lecture.
+ */
+int io_count(int in, long long* lines, long long* bytes);
+
+#endif // IOCOPY_H
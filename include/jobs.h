@@ -0,0 +1,135 @@
+/**
+ * @file jobs.h
+ * @brief Header file for job control
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table des tâches (jobs) du shell : tubes lancés en arrière-plan ou arrêtés,
+ *    indexés par groupe de processus, et récupération asynchrone des processus terminés.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <sys/types.h>
+#include <time.h>
+
+#include "processus.h"
+#include "outbuf.h"
+
+/** @brief États d'une tâche.
+ * @enum job_state_t
+ */
+typedef enum {
+    JOB_RUNNING, ///< Au moins un processus en cours d'exécution
+    JOB_STOPPED, ///< Processus restants arrêtés (Ctrl+Z, SIGSTOP)
+    JOB_DONE     ///< Tous les processus sont terminés
+} job_state_t;
+
+/** @brief Processus d'une tâche.
+ * @struct job_proc_t
+ */
+typedef struct {
+    pid_t pid;         ///< PID du processus
+    int status;        ///< Statut de sortie (valide si *state* vaut JOB_DONE)
+    job_state_t state; ///< État du processus
+} job_proc_t;
+
+/** @brief Tâche : un tube lancé en arrière-plan ou arrêté au premier plan.
+ * @struct job_t
+ */
+typedef struct {
+    int id;                     ///< Numéro de la tâche ([1], [2]...)
+    pid_t pgid;                 ///< Groupe de processus de la tâche (clé de la table)
+    job_state_t state;          ///< État de la tâche
+    uint8_t invert;             ///< Tube précédé de '!' : statut inversé
+    uint8_t notified;           ///< Changement d'état déjà signalé à l'utilisateur
+    char* command;              ///< Texte de la commande (arguments des étages joints par " | ")
+    struct timespec start_time; ///< Date de lancement (CLOCK_MONOTONIC)
+    struct timespec end_time;   ///< Date de fin du dernier processus (CLOCK_MONOTONIC)
+    int num_procs;              ///< Nombre de processus
+    job_proc_t procs[];         ///< Processus, dans l'ordre des étages du tube
+} job_t;
+
+/** @brief Fonction d'initialisation de la gestion des tâches.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Installe le gestionnaire de SIGCHLD : il se contente d'écrire un octet dans un tube interne (*self-pipe*),
+ *    vidé par jobs_update(). Les processus terminés sont donc récupérés sans attente active ni appel système inutile.
+ */
+int jobs_init(void);
+
+/** @brief Fonction d'ajout d'un tube à la table des tâches.
+ * @param first Premier étage du tube, déjà lancé.
+ * @param state JOB_RUNNING pour un tube lancé en arrière-plan, JOB_STOPPED pour un tube arrêté au premier plan
+ *    (seuls ses processus marqués *stopped* restent alors à attendre).
+ * @return job_t* Tâche créée, NULL si aucun processus n'a été créé ou en cas d'échec d'allocation.
+ * @details En mode interactif, affiche "[n] pid" pour une tâche en arrière-plan et "[n] Stoppé commande" pour une tâche arrêtée.
+ */
+job_t* jobs_add(control_flow_t* first, job_state_t state);
+
+/** @brief Fonction de récupération des processus terminés ou arrêtés, sans blocage.
+ * @details Ne fait aucun appel à *waitpid()* si aucun SIGCHLD n'a été reçu depuis l'appel précédent.
+ *    À appeler lorsqu'aucun tube n'est au premier plan (avant l'affichage du prompt).
+ */
+void jobs_update(void);
+
+/** @brief Fonction de prise en compte du nouvel état d'un processus récupéré par *waitpid()* ou *wait4()*.
+ * @param pid PID du processus récupéré.
+ * @param wstatus Statut retourné par *waitpid()*.
+ * @return int 0 si le processus appartient à une tâche (mise à jour, date de fin comprise), -1 sinon.
+ * @details Permet à une attente au premier plan sur *wait4(-1)* de récupérer au passage les tâches en arrière-plan.
+ */
+int jobs_reap(pid_t pid, int wstatus);
+
+/** @brief Fonction d'attente de toutes les tâches en cours (les tâches arrêtées ne sont pas attendues).
+ * @return int Toujours 0.
+ */
+int jobs_wait_all(void);
+
+/** @brief Fonction de retrait des tâches terminées, signalées en mode interactif.
+ * @details À appeler en début de ligne dans tous les modes : la table ne garde que les tâches en cours ou arrêtées.
+ *    Le statut des tâches retirées reste disponible pour *wait pid* (voir jobs_saved_status()).
+ */
+void jobs_notify(void);
+
+/** @brief Fonction de recherche d'une tâche.
+ * @param spec Désignation de la tâche : "%n" (numéro), "%%" ou "%+" (la plus récente) ou un PID. NULL pour la plus récente.
+ * @return job_t* Tâche trouvée, NULL sinon.
+ */
+job_t* jobs_find(const char* spec);
+
+/** @brief Fonction de statut d'une tâche déjà retirée de la table.
+ * @param spec PID du dernier processus de la tâche (valeur de $! à son lancement).
+ * @return int Statut de la tâche, -1 si *spec* n'est pas un PID ou si ce PID ne fait pas partie des 64 dernières tâches retirées.
+ */
+int jobs_saved_status(const char* spec);
+
+/** @brief Fonction de recherche d'une tâche par groupe de processus.
+ * @param pgid Groupe de processus.
+ * @return job_t* Tâche trouvée, NULL sinon.
+ */
+job_t* jobs_find_pgid(pid_t pgid);
+
+/** @brief Fonction de statut d'une tâche (statut du dernier étage, inversé si besoin). */
+int jobs_status(const job_t* job);
+
+/** @brief Fonction d'attente bloquante d'une tâche.
+ * @param job Tâche à attendre.
+ * @param foreground Si non nul, la tâche est mise au premier plan (terminal, SIGCONT si arrêtée) et l'attente s'arrête si elle est de nouveau arrêtée.
+ * @return int Statut de la tâche si elle est terminée (elle est alors retirée de la table), -1 si elle a été arrêtée.
+ */
+int jobs_wait(job_t* job, int foreground);
+
+/** @brief Fonction de reprise d'une tâche arrêtée en arrière-plan (SIGCONT).
+ * @param job Tâche à reprendre.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int jobs_continue(job_t* job);
+
+/** @brief Fonction d'affichage de la table des tâches.
+ * @param out Sortie (voir outbuf.h).
+ * @details Une ligne par tâche : numéro, état, durée, commande. Les tâches terminées sont ensuite retirées de la table.
+ */
+void jobs_print(outbuf_t* out);
+
+#endif // JOBS_H
@@ -0,0 +1,61 @@
+/**
+ * @file options.h
+ * @brief Header file for shell options
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des options du shell, modifiables à l'exécution via la commande intégrée *set -o nom=valeur*
+ *    ou au démarrage via des variables d'environnement.
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stddef.h>
+
+#include "outbuf.h"
+
+/** @brief Méthodes de création des processus fils.
+ * @enum spawn_backend_t
+ */
+typedef enum {
+    SPAWN_FORK,       ///< *fork()* puis *execvp()* (méthode historique)
+    SPAWN_POSIX_SPAWN ///< *posix_spawnp()* : pas de copie des tables de pages du shell
+} spawn_backend_t;
+
+/** @brief Structure regroupant les options du shell.
+ * @struct shell_options_t
+ */
+typedef struct {
+    spawn_backend_t spawn; ///< Méthode de création des processus (option *spawn*, variable MINISHELL_SPAWN)
+    size_t plancache;      ///< Nombre maximal de plans d'exécution en cache, 0 pour désactiver le cache (option *plancache*, variable MINISHELL_PLANCACHE)
+    char* trace;           ///< Fichier du journal d'exécution, NULL si désactivé (option *trace*, variable MINISHELL_TRACE, voir trace.h)
+    size_t pipesize;       ///< Capacité des tubes en octets, 0 pour la valeur par défaut du noyau (option *pipesize*, variable MINISHELL_PIPESIZE, voir pipes.h)
+} shell_options_t;
+
+/// Options courantes du shell
+extern shell_options_t shell_options;
+
+/** @brief Fonction d'initialisation des options à partir de l'environnement.
+ * @return int 0 en cas de succès, -1 si une variable d'environnement contient une valeur invalide (l'option garde alors sa valeur par défaut).
+ * @details Variables reconnues :
+ * - *MINISHELL_SPAWN* : *fork* ou *posix_spawn*
+ * - *MINISHELL_PLANCACHE* : nombre maximal de plans en cache
+ * - *MINISHELL_TRACE* : fichier du journal d'exécution
+ * - *MINISHELL_PIPESIZE* : capacité des tubes (ex: 1M)
+ */
+int init_options(void);
+
+/** @brief Fonction de modification d'une option.
+ * @param name Nom de l'option (ex: "spawn").
+ * @param value Nouvelle valeur de l'option (ex: "posix_spawn").
+ * @return int 0 en cas de succès, -1 si l'option ou la valeur est inconnue (ou si le fichier du journal ne peut pas être ouvert).
+ */
+int set_option(const char* name, const char* value);
+
+/** @brief Fonction d'affichage des options au format *nom=valeur*.
+ * @param out Sortie (voir outbuf.h).
+ */
+void print_options(outbuf_t* out);
+
+#endif // OPTIONS_H
@@ -0,0 +1,58 @@
+/**
+ * @file outbuf.h
+ * @brief Header file for buffered output on file descriptors
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions d'un petit tampon de sortie vidé par *write()* ou *writev()* sur un descripteur donné,
+ *    utilisé par les commandes intégrées à la place de stdio (voir builtins.h).
+ */
+
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stddef.h>
+
+/// Taille du tampon d'une sortie
+#define OUTBUF_SIZE 4096
+
+/** @brief Tampon de sortie associé à un descripteur.
+ * @struct outbuf_t
+ */
+typedef struct outbuf {
+    int fd;               ///< Descripteur de destination
+    int unbuffered;       ///< Si non nul, le tampon est vidé à la fin de chaque écriture (sortie d'erreur)
+    int error;            ///< Une écriture a échoué (ex: EPIPE), les écritures suivantes sont ignorées
+    struct outbuf* sync;  ///< Tampon à vider avant toute écriture dans celui-ci (ordre stdout/stderr), NULL sinon
+    size_t len;           ///< Nombre d'octets en attente
+    char data[OUTBUF_SIZE]; ///< Octets en attente
+} outbuf_t;
+
+/** @brief Fonction d'initialisation d'un tampon de sortie.
+ * @param out Tampon à initialiser.
+ * @param fd Descripteur de destination.
+ */
+void out_init(outbuf_t* out, int fd);
+
+/** @brief Fonction d'écriture de *len* octets.
+ * @param out Tampon de sortie.
+ * @param data Octets à écrire.
+ * @param len Nombre d'octets.
+ * @return int 0 en cas de succès, -1 si une écriture a échoué.
+ * @details Les petites écritures sont regroupées dans le tampon ; une écriture qui ne tient pas est envoyée
+ *    avec le contenu du tampon en un seul appel à *writev()*.
+ */
+int out_write(outbuf_t* out, const char* data, size_t len);
+
+/** @brief Fonction d'écriture d'une chaîne terminée par '\0'. */
+int out_puts(outbuf_t* out, const char* str);
+
+/** @brief Fonction d'écriture formatée (même format que *printf()*). */
+int out_printf(outbuf_t* out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/** @brief Fonction de vidage du tampon par *write()*.
+ * @return int 0 en cas de succès, -1 si une écriture a échoué.
+ */
+int out_flush(outbuf_t* out);
+
+#endif // OUTBUF_H
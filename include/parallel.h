@@ -0,0 +1,38 @@
+/**
+ * @file parallel.h
+ * @brief Header file for the parallel job runner
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'exécuteur de la commande intégrée *parallel* : une commande est lancée par ligne lue sur
+ *    l'entrée, avec au plus N commandes en cours. Chaque fois qu'une commande se termine, son emplacement est repris
+ *    par la ligne suivante : les lignes sont distribuées à la demande, sans découpage préalable en lots.
+ *
+ *    La sortie standard de chaque commande passe par un tube lu par le shell. La commande la plus ancienne non encore
+ *    affichée écrit directement sur la sortie ; celles qui la suivent sont mises en attente dans un tampon jusqu'à leur
+ *    tour : la sortie est dans l'ordre des lignes, sans mélange entre commandes. La sortie d'erreur n'est pas tamponnée.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "outbuf.h"
+
+/** @brief Fonction d'exécution d'une commande par ligne de l'entrée.
+ * @param cmd Modèle de la commande, terminé par NULL : chaque "{}" d'un argument est remplacé par la ligne ; si aucun
+ *    argument n'en contient, la ligne est ajoutée comme dernier argument. Les lignes vides sont ignorées.
+ * @param slots Nombre maximal de commandes en cours (au moins 1).
+ * @param in Descripteur des lignes d'arguments.
+ * @param out Sortie des commandes, dans l'ordre des lignes.
+ * @param err Sortie d'erreur : une ligne par commande en échec, puis le bilan des échecs.
+ * @return int Nombre de commandes en échec (statut non nul), plafonné à 101 ; 0 si toutes ont réussi.
+ * @details Les commandes sont lancées par spawn_processus() (cache PATH, option *spawn*, commandes intégrées dans un
+ *    fils), avec /dev/null en entrée standard. Shell non interactif : chacune dans son propre groupe de processus. Shell
+ *    interactif : toutes rejoignent le groupe du shell, qui garde le terminal pendant *parallel* ; Ctrl+C et Ctrl+Z
+ *    atteignent donc toutes les commandes en cours à la fois, et celles-ci ne forment pas une tâche de la table des
+ *    tâches (ni *fg*, ni *bg*, ni *jobs*). Une sortie prématurée (mémoire insuffisante) tue et attend les commandes encore
+ *    en cours.
+ */
+int parallel_run(char* const* cmd, int slots, int in, outbuf_t* out, outbuf_t* err);
+
+#endif // PARALLEL_H
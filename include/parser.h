@@ -10,29 +10,75 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "processus.h"
 
-/** @brief Fonction de suppression des espaces inutiles au début et à la fin d'une chaîne de caractères.
- * @param str Chaîne de caractères à traiter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+/** @brief Mot d'un plan d'exécution : tranche du texte du plan.
+ * @struct plan_word_t
  */
-int trim(char* str);
+typedef struct {
+    uint32_t offset; ///< Position du mot dans le texte du plan (terminé par '\0')
+    uint32_t len;    ///< Longueur du mot
+    uint32_t flags;  ///< Indicateurs du token d'origine (TOK_F_EXPAND : mot brut à expanser au lancement de sa commande, TOK_F_GLOB : motif de chemins, TOK_F_SPLIT : sortie de $(...) découpée en mots)
+} plan_word_t;
 
-/** @brief Fonction de nettoyage d'une chaîne de caractères en supprimant les doublons d'espaces.
- * @param str Chaîne de caractères à nettoyer.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+/** @brief Redirection d'un plan d'exécution.
+ * @struct plan_redir_t
  */
-int clean(char* str);
+typedef struct {
+    token_kind_t kind;  ///< Opérateur (TOK_IN, TOK_OUT, TOK_APPEND, TOK_ERR, TOK_ERR_APPEND, TOK_ERR_TO_OUT, TOK_OUT_TO_ERR, TOK_HEREDOC, TOK_HEREDOC_TAB, TOK_HERESTRING)
+    plan_word_t target; ///< Fichier cible (longueur nulle pour 2>&1 et >&2), délimiteur (<<, <<-) ou mot (<<<)
+} plan_redir_t;
 
-/** @brief Fonction d'ajout de caractères d'espacement autour de tous les caractères de la chaîne *s* présents dans *str*.
- * @param str Chaîne de caractères à traiter.
- * @param s Chaîne de caractères contenant les séparateurs.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction ajoute un espace avant et après chaque occurrence d'un caractère de *s* dans *str*.
- *    Si l'ajout d'espaces dépasse la taille maximale *max*, la fonction retourne -1.
+/** @brief Commande d'un plan d'exécution.
+ * @struct plan_command_t
  */
-int separate_s(char* str, char* s, size_t max);
+typedef struct {
+    control_flow_mode_t mode; ///< Chaînage avec la commande précédente (arête du graphe control_flow_t)
+    uint32_t pipe_size;       ///< Capacité du tube venant de la commande précédente (*|{TAILLE}*), 0 pour l'option *pipesize*
+    uint32_t first_word;      ///< Indice du premier mot de la commande (affectations, puis arguments) dans le tableau des mots
+    uint32_t num_assigns;     ///< Nombre d'affectations *NOM=valeur* en tête de commande (environnement propre à la commande)
+    uint32_t num_words;       ///< Nombre d'arguments (après les affectations)
+    uint32_t first_redir;     ///< Indice de la première redirection dans le tableau des redirections
+    uint32_t num_redirs;      ///< Nombre de redirections, appliquées dans l'ordre
+    uint8_t invert;           ///< Commande précédée de '!'
+    uint8_t background;       ///< Commande terminée par '&'
+    uint8_t timed;            ///< Commande chronométrée par *time* (TIMED_START, TIMED_NEXT), 0 sinon
+} plan_command_t;
+
+/** @brief Plan d'exécution d'une ligne de commande : résultat de l'analyse, indépendant de sa position en mémoire.
+ * @struct command_plan_t
+ * @details Le plan est un bloc unique : l'en-tête est suivi des tableaux de commandes, de mots et de redirections, puis du texte des mots
+ *    (chacun terminé par '\0'). Tous les renvois sont des indices ou des positions relatives : le plan se copie avec *memcpy()*.
+ *    Il ne contient que ce qui ne dépend que du texte de la ligne ; les variables, les fichiers et les tubes sont traités au lancement
+ *    de chaque tube par instantiate_pipeline().
+ */
+typedef struct command_plan {
+    uint32_t size;         ///< Taille totale du bloc en octets, en-tête compris
+    uint32_t num_commands; ///< Nombre de commandes
+    uint32_t num_words;    ///< Nombre de mots (arguments de toutes les commandes)
+    uint32_t num_redirs;   ///< Nombre de redirections
+    uint32_t text_size;    ///< Taille du texte des mots
+} command_plan_t;
+
+/** @brief Corps d'un document en ligne (<< ou <<-), lu avec la ligne et expansé au lancement de sa commande.
+ * @struct here_body_t
+ */
+typedef struct here_body {
+    char* data; ///< Lignes telles que lues (tabulations de tête retirées pour <<-), chacune suivie de '\n' ; NULL si la lecture a échoué
+    size_t len; ///< Longueur du corps
+} here_body_t;
+
+/// Tableau des commandes d'un plan
+#define PLAN_COMMANDS(plan) ((plan_command_t*)((char*)(plan) + sizeof(command_plan_t)))
+/// Tableau des mots d'un plan
+#define PLAN_WORDS(plan) ((plan_word_t*)(PLAN_COMMANDS(plan) + (plan)->num_commands))
+/// Tableau des redirections d'un plan
+#define PLAN_REDIRS(plan) ((plan_redir_t*)(PLAN_WORDS(plan) + (plan)->num_words))
+/// Texte des mots d'un plan
+#define PLAN_TEXT(plan) ((char*)(PLAN_REDIRS(plan) + (plan)->num_redirs))
 
 /** @brief Fonction de remplacement de toutes les occurrences de la sous-chaîne *s* par la sous-chaîne *t* dans la chaîne *str*.
  * @param str Chaîne de caractères à traiter.
@@ -41,7 +87,9 @@ int separate_s(char* str, char* s, size_t max);
  * @param max Taille maximale de la chaîne *str*.
  * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
  * @details Cette fonction remplace toutes les occurrences de la sous-chaîne *s* par la sous-chaîne *t* dans la chaîne *str*.
- *    Si le remplacement dépasse la taille maximale *max*, la fonction retourne -1.
+ *    Si le remplacement dépasse la taille maximale *max*, la fonction retourne -1 et *str* est inchangée.
+ *    Le traitement se fait en une passe, de gauche à droite : le texte inséré n'est jamais examiné de nouveau.
+ *    Une sous-chaîne *s* vide n'a aucune occurrence.
  */
 int replace(char* str, const char* s, const char* t, size_t max);
 
@@ -55,29 +103,92 @@ int replace(char* str, const char* s, const char* t, size_t max);
  */
 int substenv(char* str, size_t max);
 
-/** @brief Fonction de découpage d'une chaîne de caractères en tokens selon un séparateur.
- * @param str Chaîne de caractères à découper. Attention, cette chaîne est modifiée par la fonction.
- * @param sep Caractère séparateur.
- * @param tokens Tableau de chaînes de caractères pour stocker les tokens extraits. Le tableau est terminé par un pointeur NULL.
- * @param max Taille maximale du tableau *tokens*.
- * @return int Nombre de tokens extraits, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction découpe la chaîne *str* en tokens en utilisant le caractère *sep* comme séparateur.
- *    Les tokens extraits sont stockés dans le tableau *tokens*.
- *    Si le nombre de tokens dépasse la taille maximale *max*, la fonction retourne -1.
+/** @brief Fonction d'expansion d'un mot brut (guillemets, échappements, variables, ~).
+ * @param src Début du mot dans la ligne de commande.
+ * @param len Longueur du mot.
+ * @param out Tampon de destination (peut être égal à *src* : l'écriture ne dépasse jamais la lecture tant que le mot ne contient ni '$' ni '~').
+ * @param max Taille du tampon *out*.
+ * @return int Longueur du résultat (non terminé par '\0'), -1 en cas de dépassement de taille.
+ * @details Les guillemets simples protègent tout leur contenu, les guillemets doubles laissent passer l'expansion des variables,
+ *    la barre oblique inverse protège le caractère suivant. Les variables $VAR, ${VAR}, $?, $! et les paramètres positionnels ($0 à $9, ${N}, $#, $@, $*) sont remplacés par leur valeur
+ *    (chaîne vide si elles n'existent pas) sans découpage en plusieurs mots. Un '~' seul ou suivi de '/' en début de mot est remplacé par $HOME.
+ *    Une substitution $(...) est remplacée par la sortie de sa commande, sans les sauts de ligne finaux (voir subst_run()).
+ */
+int expand_word(const char* src, size_t len, char* out, size_t max);
+
+/** @brief Fonction d'analyse lexicale d'une ligne de commande, en une seule passe.
+ * @param arena Arène dans laquelle le tableau des tokens est alloué.
+ * @param line Ligne de commande à découper. Attention, les mots contenant des guillemets sans expansion sont réécrits sur place (guillemets retirés).
+ * @param tokens Adresse du tableau des tokens extraits (alloué par la fonction, agrandi au fil de l'analyse).
+ * @return int Nombre de tokens extraits, -1 en cas d'erreur (guillemet non fermé, échec d'allocation).
+ * @details Chaque token est une tranche (*start*, *len*) de *line* : aucune copie n'est faite et les mots ne sont pas terminés par '\0'.
+ *    Les opérateurs reconnus sont | || && & ; < << <<- <<< > >> 2> 2>> 2>&1 >&2 et ! (suivi d'un espace ou en fin de ligne) ; ils n'ont pas besoin d'être séparés des mots par des espaces.
+ *    Un '|' immédiatement suivi de *{TAILLE}* forme un seul token (capacité du tube, voir pipes.h).
+ *    Un "2" n'est un opérateur que s'il commence un token et est immédiatement suivi de '>'. Un '#' en début de token commence un commentaire
+ *    qui s'étend jusqu'à la fin de la ligne.
+ *    Les mots qui nécessitent une expansion (présence de '$' hors guillemets simples, '~' initial) sont marqués TOK_F_EXPAND et laissés bruts.
+ *    Une substitution $(...) fait partie du mot jusqu'à sa parenthèse fermante, blancs et opérateurs compris ; hors guillemets,
+ *    le mot est aussi marqué TOK_F_SPLIT. L'expansion arithmétique $((...)) n'est pas prise en charge : "$((" n'ouvre pas de
+ *    substitution et reste un texte littéral.
+ *    Les mots qui contiennent un joker * ? ou [ hors guillemets sont marqués TOK_F_GLOB ; s'ils contiennent aussi des guillemets,
+ *    ils sont marqués TOK_F_EXPAND et laissés bruts (les guillemets protègent les jokers du motif).
+ */
+int lex_command_line(arena_t* arena, char* line, token_t** tokens);
+
+/** @brief Fonction de construction du plan d'exécution à partir des tokens d'une ligne.
+ * @param cmdl Ligne de commande dont les tokens (*cmdl->tokens*) ont été extraits par lex_command_line().
+ * @param plan Adresse du plan construit (alloué dans l'arène de *cmdl*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur de syntaxe (message sur stderr) ou d'échec d'allocation.
+ * @details Vérifie la syntaxe (opérateur sans commande, redirection sans fichier, tube ou && ou || en fin de ligne)
+ *    et range les commandes, arguments et redirections dans un bloc command_plan_t. Aucun descripteur n'est ouvert.
+ */
+int build_plan(command_line_t* cmdl, command_plan_t** plan);
+
+/** @brief Fonction d'instanciation d'un plan d'exécution.
+ * @param cmdl Ligne de commande à remplir.
+ * @param plan Plan à instancier (copié dans l'arène de *cmdl*, *cmdl->plan* : il peut provenir du cache et les commandes intégrées peuvent modifier leurs arguments).
+ * @return int 0 en cas de succès, -1 en cas d'échec d'allocation.
+ * @details Crée les structures processus_t et control_flow_t de toutes les commandes et lit les corps des documents en ligne (<< et <<-),
+ *    dans l'ordre de la ligne, sur la source *cmdl->input* : leurs lignes ne sont jamais exécutées comme des commandes, même si la ligne
+ *    s'arrête avant. Aucun mot n'est expansé et aucun descripteur n'est ouvert : c'est le rôle de instantiate_pipeline(), appelée par
+ *    launch_command_line() juste avant le lancement de chaque tube.
+ */
+int instantiate_plan(command_line_t* cmdl, const command_plan_t* plan);
+
+/** @brief Fonction d'instanciation d'un tube de la ligne, juste avant son lancement.
+ * @param first Premier étage du tube.
+ * @return int 0 en cas de succès (y compris si un fichier ne peut pas être ouvert), -1 en cas d'erreur (échec d'allocation ou de *pipe()*).
+ * @details Expanse les mots marqués TOK_F_EXPAND de chaque étage, crée les tubes entre les étages et ouvre les fichiers des redirections.
+ *    L'expansion a lieu au lancement du tube, pas à l'analyse de la ligne : dans *A=5; echo $A*, *cd /tmp; echo $(pwd)* ou
+ *    *sleep 1 & wait $!*, chaque tube voit l'effet des précédents, et une commande sautée par && ou || n'expanse rien.
+ *    Un argument marqué TOK_F_GLOB est remplacé par les chemins qui correspondent à son motif (voir wildcard.h), ou gardé tel quel s'il n'y en a aucun ;
+ *    les affectations et les fichiers des redirections ne sont pas concernés.
+ *    Les substitutions de commande $(...) sont exécutées pendant l'expansion (voir subst.h) ; hors guillemets, leur sortie est
+ *    découpée aux blancs en plusieurs arguments (mot marqué TOK_F_SPLIT), sauf dans une affectation ou une redirection.
+ *    Le corps d'un document en ligne dont le délimiteur n'a aucun guillemet subit l'expansion des variables. Le corps d'un document ou d'un mot (<<<) est donné à la
+ *    commande par un tube s'il tient dans sa capacité, par un fichier anonyme en mémoire sinon (voir pipe_open_data()) : rien n'est
+ *    écrit sur disque.
+ *    Les redirections d'une commande sont prioritaires sur le tube : dans *a > f | b*, *b* lit une entrée vide.
+ *    Un fichier d'entrée introuvable donne le statut 1 à la commande sans interrompre la ligne.
+ *    Les descripteurs ouverts sont enregistrés dans ceux de la ligne et fermés par close_fds(), y compris en cas d'erreur.
+ *    Sans plan (*first->cmdl->plan* NULL, processus remplis directement), la fonction ne fait rien.
  */
-int strcut(char* str, char sep, char** tokens, size_t max);
+int instantiate_pipeline(control_flow_t* first);
 
 /** @brief Fonction d'analyse d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
- * @param line Chaîne de caractères contenant la ligne de commande à analyser.
- * @return int 0 en cas de succès, -1 en cas d'erreur (ligne trop longue, trop de commandes, etc.).
+ * @param line Ligne de commande à analyser (pas nécessairement terminée par '\0', par exemple une ligne d'un script projeté en mémoire).
+ * @param len Longueur de la ligne.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (erreur de syntaxe, échec d'allocation, etc.).
  * @details Cette fonction analyse la ligne de commande *line* et remplit la structure *cmdl* avec les informations extraites.
- *    La ligne de commande est copiée dans *cmdl->command_line* dans la limite de MAX_CMD_LINE caractères.
- *    La ligne est ensuite nettoyée (trim, clean, separate_s, replace, substenv), puis découpée en tokens.
- *    Les tokens sont ensuite utilisés pour remplir les structures processus_t et control_flow_t dans *cmdl*.
- *    Si la ligne dépasse la taille maximale ou si le nombre de commandes dépasse MAX_CMDS, la fonction retourne -1.
+ *    La ligne de commande est copiée dans l'arène de *cmdl* (*cmdl->command_line*), sans limite de taille.
+ *    Le plan d'exécution de la ligne est d'abord recherché dans le cache des plans (voir plancache.h). S'il est absent, la ligne est
+ *    découpée en tokens en une seule passe par lex_command_line(), les mots en position de nom de commande qui sont des alias
+ *    sont remplacés par les tokens de leur valeur (voir alias.h), puis le plan est construit par build_plan() et ajouté au cache.
+ *    Le plan est ensuite instancié par instantiate_plan() ; l'expansion des variables et la création des tubes et des redirections,
+ *    seules refaites à chaque exécution d'une ligne déjà vue, ont lieu tube par tube au lancement (voir instantiate_pipeline()).
  *    Si une erreur est détectée, les descripteurs de fichiers ouverts sont fermés via close_fds(cmdl) avant de retourner -1.
  */
-int parse_command_line(command_line_t* cmdl, const char* line);
+int parse_command_line(command_line_t* cmdl, const char* line, size_t len);
 
 #endif // PARSER_H
\ No newline at end of file
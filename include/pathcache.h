@@ -0,0 +1,38 @@
+/**
+ * @file pathcache.h
+ * @brief Header file for the command path cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des fonctions du cache de résolution des commandes dans $PATH (table de hachage nom → chemin absolu).
+ */
+
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include "outbuf.h"
+
+/** @brief Fonction de résolution d'une commande dans les répertoires de $PATH.
+ * @param name Nom de la commande (ex: "ls").
+ * @return const char* Chemin de l'exécutable, ou NULL si la commande est introuvable.
+ * @details Si *name* contient un '/', il est retourné tel quel sans recherche.
+ *    Les résultats, positifs comme négatifs, sont conservés dans une table de hachage : une commande déjà
+ *    résolue ne provoque plus aucun appel système. Le cache est vidé lorsque la date de modification d'un
+ *    répertoire de $PATH change (vérifiée au plus une fois par seconde) ou lorsque *pathcache_reset()* est appelée.
+ *    Si $PATH contient un répertoire relatif, le résultat dépend du CWD et le cache n'est pas utilisé.
+ *    Le pointeur retourné reste valide jusqu'au prochain vidage du cache.
+ */
+const char* pathcache_lookup(const char* name);
+
+/** @brief Fonction de vidage du cache.
+ * @details À appeler lorsque la variable PATH est modifiée (export, unset) : la liste des répertoires est relue à la recherche suivante.
+ */
+void pathcache_reset(void);
+
+/** @brief Fonction d'affichage du contenu du cache.
+ * @param out Sortie (voir outbuf.h).
+ * @details Une ligne par commande : nombre d'utilisations, puis chemin de l'exécutable (ou nom suivi de "(introuvable)").
+ */
+void pathcache_print(outbuf_t* out);
+
+#endif // PATHCACHE_H
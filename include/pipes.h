@@ -0,0 +1,66 @@
+/**
+ * @file pipes.h
+ * @brief Header file for pipeline pipes
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des fonctions de création des tubes entre étages et de mesure de leur débit.
+ *
+ *    La capacité d'un tube (64 Kio par défaut sous Linux) peut être augmentée par *fcntl(F_SETPIPE_SZ)* : pour un gros
+ *    volume, l'écrivain est moins souvent bloqué et les changements de contexte entre étages sont moins nombreux. Elle est
+ *    fixée par l'option *pipesize* (variable MINISHELL_PIPESIZE) ou pour un seul tube par la syntaxe *a |{1M} b*, dans la
+ *    limite du fichier /proc/sys/fs/pipe-max-size.
+ *
+ *    Lorsque le journal d'exécution est actif (voir trace.h), chaque tube d'un tube lancé passe par un processus de mesure
+ *    qui déplace les données par *splice()* vers un second tube de même capacité et enregistre un événement *pipestats* :
+ *    nombre d'octets transférés et temps pendant lequel le tube vers le lecteur était plein (écrivain bloqué).
+ */
+
+#ifndef PIPES_H
+#define PIPES_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/// Plus grande capacité acceptée par pipe_parse_size() (celle du noyau tient dans un *int*)
+#define PIPE_SIZE_MAX ((size_t)1 << 30)
+
+/** @brief Fonction de lecture d'une taille de tube.
+ * @param s Début de la taille : nombre décimal, éventuellement suivi de K ou M (multiples de 1024), au plus PIPE_SIZE_MAX.
+ * @param len Longueur de la taille.
+ * @param size Taille lue, en octets (0 : capacité par défaut du noyau).
+ * @return int 0 en cas de succès, -1 si la taille est invalide.
+ */
+int pipe_parse_size(const char* s, size_t len, size_t* size);
+
+/** @brief Fonction de création d'un tube entre deux étages.
+ * @param pfd Descripteurs du tube : *pfd[0]* en lecture, *pfd[1]* en écriture, tous deux avec O_CLOEXEC.
+ * @param size Capacité demandée, 0 pour la capacité par défaut.
+ * @return int 0 en cas de succès, -1 si *pipe2()* échoue.
+ * @details La capacité est ramenée à la valeur du fichier /proc/sys/fs/pipe-max-size (lue au premier appel). Le tube est
+ *    conservé avec sa capacité par défaut si le noyau refuse l'agrandissement (ex: quota de pages par utilisateur atteint).
+ */
+int pipe_open(int pfd[2], size_t size);
+
+/** @brief Fonction de création d'un descripteur en lecture sur un contenu en mémoire (ex: corps d'un document en ligne).
+ * @param data Contenu.
+ * @param len Longueur du contenu.
+ * @return int Descripteur en lecture (O_CLOEXEC), placé au début du contenu ; -1 en cas d'échec (*errno* positionné).
+ * @details Un contenu qui tient dans la capacité d'un tube y est écrit d'un coup (l'écriture ne bloque pas), puis le bout
+ *    d'écriture est fermé. Un contenu plus gros est écrit dans un fichier anonyme en mémoire (*memfd_create()*) : aucun
+ *    fichier n'est créé sur disque et le lecteur n'a pas à être lancé avant l'écriture.
+ */
+int pipe_open_data(const char* data, size_t len);
+
+/** @brief Fonction de lancement du processus de mesure d'un tube.
+ * @param read_fd Bout de lecture du tube mesuré ; remplacé par le bout de lecture du tube alimenté par la mesure,
+ *    à transmettre au lecteur. Les deux descripteurs restent à la charge de l'appelant.
+ * @param flow Rang de la commande lectrice dans la ligne (champ *flow* de l'événement).
+ * @param pgid Groupe de processus à rejoindre, 0 pour en créer un nouveau.
+ * @return pid_t PID du processus de mesure, -1 en cas d'échec (*read_fd* est alors inchangé).
+ * @details Le processus se termine à la fin des données ou quand le lecteur a fermé le tube, après avoir enregistré
+ *    l'événement *pipestats*. Il n'est pas un étage du tube : l'appelant le récupère par *waitpid()*.
+ */
+pid_t pipe_meter(int* read_fd, int flow, pid_t pgid);
+
+#endif // PIPES_H
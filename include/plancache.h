@@ -0,0 +1,51 @@
+/**
+ * @file plancache.h
+ * @brief Header file for the execution plan cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des fonctions du cache des plans d'exécution (table de hachage texte de la ligne → plan, éviction LRU).
+ */
+
+#ifndef PLANCACHE_H
+#define PLANCACHE_H
+
+#include <stddef.h>
+
+#include "parser.h"
+#include "outbuf.h"
+
+/** @brief Fonction de recherche du plan d'une ligne de commande.
+ * @param line Texte brut de la ligne (avant toute analyse).
+ * @param len Longueur de la ligne.
+ * @return const command_plan_t* Plan de la ligne, ou NULL s'il n'est pas dans le cache.
+ * @details La ligne est comparée octet par octet à celle de l'entrée de même haché. Un succès place l'entrée en tête de la liste LRU.
+ *    Le pointeur retourné reste valide jusqu'au prochain appel à plancache_insert() ou plancache_reset() : il doit être copié avant usage
+ *    (voir instantiate_plan()). Chaque appel compte un succès ou un échec, sauf si le cache est désactivé (option *plancache=0*).
+ */
+const command_plan_t* plancache_lookup(const char* line, size_t len);
+
+/** @brief Fonction d'ajout du plan d'une ligne de commande au cache.
+ * @param line Texte brut de la ligne.
+ * @param len Longueur de la ligne.
+ * @param plan Plan construit par build_plan() (copié dans le cache).
+ * @details Si le cache contient déjà *shell_options.plancache* entrées, les moins récemment utilisées sont évincées.
+ *    Un échec d'allocation est silencieux : la ligne sera simplement analysée de nouveau.
+ */
+void plancache_insert(const char* line, size_t len, const command_plan_t* plan);
+
+/** @brief Fonction de vidage du cache et de remise à zéro des compteurs. */
+void plancache_reset(void);
+
+/** @brief Fonction de vidage du cache, sans remise à zéro des compteurs.
+ * @details À appeler quand le plan d'une ligne déjà vue peut changer (ex: définition ou suppression d'un alias).
+ */
+void plancache_flush(void);
+
+/** @brief Fonction d'affichage des statistiques du cache.
+ * @param out Sortie (voir outbuf.h).
+ * @details Nombre d'entrées et capacité, puis nombre de succès, d'échecs et d'évictions.
+ */
+void plancache_print(outbuf_t* out);
+
+#endif // PLANCACHE_H
@@ -14,17 +14,20 @@
 
 #include <stdint.h>
 #include <time.h>
+#include <sys/resource.h>
 
-/// Nombre maximum d'arguments
-#define MAX_ARGS 128
-/// Nombre maximum de variables d'environnement
-#define MAX_ENV 128
-/// Nombre maximum de commandes sur une ligne
-#define MAX_CMDS 128
-/// Taille maximale d'une ligne de commande
-#define MAX_CMD_LINE 4096
+#include "arena.h"
+#include "input.h"
 
 extern int last_status;
+/// Vaut 1 si le shell est interactif (commandes lues sur un terminal, ni script ni *-c*)
+extern int shell_interactive;
+/// Paramètres positionnels : $0 (nom du shell ou du script), puis $1, $2...
+extern char** positional_params;
+/// Nombre de paramètres positionnels, $0 compris ($# vaut num_positional_params - 1)
+extern int num_positional_params;
+/// PID du dernier processus lancé en arrière-plan ($!), 0 si aucun
+extern pid_t last_background_pid;
 
 
 /** @brief Modes de contrôle de flux pour les processus.
@@ -34,11 +37,19 @@ extern int last_status;
 typedef enum {
     UNCONDITIONAL, ///< Exécution inconditionnelle
     ON_SUCCESS,    ///< Exécution en cas de succès
-    ON_FAILURE     ///< Exécution en cas d'échec
+    ON_FAILURE,    ///< Exécution en cas d'échec
+    PIPE           ///< Étage suivant d'un tube (lancé en même temps que le processus courant)
 } control_flow_mode_t;
 
+/// Valeurs du champ *timed* : première commande d'une liste préfixée par *time*
+#define TIMED_START 1
+/// Valeurs du champ *timed* : commande suivante de la même liste (&&, ||, |)
+#define TIMED_NEXT 2
+
 struct control_flow; // Déclaration anticipée pour l'utilisation dans processus_t
 struct command_line; // Déclaration anticipée pour l'utilisation dans control_flow_t
+struct command_plan; // Déclaration anticipée pour l'utilisation dans command_line_t (voir parser.h)
+struct here_body;    // Déclaration anticipée pour l'utilisation dans command_line_t (voir parser.h)
 
 /**
  * @brief Structure représentant un processus.
@@ -47,18 +58,26 @@ struct command_line; // Déclaration anticipée pour l'utilisation dans control_
  */
 typedef struct {
     pid_t pid;                  ///< Process ID
-    char* argv[MAX_ARGS];       ///< Liste des arguments
-    char* envp[MAX_ENV];        ///< Variables d'environnement
+    pid_t pgid;                 ///< Groupe de processus (commun à tous les étages d'un tube)
+    char** argv;                ///< Liste des arguments, terminée par NULL (NULL si aucun argument)
+    int argc;                   ///< Nombre d'arguments
+    int argv_size;              ///< Nombre d'éléments alloués pour *argv*
+    char** envp;                ///< Affectations *NOM=valeur* préfixant la commande, terminées par NULL (NULL si aucune) : ajoutées à l'environnement de la commande seule, ou variables du shell si la commande n'a pas d'argument
     char* path;                 ///< Chemin de l'exécutable
 
     int stdin_fd;               ///< Descripteur d'entrée standard
     int stdout_fd;              ///< Descripteur de sortie standard
     int stderr_fd;              ///< Descripteur d'erreur standard
+    uint8_t stdin_pipe;         ///< 1 si *stdin_fd* est le tube venant de l'étage précédent
+    pid_t meter_pid;            ///< Processus de mesure de ce tube (journal actif, voir pipes.h), 0 si aucun
     int status;                 ///< Statut de sortie
     uint8_t is_background;      ///< Background flag
     uint8_t invert;             ///< Inversion du code de retour pour le contrôle de flux
-    struct timespec start_time; ///< Start time
-    struct timespec end_time;   ///< End time
+    uint8_t stopped;            ///< Arrêté (Ctrl+Z) pendant l'attente au premier plan : le tube passe dans la table des tâches
+    uint8_t timed;              ///< Commande chronométrée par *time* (TIMED_START, TIMED_NEXT), 0 sinon
+    struct timespec start_time; ///< Date de lancement (CLOCK_MONOTONIC), nulle si la commande n'a pas été lancée
+    struct timespec end_time;   ///< Date de fin constatée par le shell (CLOCK_MONOTONIC)
+    struct rusage rusage;       ///< Ressources consommées (*wait4()*, ou écart de *getrusage()* pour une commande intégrée exécutée dans le shell)
     struct control_flow* cf;    ///< Pointeur vers la structure de contrôle de flux associée
 } processus_t;
 
@@ -71,24 +90,77 @@ typedef struct control_flow {
     struct control_flow* unconditionnal_next; ///< Pointeur vers la prochaine structure de processus en cas d'exécution inconditionnelle
     struct control_flow* on_success_next;     ///< Pointeur vers la prochaine structure de processus en cas d'exécution réussie
     struct control_flow* on_failure_next;     ///< Pointeur vers la prochaine structure de processus en cas d'échec de l'exécution
+    struct control_flow* pipe_next;           ///< Pointeur vers l'étage suivant du tube (le processus courant écrit dans son entrée)
     struct command_line* cmdl;                     ///< Pointeur vers la structure de ligne de commande associée
+    unsigned int index;                       ///< Rang de la commande dans la ligne (à partir de 0), repris par le journal d'exécution
 } control_flow_t;
 
+/** @brief Types de tokens produits par l'analyse lexicale.
+ * @enum token_kind_t
+ */
+typedef enum {
+    TOK_WORD,        ///< Mot (nom de commande, argument, nom de fichier)
+    TOK_PIPE,        ///< |
+    TOK_OR,          ///< ||
+    TOK_AND,         ///< &&
+    TOK_BACKGROUND,  ///< &
+    TOK_SEMICOLON,   ///< ;
+    TOK_IN,          ///< <
+    TOK_OUT,         ///< >
+    TOK_APPEND,      ///< >>
+    TOK_ERR,         ///< 2>
+    TOK_ERR_APPEND,  ///< 2>>
+    TOK_ERR_TO_OUT,  ///< 2>&1
+    TOK_OUT_TO_ERR,  ///< >&2
+    TOK_BANG,        ///< !
+    TOK_HEREDOC,     ///< <<
+    TOK_HEREDOC_TAB, ///< <<- (tabulations en tête des lignes du corps retirées)
+    TOK_HERESTRING   ///< <<<
+} token_kind_t;
+
+/// Le mot contient des guillemets, '$' ou '~' à traiter par expand_word()
+#define TOK_F_EXPAND 0x01
+/// Le mot contenait des guillemets ou des échappements (jamais remplacé par un alias, ex: 'ls')
+#define TOK_F_QUOTED 0x02
+/// Le mot contient un joker * ? ou [ hors guillemets : il est remplacé par les chemins correspondants (voir wildcard.h)
+#define TOK_F_GLOB 0x04
+/// Le mot contient une substitution $(...) hors guillemets : sa sortie est découpée en plusieurs arguments (voir subst.h)
+#define TOK_F_SPLIT 0x08
+
+/** @brief Token : tranche typée de la ligne de commande.
+ * @struct token_t
+ */
+typedef struct token {
+    token_kind_t kind; ///< Type du token
+    uint8_t flags;     ///< Indicateurs (TOK_F_EXPAND, TOK_F_QUOTED, TOK_F_GLOB, TOK_F_SPLIT)
+    char* start;       ///< Début du token dans la ligne de commande
+    size_t len;        ///< Longueur du token
+} token_t;
+
 /**
  * @brief Structure représentant une ligne de commande.
  * @struct command_line_t
- * @details Cette structure contient la ligne de commande complète, un tableau de structures de processus, une structure de contrôle de flux, et un tableau des descripteurs de fichiers ouverts.
- * La structure permet à la fois d'allouer l'espace mémoire nécessaire pour les processus et de gérer le flux d'exécution entre eux.
+ * @details Cette structure contient la ligne de commande complète, la liste chaînée des structures de contrôle de flux (et donc des processus), et un tableau des descripteurs de fichiers ouverts.
+ * Toutes les données de la ligne (copie de la ligne, tokens, processus, arguments, expansions) sont allouées dans l'arène *arena* :
+ * leur taille suit celle de la ligne, sans limite fixe, et elles sont libérées en temps constant par init_command_line().
  * Le schéma suivant illustre la relation entre les structures:
  * \image html schema_struct.png
  */
 typedef struct command_line {
-    char command_line[MAX_CMD_LINE];  ///< Ligne de commande complète
-    char* tokens[MAX_CMD_LINE / 2 + 1]; ///< Tableau des tokens extraits de la ligne de commande
-    processus_t commands[MAX_CMDS];   ///< Tableau des structures de processus
-    control_flow_t flow[MAX_CMDS];    ///< Structure de contrôle de flux
+    arena_t arena;                    ///< Arène mémoire de la ligne
+    char* command_line;               ///< Ligne de commande complète (copie dans l'arène)
+    token_t* tokens;                  ///< Tableau des tokens extraits de la ligne de commande
+    unsigned int num_tokens;          ///< Nombre de tokens
+    control_flow_t* flow;             ///< Structure de contrôle de flux de la première commande
+    control_flow_t* last_flow;        ///< Structure de contrôle de flux de la dernière commande ajoutée
+    processus_t* next_proc;           ///< Processus réservé par next_processus() pour le prochain add_processus()
     unsigned int num_commands;        ///< Nombre de commandes
-    int opened_descriptors[MAX_CMDS * 3 + 1]; ///< Tableau des descripteurs de fichiers ouverts
+    int* opened_descriptors;          ///< Tableau des descripteurs de fichiers ouverts (-1 : entrée libre)
+    unsigned int num_descriptors;     ///< Nombre d'entrées utilisées dans *opened_descriptors*
+    unsigned int max_descriptors;     ///< Nombre d'entrées allouées pour *opened_descriptors*
+    input_t* input;                   ///< Source des lignes suivantes (corps des documents en ligne <<), NULL si aucune
+    struct command_plan* plan;        ///< Copie du plan de la ligne dans l'arène, instanciée tube par tube au lancement (NULL si aucun)
+    struct here_body* here_bodies;    ///< Corps des documents en ligne, indexés par redirection du plan (NULL si aucun)
 } command_line_t;
 
 /**
@@ -97,8 +169,11 @@ typedef struct command_line {
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *pid*: 0
- * - *argv*: {NULL}
- * - *envp*: {NULL}
+ * - *pgid*: 0
+ * - *argv*: NULL
+ * - *argc*: 0
+ * - *argv_size*: 0
+ * - *envp*: NULL
  * - *path*: NULL
  * - *stdin_fd*: 0
  * - *stdout_fd*: 1
@@ -106,8 +181,10 @@ typedef struct command_line {
  * - *status*: 0
  * - *is_background*: 0
  * - *invert*: 0
+ * - *timed*: 0
  * - *start_time*: {0}
  * - *end_time*: {0}
+ * - *rusage*: {0}
  * - *cf*: NULL
  */
 int init_processus(processus_t* proc);
@@ -121,10 +198,43 @@ int init_processus(processus_t* proc);
  *    Le flag *is_background* détermine si on attend la fin du processus ou non.
  *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
  *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
- *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : le processus "fils" ferme tous les descripteurs listés dans ce tableau avant d'exécuter la commande.
+ *    Le processus est attendu par *wait4()* : les ressources consommées sont enregistrées dans *rusage*.
+ *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors*, que le père ferme après le lancement. Ils sont ouverts avec O_CLOEXEC : le processus "fils" n'en conserve que les copies sur 0, 1 et 2, sans parcourir ce tableau.
  */
 int launch_processus(processus_t* proc);
 
+/** @brief Fonction de création du processus fils d'une commande, sans attente.
+ * @param proc Processus à lancer.
+ * @param pgid Groupe de processus à rejoindre, 0 pour en créer un nouveau.
+ * @return int 0 en cas de succès, -1 si la création du processus échoue.
+ * @details Le chemin de l'exécutable est résolu dans le père via *pathcache_lookup()* : une commande introuvable
+ *    ne coûte aucune création de processus (*pid* reste à 0 et *status* vaut 127).
+ *    La méthode de création est choisie par l'option *spawn* (voir options.h). Les commandes intégrées
+ *    passent toujours par *fork()* puisqu'elles s'exécutent sans *exec*.
+ *    Les descripteurs *stdin_fd*, *stdout_fd* et *stderr_fd* supérieurs à 2 sont fermés côté père après le lancement.
+ */
+int spawn_processus(processus_t* proc, pid_t pgid);
+
+/** @brief Fonction d'attente de la fin d'un processus lancé par spawn_processus().
+ * @param proc Processus à attendre (sans effet si *pid* est nul).
+ * @details Met à jour *status*, *end_time* et *rusage*. En mode interactif, l'attente s'arrête aussi si le processus
+ *    est arrêté (Ctrl+Z) : *stopped* passe à 1.
+ */
+void wait_processus(processus_t* proc);
+
+/** @brief Fonction de lancement d'un tube (pipeline) complet.
+ * @param first Pointeur vers la structure de contrôle de flux du premier étage du tube.
+ * @return int 0 en cas de succès, un code d'erreur sinon.
+ * @details Les étages sont reliés par le champ *pipe_next*. Tous les étages sont lancés (*fork()*) avant toute attente,
+ *    dans un même groupe de processus (celui du premier étage), puis ils sont attendus ensemble.
+ *    Les commandes intégrées ne sont exécutées dans le shell lui-même que si le tube ne comporte qu'un seul étage ;
+ *    sinon elles sont exécutées dans un processus fils comme les commandes externes.
+ *    Le statut du tube (inversé si l'un des étages porte le flag *invert*) est écrit dans le champ *status* du dernier étage.
+ *    Si le dernier étage porte le flag *is_background*, le tube n'est pas attendu.
+ *    Les étages sont attendus dans l'ordre où ils se terminent : *end_time* et *rusage* sont ceux de chaque étage.
+ */
+int launch_pipeline(control_flow_t* first);
+
 /** @brief Fonction d'initialisation d'une structure de contrôle de flux.
  * @param cf Pointeur vers la structure de contrôle de flux à initialiser.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
@@ -133,6 +243,7 @@ int launch_processus(processus_t* proc);
  * - *unconditionnal_next*: NULL
  * - *on_success_next*: NULL
  * - *on_failure_next*: NULL
+ * - *pipe_next*: NULL
  * - *cmdl*: NULL
  */
 int init_control_flow(control_flow_t* cf);
@@ -140,21 +251,21 @@ int init_control_flow(control_flow_t* cf);
 /** @brief Fonction d'ajout d'un processus à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande dans laquelle le processus doit être ajouté.
  * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE).
- * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (tableau plein par exemple).
+ * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (échec d'allocation).
  * @details Cette fonction ajoute le processus *proc* à la structure de contrôle de flux *cf* selon le mode spécifié:
- * Le dernier élément du tableau *commands* est retourné après avoir été initialisé dans le dernier élément du tableau *flow*.
+ * Un processus et sa structure control_flow_t sont alloués dans l'arène de *cmdl* (ou le processus réservé par next_processus() est utilisé), puis ajoutés en fin de liste.
  * Cette structure control_flow_t est mise à jour pour que le champ *proc* pointe vers le processus ajouté et la liste est mise à jour de la manière suivante :
  * - Si *mode* est UNCONDITIONAL, *proc* est ajouté à la liste des processus à exécuter inconditionnellement après le processus courant.
  * - Si *mode* est ON_SUCCESS, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec succès (code de retour 0).
  * - Si *mode* est ON_FAILURE, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec un échec (code de retour non nul).
+ * - Si *mode* est PIPE, *proc* devient l'étage suivant du tube dont le processus courant fait partie.
  */
 processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode);
 
 /** @brief Fonction de récupération du prochain processus à exécuter selon le contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
- * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL si le nombre maximum est atteint.
- * @details Cette fonction retourne un pointeur vers la structure processus_t dans le tableau *commands* situé à l'indice *num_commands + 1*.
- *  Si le nombre maximum de commandes est atteint (MAX_CMDS), la fonction retourne NULL.
+ * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL en cas d'échec d'allocation.
+ * @details Cette fonction réserve dans l'arène (si ce n'est pas déjà fait) la structure processus_t qui sera utilisée par le prochain appel à add_processus().
  *  Cela permet notamment d'initialiser les descripteurs des IOs standards qui dépendent du processus en court de traitement (dans le cas des pipes par exemple).
  */
 processus_t* next_processus(command_line_t* cmdl);
@@ -162,12 +273,20 @@ processus_t* next_processus(command_line_t* cmdl);
 /** @brief Fonction d'ajout d'un descripteur de fichier à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @param fd Descripteur de fichier à ajouter.
- * @return int 0 en cas de succès, -1 en cas d'erreur (tableau plein ou fd invalide).
- * @details Cette fonction ajoute le descripteur de fichier *fd* au tableau *opened_descriptors* de la structure *cf*.
- *    Si le tableau est plein ou si *fd* est invalide (négatif), la fonction retourne -1
+ * @return int 0 en cas de succès, -1 en cas d'erreur (échec d'allocation ou fd invalide).
+ * @details Cette fonction ajoute le descripteur de fichier *fd* à la fin du tableau *opened_descriptors* de la structure *cf*, agrandi dans l'arène si nécessaire.
+ *    Si *fd* est invalide (négatif), la fonction retourne -1
  */
 int add_fd(command_line_t* cmdl, int fd);
 
+/** @brief Fonction de fermeture d'un descripteur de fichier et de retrait du tableau *opened_descriptors*.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur de fichier à fermer.
+ * @return int 0 en cas de succès, -1 si *fd* n'appartient pas au tableau (il n'est alors pas fermé).
+ * @details Le retrait garantit que *close_fds()* ne fermera pas plus tard un descripteur de même numéro ouvert entre-temps.
+ */
+int remove_fd(command_line_t* cmdl, int fd);
+
 /** @brief Fonction de fermeture des descripteurs de fichiers listés dans la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
@@ -179,23 +298,50 @@ int close_fds(command_line_t* cmdl);
 /** @brief Fonction d'initialisation d'une structure de ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à initialiser.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
- * - *command_line*: "\0"
- * - *tokens*: {NULL}
- * - *commands*: tableau de processus initialisé via *init_processus()*
- * - *flow*: tableau de contrôle de flux initialisé via *init_control_flow()*
+ * @details L'arène est remise à zéro en temps constant (ses blocs sont conservés pour la ligne suivante), puis les champs
+ *    de la structure sont initialisés avec les valeurs suivantes:
+ * - *command_line*: NULL
+ * - *tokens*: NULL
+ * - *num_tokens*: 0
+ * - *flow*, *last_flow*, *next_proc*: NULL
  * - *num_commands*: 0
- * - *opened_descriptors*: {-1}
+ * - *opened_descriptors*: NULL
+ * - *num_descriptors*, *max_descriptors*: 0
+ *
+ *    Avant la première initialisation, la structure doit être mise à zéro (ex: `command_line_t cmdl = {0};`).
  */
 int init_command_line(command_line_t* cmdl);
 
+/** @brief Fonction de libération de la mémoire d'une structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Les descripteurs encore ouverts sont fermés et les blocs de l'arène sont rendus au système.
+ */
+int free_command_line(command_line_t* cmdl);
+
+/** @brief Fonction d'ajout d'un argument à un processus.
+ * @param cmdl Pointeur vers la structure de ligne de commande (l'arène de *cmdl* est utilisée pour agrandir *argv*).
+ * @param proc Processus auquel ajouter l'argument.
+ * @param arg Argument à ajouter (non copié).
+ * @return int 0 en cas de succès, -1 en cas d'échec d'allocation.
+ * @details *argv* reste terminé par NULL. Le premier argument est aussi enregistré dans *path*.
+ */
+int add_argument(command_line_t* cmdl, processus_t* proc, char* arg);
+
 /** @brief Fonction de lancement d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à lancer.
  * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction lance les processus selon le flux défini dans la structure *cmdl*. Les lancements sont effectués via *launch_processus()* en
+ * @details Cette fonction lance les processus selon le flux défini dans la structure *cmdl*. Les lancements sont effectués tube par tube via *launch_pipeline()* en
  *    respectant les conditions de contrôle de flux (inconditionnel, en cas de succès, en cas d'échec).
- *    Le tableau *opened_descriptors* est utilisé pour fermer les descripteurs ouverts au moment de l'initialisation des structures processus_t.
+ *    Le statut pris en compte est celui du dernier étage de chaque tube. Une commande dont la condition n'est pas remplie est sautée,
+ *    et l'évaluation reprend à la commande suivante (ex: *false && a || b* exécute *b*).
+ *    Chaque tube est instancié par instantiate_pipeline() (expansion des mots, tubes, redirections) juste avant son lancement : il voit
+ *    l'effet des tubes précédents, et un tube sauté n'expanse rien et n'ouvre aucun fichier.
+ *    Le tableau *opened_descriptors* est utilisé pour fermer les descripteurs ouverts au moment de l'instanciation des tubes.
  *    La fonction retourne 0 si tous les processus à lancer en fonction du contrôle de flux ont pu être lancés sans erreur.
+ *    Une liste préfixée par *time* (jusqu'au prochain ';' ou '&') est chronométrée : à sa fin, le temps réel, les temps
+ *    utilisateur et système, la mémoire maximale et les changements de contexte sont affichés sur la sortie d'erreur,
+ *    précédés du détail par commande si elle en compte plusieurs.
  */
 int launch_command_line(command_line_t* cmdl);
 #endif
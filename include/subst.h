@@ -0,0 +1,62 @@
+/**
+ * @file subst.h
+ * @brief Header file for command substitution
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la substitution de commande $(...) : la commande est analysée et lancée comme une ligne à part
+ *    entière, sa sortie standard est capturée puis recopiée dans l'arène de la ligne dont un tube est en cours
+ *    d'instanciation. Les substitutions d'un tube sont exécutées juste avant son lancement (voir instantiate_pipeline()).
+ *
+ *    Une commande qui ne modifie pas l'état du shell (commandes intégrées pures comme *pwd* ou *echo*, commandes externes)
+ *    est lancée par le shell lui-même : une commande intégrée s'exécute alors sans aucun *fork()*. Une commande qui
+ *    modifierait l'état du shell (*cd*, *exit*, *export*, affectations, arrière-plan...) est exécutée dans un fils, comme
+ *    dans un sous-shell.
+ *
+ *    La sortie est capturée dans un fichier anonyme en mémoire (*memfd_create()*) plutôt que dans un tube : la commande
+ *    s'exécute jusqu'au bout avant que le shell ne lise quoi que ce soit, une sortie plus grande que la capacité d'un tube
+ *    bloquerait l'écrivain.
+ *
+ *    Les expansions d'un mot sont recommencées avec une zone plus grande en cas de dépassement : le résultat de chaque
+ *    substitution est donc conservé, indexé par l'adresse de son texte, jusqu'à la fin de l'instanciation du tube,
+ *    afin que la commande ne soit jamais lancée deux fois.
+ */
+
+#ifndef SUBST_H
+#define SUBST_H
+
+#include <stddef.h>
+
+#include "arena.h"
+
+/** @brief Portée des résultats de substitution : tube en cours d'instanciation.
+ * @struct subst_scope_t
+ */
+typedef struct {
+    size_t base;    ///< Premier résultat de la portée dans la table des résultats
+    arena_t* arena; ///< Arène dans laquelle les sorties sont copiées, NULL hors de toute ligne
+} subst_scope_t;
+
+/** @brief Fonction d'ouverture de la portée d'un tube (début de instantiate_pipeline()).
+ * @param saved Portée englobante, à restituer par subst_leave() (substitution imbriquée).
+ * @param arena Arène de la ligne.
+ */
+void subst_enter(subst_scope_t* saved, arena_t* arena);
+
+/** @brief Fonction de fermeture de la portée d'un tube : ses résultats sont oubliés.
+ * @param saved Portée englobante, sauvegardée par subst_enter().
+ */
+void subst_leave(const subst_scope_t* saved);
+
+/** @brief Fonction d'exécution d'une substitution de commande.
+ * @param cmd Texte de la commande (entre les parenthèses de $(...), non terminé par '\0').
+ * @param len Longueur du texte.
+ * @param out Adresse de la sortie de la commande, sans les sauts de ligne finaux ni les octets nuls (dans l'arène de la ligne).
+ * @param out_len Adresse de la longueur de la sortie.
+ * @return int 0 en cas de succès (y compris si la commande échoue : son statut est alors dans *last_status*), -1 hors de
+ *    tout tube ou en cas d'échec d'allocation ou de création du fichier de capture.
+ * @details Un second appel avec le même *cmd* dans la même portée retourne le même résultat sans relancer la commande.
+ */
+int subst_run(const char* cmd, size_t len, const char** out, size_t* out_len);
+
+#endif // SUBST_H
@@ -0,0 +1,90 @@
+/**
+ * @file trace.h
+ * @brief Header file for the execution trace log
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions du journal d'exécution optionnel (option *trace*, variable MINISHELL_TRACE) : une ligne JSON par
+ *    événement (analyse d'une ligne, tube, ouverture d'une redirection, création d'un processus, début d'exécution
+ *    dans le fils, fin d'un processus, commande intégrée exécutée dans le shell, débit d'un tube).
+ *
+ *    Les événements sont enregistrés sous forme binaire dans un anneau de TRACE_RING_SIZE entrées, projeté en mémoire
+ *    partagée (*MAP_SHARED*) : les fils créés par *fork()* y écrivent aussi leur événement *exec*. Une entrée est réservée
+ *    par compare-and-swap sur l'indice d'écriture, sans verrou ; si l'anneau est plein, l'événement est compté comme perdu.
+ *    Le shell met en forme et écrit les événements entre deux lignes de commande (trace_flush()), hors du chemin mesuré.
+ *
+ *    Chaque ligne porte l'horodatage *ts_ns* (CLOCK_MONOTONIC), le type *event*, le rang *flow* de la commande dans la
+ *    ligne (-1 si sans objet), le *pid* concerné, la durée *dur_ns* et, selon le type, *cache_hit*, *fd* et *size*,
+ *    *status* ou *bytes* et *stall_ns*.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/// Nombre d'entrées de l'anneau d'événements
+#define TRACE_RING_SIZE 4096
+
+/** @brief Types d'événements.
+ * @enum trace_kind_t
+ */
+typedef enum {
+    TRACE_PARSE,   ///< parse_command_line() : *cache_hit* vaut 1 si le plan venait du cache
+    TRACE_PIPE,    ///< *pipe2()* d'un tube : *fd* est le bout de lecture, *size* sa capacité en octets
+    TRACE_OPEN,    ///< *open()* d'une redirection : *fd* est le descripteur obtenu (-1 en cas d'échec)
+    TRACE_FORK,    ///< *fork()* dans le shell : *dur_ns* est la latence de l'appel
+    TRACE_SPAWN,   ///< *posix_spawn()* dans le shell : *dur_ns* est la latence de l'appel
+    TRACE_EXEC,    ///< Début de l'exécution dans le fils, juste avant *execve()* (méthode *fork* uniquement)
+    TRACE_WAIT,    ///< Fin d'un processus constatée par *wait4()* : *dur_ns* est sa durée de vie, *status* son statut
+    TRACE_BUILTIN, ///< Commande intégrée exécutée dans le shell : *status* est son statut
+    TRACE_PIPESTATS ///< Fin du processus de mesure d'un tube (voir pipes.h) : *bytes* transférés, *stall_ns* passées tube plein
+} trace_kind_t;
+
+struct trace_ring; // Anneau d'événements (voir trace.c)
+
+/// Anneau d'événements, NULL si le journal est désactivé
+extern struct trace_ring* trace_ring;
+
+/// Vaut 1 si le journal est actif : les horodatages ne sont pris que dans ce cas
+#define TRACE_ENABLED() (trace_ring != NULL)
+
+/** @brief Fonction de lecture de l'horloge des événements.
+ * @return uint64_t Temps CLOCK_MONOTONIC en nanosecondes.
+ */
+uint64_t trace_now(void);
+
+/** @brief Fonction d'activation ou de désactivation du journal.
+ * @param path Fichier de destination (les lignes y sont ajoutées), chaîne vide pour désactiver le journal.
+ * @return int 0 en cas de succès, -1 si le fichier ne peut pas être ouvert ou l'anneau alloué.
+ */
+int trace_open(const char* path);
+
+/** @brief Fonction d'enregistrement d'un événement (sans effet si le journal est désactivé).
+ * @param kind Type de l'événement.
+ * @param flow Rang de la commande dans la ligne, -1 si sans objet.
+ * @param pid Processus concerné, 0 si sans objet.
+ * @param start Début de l'événement (trace_now()).
+ * @param end Fin de l'événement (trace_now()), égale à *start* pour un événement ponctuel.
+ * @param value Valeur propre au type (*cache_hit*, *fd* ou *status*).
+ */
+void trace_event(trace_kind_t kind, int flow, pid_t pid, uint64_t start, uint64_t end, long value);
+
+/** @brief Fonction d'enregistrement d'un événement à deux valeurs (sans effet si le journal est désactivé).
+ * @param kind Type de l'événement.
+ * @param flow Rang de la commande dans la ligne, -1 si sans objet.
+ * @param pid Processus concerné, 0 si sans objet.
+ * @param start Début de l'événement (trace_now()).
+ * @param end Fin de l'événement (trace_now()).
+ * @param value Première valeur propre au type (*fd* ou *bytes*).
+ * @param extra Seconde valeur propre au type (*size* ou *stall_ns*).
+ */
+void trace_event_ext(trace_kind_t kind, int flow, pid_t pid, uint64_t start, uint64_t end, long long value, long long extra);
+
+/** @brief Fonction d'écriture des événements enregistrés dans le fichier du journal.
+ * @details Sans effet dans un processus fils. Appelée par le shell après chaque ligne de commande et à sa terminaison.
+ */
+void trace_flush(void);
+
+#endif // TRACE_H
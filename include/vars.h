@@ -0,0 +1,75 @@
+/**
+ * @file vars.h
+ * @brief Header file for the shell variable table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table des variables du shell (table de hachage nom → valeur). Elle est remplie à partir
+ *    de l'environnement reçu au démarrage (au premier accès) et remplace *getenv()*, *setenv()* et *unsetenv()* :
+ *    une expansion $VAR coûte une recherche en temps constant, quel que soit le nombre de variables.
+ *
+ *    Chaque variable porte un indicateur d'export. Le tableau *envp* transmis aux commandes lancées n'est reconstruit
+ *    que lorsqu'un compteur de génération indique que l'ensemble des variables exportées a changé depuis sa dernière
+ *    construction.
+ */
+
+#ifndef VARS_H
+#define VARS_H
+
+#include <stddef.h>
+
+#include "arena.h"
+#include "outbuf.h"
+
+/** @brief Fonction de lecture d'une variable.
+ * @param name Nom de la variable.
+ * @return const char* Valeur de la variable, NULL si elle n'existe pas. Le pointeur reste valide jusqu'à la prochaine
+ *    modification de la variable.
+ */
+const char* vars_get(const char* name);
+
+/** @brief Fonction de lecture d'une variable dont le nom n'est pas terminé par '\0'.
+ * @param name Début du nom de la variable (ex: dans une ligne de commande).
+ * @param len Longueur du nom.
+ * @return const char* Valeur de la variable, NULL si elle n'existe pas (même durée de validité que vars_get()).
+ */
+const char* vars_get_n(const char* name, size_t len);
+
+/** @brief Fonction de création ou de modification d'une variable.
+ * @param name Nom de la variable (non vide, sans '=').
+ * @param value Nouvelle valeur.
+ * @param exported 1 pour exporter la variable vers les commandes lancées, 0 pour garder l'indicateur actuel
+ *    (une nouvelle variable n'est alors pas exportée).
+ * @return int 0 en cas de succès, -1 si le nom est invalide (*errno* vaut EINVAL) ou en cas d'échec d'allocation.
+ */
+int vars_set(const char* name, const char* value, int exported);
+
+/** @brief Fonction de suppression d'une variable (sans effet si elle n'existe pas).
+ * @param name Nom de la variable.
+ * @return int 0 en cas de succès, -1 si le nom est invalide (*errno* vaut EINVAL).
+ */
+int vars_unset(const char* name);
+
+/** @brief Fonction d'accès à l'environnement des commandes lancées.
+ * @return char** Tableau *NOM=valeur* des variables exportées, terminé par NULL (à passer à *execve()*). Il n'est
+ *    reconstruit que si une variable exportée a été créée, modifiée ou supprimée depuis l'appel précédent.
+ */
+char** vars_environ(void);
+
+/** @brief Fonction de construction de l'environnement d'une commande précédée d'affectations (*NOM=valeur cmd*).
+ * @param overlay Affectations "NOM=valeur" de la commande, terminées par NULL.
+ * @param arena Arène dans laquelle le tableau est alloué (celle de la ligne de commande).
+ * @return char** Tableau terminé par NULL, NULL en cas d'échec d'allocation.
+ * @details Les chaînes ne sont pas copiées : le tableau reprend les pointeurs de vars_environ(), sauf ceux des variables
+ *    masquées par une affectation, suivis des affectations (la dernière l'emporte pour un même nom). Les variables du
+ *    shell ne sont pas modifiées.
+ */
+char** vars_environ_overlay(char* const* overlay, arena_t* arena);
+
+/** @brief Fonction d'affichage des variables exportées (*export* sans argument).
+ * @param out Sortie (voir outbuf.h).
+ * @details Une ligne *NOM=valeur* par variable, triées par nom.
+ */
+void vars_print_exported(outbuf_t* out);
+
+#endif // VARS_H
@@ -0,0 +1,52 @@
+/**
+ * @file wildcard.h
+ * @brief Header file for pathname wildcard expansion
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'expansion des jokers * ? et [...] dans les chemins (ex: *src/?ain.[ch]*).
+ *
+ *    Chaque composant du motif qui contient un joker est compilé une fois en une suite d'opérations (texte littéral,
+ *    caractère quelconque, étoile, classe de caractères sous forme de table de 256 bits), puis confronté à chaque entrée
+ *    du répertoire sans appel à *fnmatch()*.
+ *
+ *    Les répertoires sont lus par *getdents64()* et leur contenu est gardé dans un cache indexé par (périphérique,
+ *    inode, date de modification) : tant que le répertoire n'est pas modifié, une nouvelle expansion ne coûte qu'un
+ *    *stat()*. Un contenu lu moins d'une seconde après la dernière modification du répertoire n'est pas réutilisé
+ *    (une modification ultérieure pourrait laisser la date inchangée).
+ */
+
+#ifndef WILDCARD_H
+#define WILDCARD_H
+
+#include "arena.h"
+#include "outbuf.h"
+
+/** @brief Fonction de détection des jokers dans un motif.
+ * @param pattern Motif terminé par '\0', où '\\' protège le caractère suivant.
+ * @return int 1 si le motif contient un '*', un '?' ou un '[' fermé non protégé, 0 sinon.
+ */
+int wildcard_has_magic(const char* pattern);
+
+/** @brief Fonction d'expansion d'un motif en chemins existants.
+ * @param pattern Motif terminé par '\0', où '\\' protège le caractère suivant (ex: un joker écrit entre guillemets).
+ * @param arena Arène dans laquelle le tableau et les chemins sont alloués.
+ * @param matches Adresse du tableau des chemins trouvés (non terminé par NULL).
+ * @return int Nombre de chemins trouvés (0 : le mot doit être gardé tel quel), -1 en cas d'échec d'allocation.
+ * @details Les chemins sont triés composant par composant (ordre des octets). Un nom commençant par '.' n'est trouvé
+ *    que si le composant du motif commence lui-même par '.' ; "." et ".." ne le sont jamais, même par ".*", ".?" ou
+ *    ".[.]". C'est un écart voulu avec POSIX sh (où ".*" trouve "." et "..") qui suit l'option *globskipdots* de bash
+ *    (active par défaut depuis bash 5.2) : "rm -r .*" ne remonte jamais au répertoire parent. Un motif terminé par '/'
+ *    ne trouve que des répertoires. Les répertoires illisibles sont ignorés.
+ */
+int wildcard_expand(const char* pattern, arena_t* arena, char*** matches);
+
+/** @brief Fonction de vidage du cache des répertoires et de remise à zéro des compteurs. */
+void wildcard_reset(void);
+
+/** @brief Fonction d'affichage des statistiques du cache des répertoires.
+ * @param out Tampon de sortie.
+ */
+void wildcard_print(outbuf_t* out);
+
+#endif // WILDCARD_H
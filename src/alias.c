@@ -0,0 +1,169 @@
+/** @file alias.c
+ * @brief Implementation of command aliases
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table des alias : table de hachage à adressage ouvert (voir hashtable.h)
+ *    indexée par le nom. Chaque alias est un seul bloc alloué : structure, tokens, nom, valeur
+ *    et copie de la valeur découpée par lex_command_line(), vers laquelle pointent les tokens.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alias.h"
+#include "arena.h"
+#include "hashtable.h"
+#include "parser.h"
+
+/// Capacité initiale de la table (puissance de 2)
+#define INITIAL_CAPACITY 64
+
+/** @brief Entrée de la table : un alias. */
+typedef struct {
+    hash_entry_t entry; ///< Nom (celui de l'alias), sa longueur et son haché
+    alias_t* alias;     ///< Alias
+} alias_entry_t;
+
+static hash_table_t table = HASH_TABLE_INIT(alias_entry_t, INITIAL_CAPACITY);
+
+/** @brief Vérification d'un nom d'alias (non vide, sans caractère qui termine un mot ou change son sens). */
+static int valid_name(const char* name) {
+    if (name == NULL || *name == '\0' || name[strcspn(name, " \t\n=/$`'\"\\|&;<>()#")] != '\0') {
+        errno = EINVAL;
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Construction d'un alias : découpage de la valeur en tokens et copie dans un bloc unique.
+ * @return alias_t* Alias alloué, NULL si la valeur est invalide (*errno* vaut EINVAL) ou en cas d'échec d'allocation.
+ */
+static alias_t* make_alias(const char* name, const char* value) {
+    size_t name_len = strlen(name), value_len = strlen(value);
+
+    // Découpage d'une copie de travail : lex_command_line() la réécrit sur place (guillemets retirés)
+    char* work = strdup(value);
+    if (!work) return NULL;
+    arena_t arena = {0};
+    token_t* tokens;
+    int num_tokens = lex_command_line(&arena, work, &tokens);
+    if (num_tokens < 0) {
+        arena_free(&arena);
+        free(work);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    alias_t* alias = malloc(sizeof(alias_t) + num_tokens * sizeof(token_t) + name_len + 2 * value_len + 3);
+    if (alias) {
+        alias->tokens = (token_t*)(alias + 1);
+        alias->num_tokens = num_tokens;
+        alias->name = (char*)(alias->tokens + num_tokens);
+        alias->value = alias->name + name_len + 1;
+        char* text = alias->value + value_len + 1;
+        memcpy(alias->name, name, name_len + 1);
+        memcpy(alias->value, value, value_len + 1);
+        memcpy(text, work, value_len + 1);
+
+        // Les tokens pointent dans la copie découpée, conservée avec l'alias
+        for (int i = 0; i < num_tokens; i++) {
+            alias->tokens[i] = tokens[i];
+            alias->tokens[i].start = text + (tokens[i].start - work);
+        }
+        alias->blank = value_len > 0 && (value[value_len - 1] == ' ' || value[value_len - 1] == '\t');
+    }
+    arena_free(&arena);
+    free(work);
+    return alias;
+}
+
+/** @brief Fonction de création ou de modification d'un alias. */
+int alias_set(const char* name, const char* value) {
+    if (!valid_name(name) || value == NULL) return -1;
+
+    alias_t* alias = make_alias(name, value);
+    if (!alias) return -1;
+
+    size_t len = strlen(name);
+    alias_entry_t* e = (alias_entry_t*)hash_insert(&table, name, len, hash_name(name, len));
+    if (e == NULL) {
+        free(alias);
+        return -1;
+    }
+    if (e->entry.key != NULL) free(e->alias);
+    e->alias = alias;
+    e->entry.key = alias->name;
+    return 0;
+}
+
+/** @brief Fonction de suppression d'un alias. */
+int alias_unset(const char* name) {
+    if (name == NULL) return -1;
+    size_t len = strlen(name);
+    alias_entry_t* e = (alias_entry_t*)hash_find(&table, name, len, hash_name(name, len));
+    if (e == NULL) return -1;
+
+    free(e->alias);
+    hash_remove(&table, &e->entry);
+    return 0;
+}
+
+/** @brief Fonction de suppression de tous les alias. */
+void alias_clear(void) {
+    for (size_t i = 0; i < table.capacity; i++) {
+        alias_entry_t* e = (alias_entry_t*)HASH_SLOT(&table, i);
+        if (e->entry.key != NULL) free(e->alias);
+    }
+    hash_clear(&table);
+}
+
+/** @brief Fonction de recherche d'un alias dont le nom n'est pas terminé par '\0'. */
+const alias_t* alias_find(const char* name, size_t len) {
+    if (table.count == 0) return NULL;
+    alias_entry_t* e = (alias_entry_t*)hash_find(&table, name, len, hash_name(name, len));
+    return e ? e->alias : NULL;
+}
+
+/** @brief Fonction de lecture du nombre d'alias définis. */
+size_t alias_count(void) {
+    return table.count;
+}
+
+/** @brief Fonction d'affichage d'un alias. */
+void alias_print(const alias_t* alias, outbuf_t* out) {
+    // Valeur entre guillemets simples : chaque ' devient '\''
+    out_printf(out, "alias %s='", alias->name);
+    for (const char* p = alias->value; *p; ) {
+        size_t n = strcspn(p, "'");
+        out_write(out, p, n);
+        p += n;
+        if (*p == '\'') {
+            out_write(out, "'\\''", 4);
+            p++;
+        }
+    }
+    out_write(out, "'\n", 2);
+}
+
+/** @brief Comparaison de deux alias par nom (qsort). */
+static int compare_aliases(const void* a, const void* b) {
+    return strcmp((*(alias_t* const*)a)->name, (*(alias_t* const*)b)->name);
+}
+
+/** @brief Fonction d'affichage de tous les alias, triés par nom. */
+void alias_print_all(outbuf_t* out) {
+    if (table.count == 0) return;
+    alias_t** sorted = malloc(table.count * sizeof(alias_t*));
+    if (!sorted) return;
+
+    size_t n = 0;
+    for (size_t i = 0; i < table.capacity; i++) {
+        alias_entry_t* e = (alias_entry_t*)HASH_SLOT(&table, i);
+        if (e->entry.key != NULL) sorted[n++] = e->alias;
+    }
+    qsort(sorted, n, sizeof(alias_t*), compare_aliases);
+    for (size_t i = 0; i < n; i++) alias_print(sorted[i], out);
+    free(sorted);
+}
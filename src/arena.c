@@ -0,0 +1,110 @@
+/** @file arena.c
+ * @brief Implementation of the line arena allocator
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'allocateur par arène.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+/// Taille minimale d'un bloc
+#define ARENA_BLOCK_SIZE 4096
+/// Alignement des allocations
+#define ARENA_ALIGN 16
+
+/** @brief Arrondi de *size* au multiple de ARENA_ALIGN supérieur. */
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+/** @brief Fonction d'allocation dans une arène. */
+void* arena_alloc(arena_t* arena, size_t size) {
+    size = align_up(size ? size : 1);
+
+    arena_block_t* block = arena->current;
+    while (block == NULL || block->used + size > block->size) {
+        // Réutilisation du bloc suivant (conservé par arena_reset) s'il est assez grand
+        if (block && block->next && block->next->size >= size) {
+            block = block->next;
+            block->used = 0;
+            continue;
+        }
+
+        // Nouveau bloc inséré après le bloc courant : au moins deux fois plus grand que le précédent
+        size_t block_size = block ? block->size * 2 : ARENA_BLOCK_SIZE;
+        while (block_size < size) block_size *= 2;
+
+        arena_block_t* new_block = malloc(sizeof(arena_block_t) + block_size);
+        if (!new_block) return NULL;
+        new_block->size = block_size;
+        new_block->used = 0;
+        if (block) {
+            new_block->next = block->next;
+            block->next = new_block;
+        } else {
+            new_block->next = arena->head;
+            arena->head = new_block;
+        }
+        block = new_block;
+    }
+
+    arena->current = block;
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->last = ptr;
+    return ptr;
+}
+
+/** @brief Fonction de redimensionnement d'une zone allouée dans une arène. */
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) return arena_alloc(arena, new_size);
+
+    // Dernière allocation : ajustement sur place si le bloc courant le permet
+    arena_block_t* block = arena->current;
+    if (ptr == arena->last && block) {
+        size_t offset = (char*)ptr - block->data;
+        size_t size = align_up(new_size ? new_size : 1);
+        if (offset + size <= block->size) {
+            block->used = offset + size;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = arena_alloc(arena, new_size);
+    if (new_ptr) memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    return new_ptr;
+}
+
+/** @brief Fonction de copie d'une chaîne dans une arène. */
+char* arena_strndup(arena_t* arena, const char* s, size_t len) {
+    char* copy = arena_alloc(arena, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/** @brief Fonction de remise à zéro d'une arène, en temps constant. */
+void arena_reset(arena_t* arena) {
+    arena->current = arena->head;
+    if (arena->head) arena->head->used = 0;
+    arena->last = NULL;
+}
+
+/** @brief Fonction de libération de tous les blocs d'une arène. */
+void arena_free(arena_t* arena) {
+    arena_block_t* block = arena->head;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->last = NULL;
+}
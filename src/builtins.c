@@ -9,77 +9,140 @@
 #include <stdio.h>
 #include <limits.h> // Pour PATH_MAX
 #include <errno.h>
+#include <signal.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #include "builtins.h"
+#include "alias.h"
 #include "processus.h"
+#include "options.h"
+#include "pathcache.h"
+#include "plancache.h"
+#include "jobs.h"
+#include "iocopy.h"
+#include "parallel.h"
+#include "vars.h"
+#include "wildcard.h"
 
-// Déclaration nécessaire pour parcourir l'environnement (pour export sans args)
-extern char **environ;
 
-/** @brief Fonction de vérification si une commande est une commande "built-in".
- * @param cmd Nom de la commande à vérifier.
- * @return int 1 si la commande est intégrée, 0 sinon.
- */
-int is_builtin(const processus_t* cmd) {
-    if (cmd == NULL || cmd->argv[0] == NULL) {
-        return 0;
+static int cat_accepts(const processus_t* cmd);
+static int tee_accepts(const processus_t* cmd);
+static int head_accepts(const processus_t* cmd);
+static int wc_accepts(const processus_t* cmd);
+
+/** @brief Table des commandes intégrées. */
+static const builtin_t builtins[] = {
+    {"cd", builtin_cd, 0, NULL},
+    {"exit", builtin_exit, 0, NULL},
+    {"export", builtin_export, 0, NULL},
+    {"unset", builtin_unset, 0, NULL},
+    {"pwd", builtin_pwd, BUILTIN_PURE, NULL},
+    {"echo", builtin_echo, BUILTIN_PURE, NULL},
+    {"printf", builtin_printf, BUILTIN_PURE, NULL},
+    {"true", builtin_true, BUILTIN_PURE, NULL},
+    {"false", builtin_false, BUILTIN_PURE, NULL},
+    {"test", builtin_test, BUILTIN_PURE, NULL},
+    {"[", builtin_test, BUILTIN_PURE, NULL},
+    {"cat", builtin_cat, BUILTIN_PURE | BUILTIN_STREAM, cat_accepts},
+    {"tee", builtin_tee, BUILTIN_PURE | BUILTIN_STREAM, tee_accepts},
+    {"head", builtin_head, BUILTIN_PURE | BUILTIN_STREAM, head_accepts},
+    {"wc", builtin_wc, BUILTIN_PURE | BUILTIN_STREAM, wc_accepts},
+    {"set", builtin_set, 0, NULL},
+    {"hash", builtin_hash, 0, NULL},
+    {"plancache", builtin_plancache, 0, NULL},
+    {"globcache", builtin_globcache, 0, NULL},
+    {"alias", builtin_alias, 0, NULL},
+    {"unalias", builtin_unalias, 0, NULL},
+    {"jobs", builtin_jobs, 0, NULL},
+    {"wait", builtin_wait, 0, NULL},
+    {"fg", builtin_fg, 0, NULL},
+    {"bg", builtin_bg, 0, NULL},
+    {"parallel", builtin_parallel, BUILTIN_PURE | BUILTIN_STREAM, NULL},
+};
+
+/** @brief Fonction de recherche d'une commande intégrée. */
+const builtin_t* find_builtin(const processus_t* cmd) {
+    if (cmd == NULL || cmd->argv == NULL || cmd->argv[0] == NULL) {
+        return NULL;
     }
     const char* name = cmd->argv[0];
 
-    if (strcmp(name, "cd") == 0) return 1;
-    if (strcmp(name, "exit") == 0) return 1;
-    if (strcmp(name, "export") == 0) return 1;
-    if (strcmp(name, "unset") == 0) return 1;
-    if (strcmp(name, "pwd") == 0) return 1;
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++) {
+        if (strcmp(name, builtins[i].name) == 0) {
+            if (builtins[i].accepts && !builtins[i].accepts(cmd)) return NULL;
+            return &builtins[i];
+        }
+    }
+    return NULL;
+}
 
-    return 0;
+/** @brief Fonction de vérification si une commande est une commande "built-in". */
+int is_builtin(const processus_t* cmd) {
+    return find_builtin(cmd) != NULL;
 }
 
-/** @brief Fonction d'exécution d'une commande intégrée.
- * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- */
+/** @brief Fonction de vérification si une commande intégrée est sans effet sur l'état du shell. */
+int is_pure_builtin(const processus_t* cmd) {
+    const builtin_t* builtin = find_builtin(cmd);
+    return builtin != NULL && (builtin->flags & BUILTIN_PURE);
+}
+
+/** @brief Fonction de vérification si une commande intégrée recopie un flux. */
+int is_stream_builtin(const processus_t* cmd) {
+    const builtin_t* builtin = find_builtin(cmd);
+    return builtin != NULL && (builtin->flags & BUILTIN_STREAM);
+}
+
+/** @brief Fonction d'exécution d'une commande intégrée. */
 int exec_builtin(processus_t* cmd) {
-    if (cmd == NULL || cmd->argv[0] == NULL) {
+    const builtin_t* builtin = find_builtin(cmd);
+    if (builtin == NULL) {
         return -1;
     }
-    const char* name = cmd->argv[0];
 
-    if (strcmp(name, "cd") == 0) return builtin_cd(cmd);
-    if (strcmp(name, "exit") == 0) return builtin_exit(cmd);
-    if (strcmp(name, "export") == 0) return builtin_export(cmd);
-    if (strcmp(name, "unset") == 0) return builtin_unset(cmd);
-    if (strcmp(name, "pwd") == 0) return builtin_pwd(cmd);
+    // Les messages du shell encore dans le tampon de stdout doivent précéder la sortie de la commande
+    fflush(stdout);
 
-    return -1; // Commande non trouvée
+    builtin_io_t io;
+    io.in = cmd->stdin_fd;
+    out_init(&io.out, cmd->stdout_fd);
+    out_init(&io.err, cmd->stderr_fd == -1 ? cmd->stdout_fd : cmd->stderr_fd); // 2>&1
+    io.err.unbuffered = 1;
+    io.err.sync = &io.out;
+
+    int ret = builtin->fn(cmd, &io);
+    out_flush(&io.out);
+    return ret;
 }
 
 /** Fonctions spécifiques aux commandes intégrées. */
 
 /** @brief Fonction d'exécution de la commande "cd".
  */
-int builtin_cd(processus_t* cmd) {
+int builtin_cd(processus_t* cmd, builtin_io_t* io) {
     const char* path = cmd->argv[1];
 
     // Si pas d'argument, on va vers HOME
     if (path == NULL) {
-        path = getenv("HOME");
+        path = vars_get("HOME");
         if (path == NULL) {
-            fprintf(stderr, "cd: variable HOME non définie\n");
+            out_printf(&io->err, "cd: variable HOME non définie\n");
             return 1;
         }
     }
 
     // Tentative de changement de répertoire
     if (chdir(path) != 0) {
-        perror("cd");
+        out_printf(&io->err, "cd: %s\n", strerror(errno));
         return 1;
     }
 
     // Mise à jour de la variable PWD (bonne pratique)
     char cwd[PATH_MAX];
     if (getcwd(cwd, sizeof(cwd)) != NULL) {
-        setenv("PWD", cwd, 1);
+        vars_set("PWD", cwd, 1);
     }
 
     return 0;
@@ -87,9 +150,9 @@ int builtin_cd(processus_t* cmd) {
 
 /** @brief Fonction d'exécution de la commande "exit".
  */
-int builtin_exit(processus_t *proc)
-{
-    int status = 0;
+int builtin_exit(processus_t* proc, builtin_io_t* io) {
+    (void)io;
+    int status = last_status; // Sans argument : statut de la dernière commande
 
     // Si un argument est fourni : exit val
     if (proc->argv[1] != NULL) {
@@ -103,12 +166,10 @@ int builtin_exit(processus_t *proc)
 
 /** @brief Fonction d'exécution de la commande "export".
  */
-int builtin_export(processus_t* cmd) {
-    // Si pas d'argument, on affiche l'environnement
+int builtin_export(processus_t* cmd, builtin_io_t* io) {
+    // Si pas d'argument, on affiche les variables exportées
     if (cmd->argv[1] == NULL) {
-        for (char **env = environ; *env != 0; env++) {
-            printf("%s\n", *env);
-        }
+        vars_print_exported(&io->out);
         return 0;
     }
 
@@ -121,16 +182,19 @@ int builtin_export(processus_t* cmd) {
         char* name = arg;
         char* value = equal_sign + 1;
 
-        // setenv(nom, valeur, overwrite=1)
-        if (setenv(name, value, 1) != 0) {
-            perror("export");
+        if (vars_set(name, value, 1) != 0) {
+            out_printf(&io->err, "export: %s\n", strerror(errno));
             return 1;
         }
+        // Les résolutions de commandes en cache ne sont plus valables
+        if (strcmp(name, "PATH") == 0) pathcache_reset();
     } else {
-        // Format VAR (sans valeur)
-        // Dans POSIX, cela marque la variable pour l'export, 
-        // mais ici on peut juste ignorer ou vérifier si elle existe.
-        // Simplification: on ne fait rien si pas de valeur fournie.
+        // Format VAR (sans valeur) : une variable existante est marquée pour l'export
+        const char* value = vars_get(arg);
+        if (value != NULL && vars_set(arg, value, 1) != 0) {
+            out_printf(&io->err, "export: %s\n", strerror(errno));
+            return 1;
+        }
     }
 
     return 0;
@@ -138,33 +202,1019 @@ int builtin_export(processus_t* cmd) {
 
 /** @brief Fonction d'exécution de la commande "unset".
  */
-int builtin_unset(processus_t* cmd) {
+int builtin_unset(processus_t* cmd, builtin_io_t* io) {
     if (cmd->argv[1] == NULL) {
-        fprintf(stderr, "unset: arguments insuffisants\n");
+        out_printf(&io->err, "unset: arguments insuffisants\n");
         return 1;
     }
 
-    if (unsetenv(cmd->argv[1]) != 0) {
-        perror("unset");
+    if (vars_unset(cmd->argv[1]) != 0) {
+        out_printf(&io->err, "unset: %s\n", strerror(errno));
         return 1;
     }
+    if (strcmp(cmd->argv[1], "PATH") == 0) pathcache_reset();
 
     return 0;
 }
 
 /** @brief Fonction d'exécution de la commande "pwd".
  */
-int builtin_pwd(processus_t* cmd) {
+int builtin_pwd(processus_t* cmd, builtin_io_t* io) {
+    (void)cmd;
     char cwd[PATH_MAX];
 
     if (getcwd(cwd, sizeof(cwd)) != NULL) {
-        // On utilise printf qui écrit sur stdout.
-        // Comme exec_builtin est appelé APRES les redirections dup2 dans processus.c,
-        // ce printf ira bien dans le fichier si redirection il y a.
-        printf("%s\n", cwd);
+        // Écriture dans le tampon relié à la sortie du processus (redirection ou tube compris)
+        out_printf(&io->out, "%s\n", cwd);
         return 0;
     } else {
-        perror("pwd");
+        out_printf(&io->err, "pwd: %s\n", strerror(errno));
+        return 1;
+    }
+}
+
+/** @brief Décodage d'une séquence d'échappement de *echo -e* et *printf*.
+ * @param s Caractères qui suivent la barre oblique inverse.
+ * @param octal_zero Si non nul, les nombres octaux s'écrivent \\0nnn (echo, %b), sinon \\nnn (format de printf).
+ * @param buf Octets à écrire (1 ou 2).
+ * @param len Nombre d'octets de *buf*, -1 pour \\c (fin de la sortie).
+ * @return const char* Suite de la chaîne après la séquence.
+ */
+static const char* decode_escape(const char* s, int octal_zero, char buf[2], int* len) {
+    static const char simple[] = "\\\\a\ab\be\033f\fn\nr\rt\tv\v";
+    *len = 1;
+
+    for (const char* p = simple; *p; p += 2) {
+        if (*s == p[0]) {
+            buf[0] = p[1];
+            return s + 1;
+        }
+    }
+    if (*s == 'c') {
+        *len = -1;
+        return s + 1;
+    }
+    if (*s >= '0' && *s <= '7' && (!octal_zero || *s == '0')) {
+        if (octal_zero) s++;
+        int value = 0;
+        for (int i = 0; i < 3 && *s >= '0' && *s <= '7'; i++, s++) value = value * 8 + (*s - '0');
+        buf[0] = (char)value;
+        return s;
+    }
+    if (*s == 'x' && isxdigit((unsigned char)s[1])) {
+        char hex[3] = {s[1], isxdigit((unsigned char)s[2]) ? s[2] : '\0', '\0'};
+        buf[0] = (char)strtol(hex, NULL, 16);
+        return s + 1 + strlen(hex);
+    }
+
+    // Séquence inconnue (ou barre oblique inverse finale) : recopiée telle quelle
+    buf[0] = '\\';
+    if (*s == '\0') return s;
+    buf[1] = *s;
+    *len = 2;
+    return s + 1;
+}
+
+/** @brief Écriture d'une chaîne en interprétant les séquences d'échappement (voir decode_escape()).
+ * @return int 1 si \\c a été rencontrée (fin de la sortie), 0 sinon.
+ */
+static int put_escaped(outbuf_t* out, const char* s) {
+    while (*s) {
+        const char* bs = strchr(s, '\\');
+        if (bs == NULL) {
+            out_puts(out, s);
+            break;
+        }
+        out_write(out, s, bs - s);
+
+        char buf[2];
+        int len;
+        s = decode_escape(bs + 1, 1, buf, &len);
+        if (len < 0) return 1;
+        out_write(out, buf, len);
+    }
+    return 0;
+}
+
+/** @brief Copie d'une chaîne dont les séquences d'échappement sont interprétées (%b de *printf*).
+ * @param stop Passe à 1 si \\c a été rencontrée (la copie s'arrête là).
+ * @return char* Chaîne allouée par *malloc()* (les séquences ne font que raccourcir le texte), NULL si la mémoire manque.
+ */
+static char* expand_escapes(const char* s, int* stop) {
+    char* text = malloc(strlen(s) + 1);
+    if (text == NULL) return NULL;
+
+    char* d = text;
+    while (*s) {
+        if (*s != '\\') {
+            *d++ = *s++;
+            continue;
+        }
+        char buf[2];
+        int len;
+        s = decode_escape(s + 1, 1, buf, &len);
+        if (len < 0) {
+            *stop = 1;
+            break;
+        }
+        memcpy(d, buf, len);
+        d += len;
+    }
+    *d = '\0';
+    return text;
+}
+
+/** @brief Fonction d'exécution de la commande "echo".
+ */
+int builtin_echo(processus_t* cmd, builtin_io_t* io) {
+    int newline = 1;
+    int escapes = 0;
+    int i = 1;
+
+    // Options éventuellement regroupées : un argument qui n'est pas composé uniquement de n, e et E termine leur lecture
+    for (; cmd->argv[i] != NULL && cmd->argv[i][0] == '-' && cmd->argv[i][1] != '\0'; i++) {
+        const char* opt = cmd->argv[i] + 1;
+        if (opt[strspn(opt, "neE")] != '\0') break;
+        for (; *opt; opt++) {
+            if (*opt == 'n') newline = 0;
+            else escapes = (*opt == 'e');
+        }
+    }
+
+    for (; cmd->argv[i] != NULL; i++) {
+        if (!escapes) {
+            out_puts(&io->out, cmd->argv[i]);
+        } else if (put_escaped(&io->out, cmd->argv[i])) {
+            return 0; // \c : ni les arguments suivants, ni le saut de ligne
+        }
+        if (cmd->argv[i + 1] != NULL) out_write(&io->out, " ", 1);
+    }
+    if (newline) out_write(&io->out, "\n", 1);
+    return 0;
+}
+
+/** @brief Conversion d'un argument numérique de *printf*.
+ * @details Un argument absent ou vide vaut 0, *'c* ou *"c* vaut le code du caractère *c*. En cas d'argument invalide,
+ *    un message est affiché et *ret* passe à 1 (la partie lue est utilisée, comme dans les autres shells).
+ */
+static long long printf_integer(const char* arg, builtin_io_t* io, int* ret) {
+    if (arg == NULL || *arg == '\0') return 0;
+    if (*arg == '\'' || *arg == '"') return (unsigned char)arg[1];
+
+    char* end;
+    errno = 0;
+    long long value = strtoll(arg, &end, 0);
+    if (*end != '\0' || errno != 0) {
+        out_printf(&io->err, "printf: %s: nombre invalide\n", arg);
+        *ret = 1;
+    }
+    return value;
+}
+
+/** @brief Conversion d'un argument réel de *printf* (voir printf_integer()). */
+static double printf_double(const char* arg, builtin_io_t* io, int* ret) {
+    if (arg == NULL || *arg == '\0') return 0;
+    if (*arg == '\'' || *arg == '"') return (unsigned char)arg[1];
+
+    char* end;
+    errno = 0;
+    double value = strtod(arg, &end);
+    if (*end != '\0' || errno != 0) {
+        out_printf(&io->err, "printf: %s: nombre invalide\n", arg);
+        *ret = 1;
+    }
+    return value;
+}
+
+/** @brief Application du format de *printf* une fois, en consommant les arguments à partir de *args*.
+ * @return int 1 si la sortie doit s'arrêter (\\c ou conversion invalide), 0 sinon.
+ */
+static int printf_format(const char* format, char*** args, builtin_io_t* io, int* ret) {
+    const char* s = format;
+
+    while (*s) {
+        // Texte littéral jusqu'à la prochaine séquence d'échappement ou conversion
+        size_t n = strcspn(s, "\\%");
+        out_write(&io->out, s, n);
+        s += n;
+
+        if (*s == '\\') {
+            char buf[2];
+            int len;
+            s = decode_escape(s + 1, 0, buf, &len);
+            if (len < 0) return 1;
+            out_write(&io->out, buf, len);
+            continue;
+        }
+        if (*s != '%') break;
+        if (s[1] == '%') {
+            out_write(&io->out, "%", 1);
+            s += 2;
+            continue;
+        }
+
+        // Spécification : %[drapeaux][largeur][.précision]conversion, reconstruite pour out_printf()
+        char spec[64];
+        size_t k = 0;
+        int star[2];
+        int num_stars = 0;
+        spec[k++] = *s++;
+        while (*s && strchr("-+ #0", *s) && k < 16) spec[k++] = *s++;
+        for (int part = 0; part < 2; part++) {
+            if (part == 1) {
+                if (*s != '.') break;
+                spec[k++] = *s++;
+            }
+            if (*s == '*') {
+                star[num_stars++] = (int)printf_integer(**args, io, ret);
+                if (**args) (*args)++;
+                spec[k++] = *s++;
+            } else {
+                while (isdigit((unsigned char)*s) && k < sizeof(spec) - 8) spec[k++] = *s++;
+            }
+        }
+        while (*s && strchr("hlLjzt", *s)) s++; // Modificateurs de taille ignorés : les arguments sont convertis en long long
+
+        char conv = *s;
+        const char* arg = **args;
+        if (conv != '\0' && arg) (*args)++;
+
+        switch (conv) {
+            case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+                spec[k++] = 'l';
+                spec[k++] = 'l';
+                spec[k++] = conv;
+                spec[k] = '\0';
+                if (num_stars == 2) out_printf(&io->out, spec, star[0], star[1], printf_integer(arg, io, ret));
+                else if (num_stars == 1) out_printf(&io->out, spec, star[0], printf_integer(arg, io, ret));
+                else out_printf(&io->out, spec, printf_integer(arg, io, ret));
+                break;
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+                spec[k++] = conv;
+                spec[k] = '\0';
+                if (num_stars == 2) out_printf(&io->out, spec, star[0], star[1], printf_double(arg, io, ret));
+                else if (num_stars == 1) out_printf(&io->out, spec, star[0], printf_double(arg, io, ret));
+                else out_printf(&io->out, spec, printf_double(arg, io, ret));
+                break;
+            case 's': case 'c': case 'b': {
+                // %c : premier caractère de l'argument ; %b : argument dont les séquences d'échappement sont interprétées
+                char* text = NULL;
+                int stop = 0;
+                if (conv == 'c') {
+                    text = strndup(arg ? arg : "", 1);
+                } else if (conv == 'b' && arg) {
+                    text = expand_escapes(arg, &stop);
+                }
+                spec[k++] = 's';
+                spec[k] = '\0';
+                const char* value = text ? text : (arg ? arg : "");
+                if (num_stars == 2) out_printf(&io->out, spec, star[0], star[1], value);
+                else if (num_stars == 1) out_printf(&io->out, spec, star[0], value);
+                else out_printf(&io->out, spec, value);
+                free(text);
+                if (stop) return 1;
+                break;
+            }
+            default:
+                out_printf(&io->err, conv ? "printf: %%%c: conversion invalide\n" : "printf: %%%c: conversion manquante\n", conv);
+                *ret = 1;
+                return 1;
+        }
+        s++;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "printf".
+ */
+int builtin_printf(processus_t* cmd, builtin_io_t* io) {
+    if (cmd->argv[1] == NULL) {
+        out_printf(&io->err, "printf: usage: printf format [argument...]\n");
         return 1;
     }
-}
\ No newline at end of file
+
+    // Le format est réappliqué tant qu'il consomme des arguments
+    char** args = &cmd->argv[2];
+    int ret = 0;
+    do {
+        char** start = args;
+        if (printf_format(cmd->argv[1], &args, io, &ret)) break;
+        if (args == start) break;
+    } while (*args != NULL);
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "true".
+ */
+int builtin_true(processus_t* cmd, builtin_io_t* io) {
+    (void)cmd;
+    (void)io;
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "false".
+ */
+int builtin_false(processus_t* cmd, builtin_io_t* io) {
+    (void)cmd;
+    (void)io;
+    return 1;
+}
+
+/** @brief État de l'évaluation d'une expression de *test*.
+ * @details Analyse descendante : ou (-o) > et (-a) > négation (!) > expression primaire.
+ */
+typedef struct {
+    char** argv;       ///< Arguments de l'expression
+    int argc;          ///< Nombre d'arguments
+    int pos;           ///< Argument courant
+    int error;         ///< Erreur de syntaxe rencontrée
+    builtin_io_t* io;  ///< Entrées/sorties de la commande (messages, *-t*)
+} test_state_t;
+
+/** @brief Vérification si un argument est un opérateur binaire de *test*. */
+static int test_is_binary(const char* op) {
+    static const char* const ops[] = {"=", "==", "!=", "<", ">", "-eq", "-ne", "-lt", "-le", "-gt", "-ge",
+                                      "-nt", "-ot", "-ef", NULL};
+    for (int i = 0; ops[i] != NULL; i++) {
+        if (strcmp(op, ops[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+/** @brief Vérification si un argument est un opérateur unaire de *test*. */
+static int test_is_unary(const char* op) {
+    return op[0] == '-' && op[1] != '\0' && op[2] == '\0' && strchr("bcdefghkLnprsStuwxzOG", op[1]) != NULL;
+}
+
+/** @brief Conversion d'un opérande entier de *test* (espaces autour acceptés). */
+static long long test_integer(test_state_t* t, const char* arg) {
+    char* end;
+    errno = 0;
+    long long value = strtoll(arg, &end, 10);
+    while (isspace((unsigned char)*end)) end++;
+    if (end == arg || *end != '\0' || errno != 0) {
+        out_printf(&t->io->err, "test: %s: nombre entier attendu\n", arg);
+        t->error = 1;
+    }
+    return value;
+}
+
+/** @brief Évaluation d'un opérateur unaire de *test*. */
+static int test_unary(test_state_t* t, char op, const char* arg) {
+    struct stat st;
+
+    switch (op) {
+        case 'n': return arg[0] != '\0';
+        case 'z': return arg[0] == '\0';
+        case 'r': return access(arg, R_OK) == 0;
+        case 'w': return access(arg, W_OK) == 0;
+        case 'x': return access(arg, X_OK) == 0;
+        case 't': {
+            // Les descripteurs standards sont ceux de la commande, pas ceux du shell
+            int fd = (int)test_integer(t, arg);
+            if (fd == STDIN_FILENO) fd = t->io->in;
+            else if (fd == STDOUT_FILENO) fd = t->io->out.fd;
+            else if (fd == STDERR_FILENO) fd = t->io->err.fd;
+            return isatty(fd);
+        }
+        case 'h':
+        case 'L':
+            return lstat(arg, &st) == 0 && S_ISLNK(st.st_mode);
+    }
+
+    if (stat(arg, &st) != 0) return 0;
+    switch (op) {
+        case 'e': return 1;
+        case 'f': return S_ISREG(st.st_mode);
+        case 'd': return S_ISDIR(st.st_mode);
+        case 'b': return S_ISBLK(st.st_mode);
+        case 'c': return S_ISCHR(st.st_mode);
+        case 'p': return S_ISFIFO(st.st_mode);
+        case 'S': return S_ISSOCK(st.st_mode);
+        case 's': return st.st_size > 0;
+        case 'u': return (st.st_mode & S_ISUID) != 0;
+        case 'g': return (st.st_mode & S_ISGID) != 0;
+        case 'k': return (st.st_mode & S_ISVTX) != 0;
+        case 'O': return st.st_uid == geteuid();
+        case 'G': return st.st_gid == getegid();
+    }
+    return 0;
+}
+
+/** @brief Évaluation d'un opérateur binaire de *test*. */
+static int test_binary(test_state_t* t, const char* left, const char* op, const char* right) {
+    if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0) return strcmp(left, right) == 0;
+    if (strcmp(op, "!=") == 0) return strcmp(left, right) != 0;
+    if (strcmp(op, "<") == 0) return strcmp(left, right) < 0;
+    if (strcmp(op, ">") == 0) return strcmp(left, right) > 0;
+
+    if (strcmp(op, "-nt") == 0 || strcmp(op, "-ot") == 0 || strcmp(op, "-ef") == 0) {
+        // Un fichier inexistant est plus ancien que tout fichier existant
+        struct stat l, r;
+        int has_l = stat(left, &l) == 0;
+        int has_r = stat(right, &r) == 0;
+        if (op[1] == 'e') return has_l && has_r && l.st_dev == r.st_dev && l.st_ino == r.st_ino;
+        if (!has_l || !has_r) return (op[1] == 'n') ? has_l : has_r;
+
+        int cmp = (l.st_mtim.tv_sec > r.st_mtim.tv_sec) - (l.st_mtim.tv_sec < r.st_mtim.tv_sec);
+        if (cmp == 0) cmp = (l.st_mtim.tv_nsec > r.st_mtim.tv_nsec) - (l.st_mtim.tv_nsec < r.st_mtim.tv_nsec);
+        return (op[1] == 'n') ? cmp > 0 : cmp < 0;
+    }
+
+    long long a = test_integer(t, left);
+    long long b = test_integer(t, right);
+    if (strcmp(op, "-eq") == 0) return a == b;
+    if (strcmp(op, "-ne") == 0) return a != b;
+    if (strcmp(op, "-lt") == 0) return a < b;
+    if (strcmp(op, "-le") == 0) return a <= b;
+    if (strcmp(op, "-gt") == 0) return a > b;
+    return a >= b; // -ge
+}
+
+static int test_or(test_state_t* t);
+
+/** @brief Évaluation d'une expression primaire de *test* : opération binaire, parenthèses, opération unaire ou chaîne. */
+static int test_primary(test_state_t* t) {
+    if (t->pos >= t->argc) {
+        out_printf(&t->io->err, "test: argument attendu\n");
+        t->error = 1;
+        return 0;
+    }
+    char** argv = t->argv + t->pos;
+    int remaining = t->argc - t->pos;
+
+    // Un opérateur binaire en deuxième position l'emporte (ex: "[ ( = ( ]", "[ -n = -n ]")
+    if (remaining >= 3 && test_is_binary(argv[1])) {
+        t->pos += 3;
+        return test_binary(t, argv[0], argv[1], argv[2]);
+    }
+    if (strcmp(argv[0], "(") == 0 && remaining >= 2) {
+        t->pos++;
+        int value = test_or(t);
+        if (t->pos >= t->argc || strcmp(t->argv[t->pos], ")") != 0) {
+            if (!t->error) out_printf(&t->io->err, "test: ')' attendu\n");
+            t->error = 1;
+            return 0;
+        }
+        t->pos++;
+        return value;
+    }
+    if (test_is_unary(argv[0]) && remaining >= 2) {
+        t->pos += 2;
+        return test_unary(t, argv[0][1], argv[1]);
+    }
+
+    // Chaîne seule : vraie si elle n'est pas vide
+    t->pos++;
+    return argv[0][0] != '\0';
+}
+
+/** @brief Évaluation d'une négation de *test*. */
+static int test_not(test_state_t* t) {
+    int remaining = t->argc - t->pos;
+    if (remaining >= 2 && strcmp(t->argv[t->pos], "!") == 0 && !(remaining == 3 && test_is_binary(t->argv[t->pos + 1]))) {
+        t->pos++;
+        return !test_not(t);
+    }
+    return test_primary(t);
+}
+
+/** @brief Évaluation d'une conjonction (-a) de *test*. */
+static int test_and(test_state_t* t) {
+    int value = test_not(t);
+    while (!t->error && t->pos < t->argc && strcmp(t->argv[t->pos], "-a") == 0) {
+        t->pos++;
+        int right = test_not(t);
+        value = value && right;
+    }
+    return value;
+}
+
+/** @brief Évaluation d'une disjonction (-o) de *test*. */
+static int test_or(test_state_t* t) {
+    int value = test_and(t);
+    while (!t->error && t->pos < t->argc && strcmp(t->argv[t->pos], "-o") == 0) {
+        t->pos++;
+        int right = test_and(t);
+        value = value || right;
+    }
+    return value;
+}
+
+/** @brief Fonction d'exécution des commandes "test" et "[".
+ */
+int builtin_test(processus_t* cmd, builtin_io_t* io) {
+    const char* name = cmd->argv[0];
+    int argc = 0;
+    while (cmd->argv[argc] != NULL) argc++;
+
+    test_state_t t = {cmd->argv + 1, argc - 1, 0, 0, io};
+    if (strcmp(name, "[") == 0) {
+        if (argc < 2 || strcmp(cmd->argv[argc - 1], "]") != 0) {
+            out_printf(&io->err, "[: ']' manquant\n");
+            return 2;
+        }
+        t.argc--;
+    }
+
+    // Sans argument : faux
+    if (t.argc == 0) return 1;
+
+    int value = test_or(&t);
+    if (!t.error && t.pos < t.argc) {
+        out_printf(&io->err, "%s: %s: argument inattendu\n", name, t.argv[t.pos]);
+        t.error = 1;
+    }
+    if (t.error) return 2;
+    return value ? 0 : 1;
+}
+
+/** @brief Statut d'une commande de recopie après une erreur de transfert.
+ * @details Une sortie fermée (EPIPE, SIGPIPE étant ignoré par le shell) termine la commande silencieusement, avec le
+ *    statut qu'aurait un processus tué par SIGPIPE ; les autres erreurs sont signalées sur *io->err*.
+ */
+static int stream_error(builtin_io_t* io, const char* name, const char* file) {
+    if (errno == EPIPE) return 128 + SIGPIPE;
+    out_printf(&io->err, "%s: %s: %s\n", name, file, strerror(errno));
+    return 1;
+}
+
+/** @brief Ouverture d'un fichier en lecture pour cat, head et wc ("-" désigne l'entrée de la commande).
+ * @return int Descripteur ouvert, -1 en cas d'erreur (message affiché sur *io->err*).
+ */
+static int open_input(builtin_io_t* io, const char* name, const char* file) {
+    if (strcmp(file, "-") == 0) return io->in;
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) out_printf(&io->err, "%s: %s: %s\n", name, file, strerror(errno));
+    return fd;
+}
+
+/** @brief Vérification des arguments de cat : des fichiers ou "-", aucune option. */
+static int cat_accepts(const processus_t* cmd) {
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        if (cmd->argv[i][0] == '-' && cmd->argv[i][1] != '\0') return 0;
+    }
+    return 1;
+}
+
+/** @brief Fonction d'exécution de la commande "cat".
+ */
+int builtin_cat(processus_t* cmd, builtin_io_t* io) {
+    char* stdin_args[] = {"-", NULL};
+    char** files = (cmd->argv[1] != NULL) ? &cmd->argv[1] : stdin_args;
+    int ret = 0;
+
+    for (int i = 0; files[i] != NULL; i++) {
+        int fd = open_input(io, "cat", files[i]);
+        if (fd < 0) {
+            ret = 1;
+            continue;
+        }
+
+        // Un fichier recopié à la suite de lui-même ne finirait jamais de grandir
+        struct stat si, so;
+        if (fstat(fd, &si) == 0 && fstat(io->out.fd, &so) == 0 && S_ISREG(si.st_mode) && si.st_dev == so.st_dev &&
+            si.st_ino == so.st_ino && lseek(fd, 0, SEEK_CUR) < so.st_size) {
+            out_printf(&io->err, "cat: %s: le fichier d'entrée est le fichier de sortie\n", files[i]);
+            ret = 1;
+        } else if (io_copy(fd, io->out.fd, -1) < 0) {
+            ret = stream_error(io, "cat", files[i]);
+        }
+
+        if (fd != io->in) close(fd);
+        if (ret > 128) break;
+    }
+    return ret;
+}
+
+/** @brief Vérification des arguments de tee : *-a* puis des fichiers. */
+static int tee_accepts(const processus_t* cmd) {
+    int i = 1;
+    while (cmd->argv[i] != NULL && strcmp(cmd->argv[i], "-a") == 0) i++;
+    for (; cmd->argv[i] != NULL; i++) {
+        if (cmd->argv[i][0] == '-') return 0;
+    }
+    return 1;
+}
+
+/** @brief Fonction d'exécution de la commande "tee".
+ */
+int builtin_tee(processus_t* cmd, builtin_io_t* io) {
+    int append = 0;
+    int i = 1;
+    while (cmd->argv[i] != NULL && strcmp(cmd->argv[i], "-a") == 0) {
+        append = 1;
+        i++;
+    }
+
+    int* outs = malloc((cmd->argc + 1) * sizeof(int));
+    if (outs == NULL) {
+        out_printf(&io->err, "tee: mémoire insuffisante\n");
+        return 1;
+    }
+    int num_outs = 0;
+    int ret = 0;
+    outs[num_outs++] = io->out.fd;
+    for (; cmd->argv[i] != NULL; i++) {
+        int fd = open(cmd->argv[i], O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+        if (fd < 0) {
+            out_printf(&io->err, "tee: %s: %s\n", cmd->argv[i], strerror(errno));
+            ret = 1;
+            continue;
+        }
+        outs[num_outs++] = fd;
+    }
+
+    if (io_tee(io->in, outs, num_outs) < 0) ret = stream_error(io, "tee", "-");
+
+    for (int k = 1; k < num_outs; k++) close(outs[k]);
+    free(outs);
+    return ret;
+}
+
+/** @brief Lecture des arguments de head.
+ * @param count Nombre de lignes ou d'octets (10 lignes par défaut).
+ * @param bytes 1 pour *-c*, 0 pour des lignes.
+ * @param file Fichier à lire, NULL pour l'entrée de la commande.
+ * @return int 0 si les arguments sont pris en charge, -1 sinon.
+ */
+static int head_args(const processus_t* cmd, long long* count, int* bytes, const char** file) {
+    *count = 10;
+    *bytes = 0;
+    *file = NULL;
+
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        const char* arg = cmd->argv[i];
+        const char* value;
+
+        if (arg[0] != '-' || arg[1] == '\0') {
+            if (*file != NULL) return -1; // Plusieurs fichiers : en-têtes "==> f <==" laissés à la commande externe
+            *file = arg;
+            continue;
+        }
+        if (isdigit((unsigned char)arg[1])) {
+            value = arg + 1;
+            *bytes = 0;
+        } else if ((arg[1] == 'n' || arg[1] == 'c')) {
+            *bytes = (arg[1] == 'c');
+            value = (arg[2] != '\0') ? arg + 2 : cmd->argv[++i];
+            if (value == NULL) return -1;
+        } else {
+            return -1;
+        }
+
+        // Nombre positif en décimal uniquement (les suffixes et les nombres négatifs de GNU head ne sont pas pris en charge)
+        if (*value == '\0' || value[strspn(value, "0123456789")] != '\0') return -1;
+        errno = 0;
+        *count = strtoll(value, NULL, 10);
+        if (errno != 0) return -1;
+    }
+    return 0;
+}
+
+/** @brief Vérification des arguments de head (voir head_args()). */
+static int head_accepts(const processus_t* cmd) {
+    long long count;
+    int bytes;
+    const char* file;
+    return head_args(cmd, &count, &bytes, &file) == 0;
+}
+
+/** @brief Fonction d'exécution de la commande "head".
+ */
+int builtin_head(processus_t* cmd, builtin_io_t* io) {
+    long long count;
+    int bytes;
+    const char* file;
+    head_args(cmd, &count, &bytes, &file);
+
+    int fd = (file != NULL) ? open_input(io, "head", file) : io->in;
+    if (fd < 0) return 1;
+
+    int ret = 0;
+    long long n = bytes ? io_copy(fd, io->out.fd, count) : io_head_lines(fd, io->out.fd, count);
+    if (n < 0) ret = stream_error(io, "head", file ? file : "-");
+
+    if (fd != io->in) close(fd);
+    return ret;
+}
+
+/** @brief Lecture des arguments de wc : une seule des options *-l* ou *-c* (éventuellement répétée), au plus un fichier.
+ * @param lines 1 pour *-l*, 0 pour *-c*.
+ * @return int 0 si les arguments sont pris en charge, -1 sinon (affichage multi-colonnes laissé à la commande externe).
+ */
+static int wc_args(const processus_t* cmd, int* lines, const char** file) {
+    int mode = 0;
+    *file = NULL;
+
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        const char* arg = cmd->argv[i];
+        if (arg[0] != '-' || arg[1] == '\0') {
+            if (*file != NULL) return -1;
+            *file = arg;
+            continue;
+        }
+        for (const char* opt = arg + 1; *opt; opt++) {
+            if (*opt == 'l') mode |= 1;
+            else if (*opt == 'c') mode |= 2;
+            else return -1;
+        }
+    }
+    if (mode != 1 && mode != 2) return -1;
+    *lines = (mode == 1);
+    return 0;
+}
+
+/** @brief Vérification des arguments de wc (voir wc_args()). */
+static int wc_accepts(const processus_t* cmd) {
+    int lines;
+    const char* file;
+    return wc_args(cmd, &lines, &file) == 0;
+}
+
+/** @brief Fonction d'exécution de la commande "wc".
+ */
+int builtin_wc(processus_t* cmd, builtin_io_t* io) {
+    int lines;
+    const char* file;
+    wc_args(cmd, &lines, &file);
+
+    int fd = (file != NULL) ? open_input(io, "wc", file) : io->in;
+    if (fd < 0) return 1;
+
+    long long num_lines = 0;
+    long long num_bytes = 0;
+    int ret = 0;
+    if (io_count(fd, lines ? &num_lines : NULL, &num_bytes) != 0) {
+        out_printf(&io->err, "wc: %s: %s\n", file ? file : "-", strerror(errno));
+        ret = 1;
+    } else if (file != NULL) {
+        out_printf(&io->out, "%lld %s\n", lines ? num_lines : num_bytes, file);
+    } else {
+        out_printf(&io->out, "%lld\n", lines ? num_lines : num_bytes);
+    }
+
+    if (fd != io->in) close(fd);
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "set".
+ */
+int builtin_set(processus_t* cmd, builtin_io_t* io) {
+    // set ou set -o : affichage des options
+    if (cmd->argv[1] == NULL || (strcmp(cmd->argv[1], "-o") == 0 && cmd->argv[2] == NULL)) {
+        print_options(&io->out);
+        return 0;
+    }
+
+    if (strcmp(cmd->argv[1], "-o") != 0) {
+        out_printf(&io->err, "set: usage: set [-o nom=valeur]\n");
+        return 1;
+    }
+
+    // Formats acceptés : set -o nom=valeur ou set -o nom valeur
+    char name[64];
+    const char* value = NULL;
+    const char* equal_sign = strchr(cmd->argv[2], '=');
+    if (equal_sign != NULL) {
+        size_t len = equal_sign - cmd->argv[2];
+        if (len >= sizeof(name)) len = sizeof(name) - 1;
+        memcpy(name, cmd->argv[2], len);
+        name[len] = '\0';
+        value = equal_sign + 1;
+    } else {
+        snprintf(name, sizeof(name), "%s", cmd->argv[2]);
+        value = cmd->argv[3];
+    }
+
+    if (value == NULL || set_option(name, value) != 0) {
+        out_printf(&io->err, "set: option invalide '%s'\n", cmd->argv[2]);
+        return 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "hash".
+ */
+int builtin_hash(processus_t* cmd, builtin_io_t* io) {
+    // hash : affichage du cache
+    if (cmd->argv[1] == NULL) {
+        pathcache_print(&io->out);
+        return 0;
+    }
+
+    // hash -r : vidage du cache
+    if (strcmp(cmd->argv[1], "-r") == 0) {
+        pathcache_reset();
+        return 0;
+    }
+
+    // hash nom... : résolution et mise en cache des commandes données
+    int ret = 0;
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        if (pathcache_lookup(cmd->argv[i]) == NULL) {
+            out_printf(&io->err, "hash: %s: introuvable\n", cmd->argv[i]);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "plancache".
+ */
+int builtin_plancache(processus_t* cmd, builtin_io_t* io) {
+    // plancache : affichage des statistiques
+    if (cmd->argv[1] == NULL) {
+        plancache_print(&io->out);
+        return 0;
+    }
+
+    // plancache -r : vidage du cache et des compteurs
+    if (strcmp(cmd->argv[1], "-r") == 0 && cmd->argv[2] == NULL) {
+        plancache_reset();
+        return 0;
+    }
+
+    out_printf(&io->err, "plancache: usage: plancache [-r]\n");
+    return 1;
+}
+
+/** @brief Fonction d'exécution de la commande "globcache".
+ */
+int builtin_globcache(processus_t* cmd, builtin_io_t* io) {
+    // globcache : affichage des statistiques
+    if (cmd->argv[1] == NULL) {
+        wildcard_print(&io->out);
+        return 0;
+    }
+
+    // globcache -r : vidage du cache et des compteurs
+    if (strcmp(cmd->argv[1], "-r") == 0 && cmd->argv[2] == NULL) {
+        wildcard_reset();
+        return 0;
+    }
+
+    out_printf(&io->err, "globcache: usage: globcache [-r]\n");
+    return 1;
+}
+
+/** @brief Fonction d'exécution de la commande "alias".
+ */
+int builtin_alias(processus_t* cmd, builtin_io_t* io) {
+    // alias : affichage de tous les alias
+    if (cmd->argv[1] == NULL) {
+        alias_print_all(&io->out);
+        return 0;
+    }
+
+    int ret = 0, changed = 0;
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        char* arg = cmd->argv[i];
+        char* equal_sign = strchr(arg, '=');
+
+        // alias nom : affichage d'un alias
+        if (equal_sign == NULL) {
+            const alias_t* alias = alias_find(arg, strlen(arg));
+            if (alias != NULL) {
+                alias_print(alias, &io->out);
+            } else {
+                out_printf(&io->err, "alias: %s: non trouvé\n", arg);
+                ret = 1;
+            }
+            continue;
+        }
+
+        // alias nom=valeur : définition (la valeur est découpée en tokens une fois pour toutes)
+        *equal_sign = '\0';
+        if (alias_set(arg, equal_sign + 1) != 0) {
+            out_printf(&io->err, "alias: %s: %s\n", arg, strerror(errno));
+            ret = 1;
+            continue;
+        }
+        changed = 1;
+    }
+
+    // Les plans en cache ont été construits avec les anciens alias
+    if (changed) plancache_flush();
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "unalias".
+ */
+int builtin_unalias(processus_t* cmd, builtin_io_t* io) {
+    if (cmd->argv[1] == NULL) {
+        out_printf(&io->err, "unalias: usage: unalias [-a] nom...\n");
+        return 1;
+    }
+
+    // unalias -a : suppression de tous les alias
+    if (strcmp(cmd->argv[1], "-a") == 0 && cmd->argv[2] == NULL) {
+        alias_clear();
+        plancache_flush();
+        return 0;
+    }
+
+    int ret = 0;
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        if (alias_unset(cmd->argv[i]) != 0) {
+            out_printf(&io->err, "unalias: %s: non trouvé\n", cmd->argv[i]);
+            ret = 1;
+        }
+    }
+    plancache_flush();
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "jobs".
+ */
+int builtin_jobs(processus_t* cmd, builtin_io_t* io) {
+    (void)cmd;
+    jobs_update();
+    jobs_print(&io->out);
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "wait".
+ */
+int builtin_wait(processus_t* cmd, builtin_io_t* io) {
+    // wait : attente de toutes les tâches en cours
+    if (cmd->argv[1] == NULL) {
+        return jobs_wait_all();
+    }
+
+    // wait %n|pid... : statut de la dernière tâche attendue, 127 dès qu'une tâche est inconnue
+    int ret = 0;
+    int unknown = 0;
+    for (int i = 1; cmd->argv[i] != NULL; i++) {
+        job_t* job = jobs_find(cmd->argv[i]);
+        if (job == NULL) {
+            // Tâche terminée déjà retirée de la table (début de ligne) : son statut a été conservé
+            int status = jobs_saved_status(cmd->argv[i]);
+            if (status >= 0) {
+                ret = status;
+                continue;
+            }
+            out_printf(&io->err, "wait: %s: tâche inconnue\n", cmd->argv[i]);
+            unknown = 1;
+            continue;
+        }
+        ret = jobs_wait(job, 0);
+    }
+    return unknown ? 127 : ret;
+}
+
+/** @brief Fonction d'exécution de la commande "fg".
+ */
+int builtin_fg(processus_t* cmd, builtin_io_t* io) {
+    job_t* job = jobs_find(cmd->argv[1]);
+    if (job == NULL) {
+        out_printf(&io->err, "fg: %s: tâche inconnue\n", cmd->argv[1] ? cmd->argv[1] : "%%");
+        return 1;
+    }
+
+    out_printf(&io->out, "%s\n", job->command);
+    out_flush(&io->out);
+    int status = jobs_wait(job, 1);
+    return (status < 0) ? 128 + SIGTSTP : status; // Arrêtée de nouveau : statut de Ctrl+Z
+}
+
+/** @brief Fonction d'exécution de la commande "bg".
+ */
+int builtin_bg(processus_t* cmd, builtin_io_t* io) {
+    job_t* job = jobs_find(cmd->argv[1]);
+    if (job == NULL) {
+        out_printf(&io->err, "bg: %s: tâche inconnue\n", cmd->argv[1] ? cmd->argv[1] : "%%");
+        return 1;
+    }
+    if (jobs_continue(job) != 0) return 1;
+
+    out_printf(&io->out, "[%d] %s &\n", job->id, job->command);
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "parallel".
+ */
+int builtin_parallel(processus_t* cmd, builtin_io_t* io) {
+    long slots = 0;
+    int first = 1;
+
+    // -j N ou -jN : nombre de commandes simultanées (0 : une par processeur en ligne, valeur par défaut)
+    if (cmd->argv[1] != NULL && strncmp(cmd->argv[1], "-j", 2) == 0) {
+        const char* value = cmd->argv[1][2] ? cmd->argv[1] + 2 : cmd->argv[2];
+        char* end;
+        slots = value ? strtol(value, &end, 10) : -1;
+        if (value == NULL || *value == '\0' || *end != '\0' || slots < 0 || slots > INT_MAX) {
+            out_printf(&io->err, "parallel: nombre de tâches invalide\n");
+            return 1;
+        }
+        first = cmd->argv[1][2] ? 2 : 3;
+    }
+    if (cmd->argv[first] == NULL) {
+        out_printf(&io->err, "parallel: usage: parallel [-j N] commande [argument...]\n");
+        return 1;
+    }
+    if (slots == 0) slots = sysconf(_SC_NPROCESSORS_ONLN);
+    if (slots < 1) slots = 1;
+
+    return parallel_run(cmd->argv + first, (int)slots, io->in, &io->out, &io->err);
+}
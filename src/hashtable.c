@@ -0,0 +1,106 @@
+/** @file hashtable.c
+ * @brief Implementation of the open-addressing hash table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table de hachage à adressage ouvert : sondage linéaire dans un tableau dont la taille
+ *    est une puissance de 2, doublement au-delà de 3/4 de remplissage, suppression par décalage arrière.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashtable.h"
+
+/** @brief Fonction de hachage FNV-1a d'un nom. */
+uint32_t hash_name(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/** @brief Recherche de la case d'un nom.
+ * @return hash_entry_t* Case du nom, ou case vide où l'insérer (NULL si la table n'est pas allouée).
+ */
+static hash_entry_t* find_slot(const hash_table_t* table, const char* key, size_t len, uint32_t h) {
+    if (table->capacity == 0) return NULL;
+    size_t mask = table->capacity - 1;
+    size_t i = h & mask;
+    hash_entry_t* e;
+    while ((e = HASH_SLOT(table, i))->key != NULL) {
+        if (e->hash == h && e->key_len == len && memcmp(e->key, key, len) == 0) return e;
+        i = (i + 1) & mask;
+    }
+    return e;
+}
+
+/** @brief Doublement de la capacité de la table et réinsertion des entrées. */
+static int grow_table(hash_table_t* table) {
+    size_t new_capacity = table->capacity ? table->capacity * 2 : table->initial_capacity;
+    char* new_slots = calloc(new_capacity, table->entry_size);
+    if (!new_slots) return -1;
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        hash_entry_t* e = HASH_SLOT(table, i);
+        if (e->key == NULL) continue;
+        size_t j = e->hash & (new_capacity - 1);
+        while (((hash_entry_t*)(new_slots + j * table->entry_size))->key != NULL) j = (j + 1) & (new_capacity - 1);
+        memcpy(new_slots + j * table->entry_size, e, table->entry_size);
+    }
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    return 0;
+}
+
+/** @brief Fonction de recherche d'un nom. */
+hash_entry_t* hash_find(const hash_table_t* table, const char* key, size_t len, uint32_t h) {
+    hash_entry_t* e = find_slot(table, key, len, h);
+    return (e && e->key) ? e : NULL;
+}
+
+/** @brief Fonction de recherche de la case d'un nom, en vue d'une insertion. */
+hash_entry_t* hash_insert(hash_table_t* table, const char* key, size_t len, uint32_t h) {
+    hash_entry_t* e = find_slot(table, key, len, h);
+    if (e != NULL && e->key != NULL) return e;
+
+    if ((table->count + 1) * 4 > table->capacity * 3) {
+        if (grow_table(table) != 0) return NULL;
+        e = find_slot(table, key, len, h);
+    }
+    e->key_len = len;
+    e->hash = h;
+    table->count++;
+    return e;
+}
+
+/** @brief Fonction de suppression d'une entrée. */
+void hash_remove(hash_table_t* table, hash_entry_t* entry) {
+    size_t mask = table->capacity - 1;
+    size_t hole = ((char*)entry - table->slots) / table->entry_size;
+    entry->key = NULL;
+    table->count--;
+
+    // Décalage arrière : les entrées suivantes de la même séquence reprennent les cases libérées
+    size_t i = (hole + 1) & mask;
+    hash_entry_t* e;
+    while ((e = HASH_SLOT(table, i))->key != NULL) {
+        size_t home = e->hash & mask;
+        // L'entrée peut combler le trou si sa case d'origine n'est pas entre le trou (exclu) et elle (incluse)
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            memcpy(HASH_SLOT(table, hole), e, table->entry_size);
+            e->key = NULL;
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+/** @brief Fonction de vidage d'une table. */
+void hash_clear(hash_table_t* table) {
+    if (table->slots) memset(table->slots, 0, table->capacity * table->entry_size);
+    table->count = 0;
+}
@@ -0,0 +1,196 @@
+/** @file input.c
+ * @brief Implementation of command line input
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation des sources de lignes de commande du shell.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "input.h"
+
+/// Taille initiale du tampon de lecture d'un flux
+#define INITIAL_BUFFER_SIZE 65536
+
+/** @brief Ouverture d'un script. */
+int input_open_file(input_t* in, const char* path) {
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    // Fichier non régulier (tube nommé, périphérique...) : lecture en flux
+    if (!S_ISREG(st.st_mode)) {
+        input_open_stream(in, fd);
+        return 0;
+    }
+
+    // Fichier régulier : projection complète, les lignes sont lues directement dans les pages du fichier
+    if (st.st_size > 0) {
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        in->data = data;
+        in->size = in->map_size = st.st_size;
+    } else {
+        in->data = ""; // Script vide
+    }
+    close(fd);
+    return 0;
+}
+
+/** @brief Ouverture d'une chaîne de commandes. */
+void input_open_string(input_t* in, const char* str) {
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+    in->data = str;
+    in->size = strlen(str);
+}
+
+/** @brief Ouverture d'un flux. */
+void input_open_stream(input_t* in, int fd) {
+    memset(in, 0, sizeof(*in));
+    in->fd = fd;
+}
+
+/** @brief Indique si la ligne [start, newline[ se termine par une barre oblique inverse non protégée. */
+static int is_continued(const char* start, const char* newline) {
+    size_t backslashes = 0;
+    while (newline - backslashes > start && newline[-1 - (ptrdiff_t)backslashes] == '\\') backslashes++;
+    return backslashes % 2 == 1;
+}
+
+/** @brief Agrandissement du tampon pour qu'il contienne au moins *needed* octets.
+ * @return int 0 en cas de succès, -1 en cas d'échec d'allocation.
+ */
+static int reserve(input_t* in, size_t needed) {
+    if (needed <= in->buf_size) return 0;
+    size_t new_size = in->buf_size ? in->buf_size : INITIAL_BUFFER_SIZE;
+    while (new_size < needed) new_size *= 2;
+    char* buf = realloc(in->buf, new_size);
+    if (!buf) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return -1;
+    }
+    in->buf = buf;
+    in->buf_size = new_size;
+    return 0;
+}
+
+/** @brief Ligne suivante d'un texte complet.
+ * @details Les lignes continuées sont assemblées dans *buf* ; les autres sont des tranches de *data*.
+ */
+static const char* read_text_line(input_t* in, size_t* len) {
+    if (in->pos >= in->size) return NULL;
+
+    in->end = 0;
+    while (1) {
+        const char* line = in->data + in->pos;
+        const char* newline = memchr(line, '\n', in->size - in->pos);
+        size_t n = newline ? (size_t)(newline - line) : in->size - in->pos;
+        int continued = newline && is_continued(line, newline);
+        in->pos += n + (newline != NULL);
+
+        // Cas courant : ligne simple, aucune copie
+        if (!continued && in->end == 0) {
+            *len = n;
+            return line;
+        }
+
+        if (continued) n--; // Retrait de la barre oblique inverse
+        if (reserve(in, in->end + n) != 0) return NULL;
+        memcpy(in->buf + in->end, line, n);
+        in->end += n;
+        if (!continued || in->pos >= in->size) break;
+    }
+    *len = in->end;
+    return in->buf;
+}
+
+/** @brief Ligne suivante d'un flux. */
+static const char* read_stream_line(input_t* in, size_t* len) {
+    size_t scan = in->start; // Les octets avant *scan* ne contiennent aucun saut de ligne à traiter
+
+    while (1) {
+        char* newline = (scan < in->end) ? memchr(in->buf + scan, '\n', in->end - scan) : NULL;
+        if (newline) {
+            char* line = in->buf + in->start;
+            if (is_continued(line, newline)) {
+                // Retrait de "\\\n" sur place, puis recherche du saut de ligne suivant
+                memmove(newline - 1, newline + 1, in->buf + in->end - (newline + 1));
+                in->end -= 2;
+                scan = newline - 1 - in->buf;
+                continue;
+            }
+            *len = newline - line;
+            in->start = newline + 1 - in->buf;
+            return line;
+        }
+        scan = in->end;
+
+        if (in->eof) {
+            // Dernière ligne sans saut de ligne final
+            if (in->start == in->end) return NULL;
+            *len = in->end - in->start;
+            char* line = in->buf + in->start;
+            in->start = in->end;
+            return line;
+        }
+
+        // Les octets déjà consommés sont libérés : la ligne en cours revient au début du tampon
+        if (in->start > 0) {
+            memmove(in->buf, in->buf + in->start, in->end - in->start);
+            in->end -= in->start;
+            scan -= in->start;
+            in->start = 0;
+        }
+        if (in->end == in->buf_size && reserve(in, in->buf_size + 1) != 0) return NULL;
+
+        ssize_t n = read(in->fd, in->buf + in->end, in->buf_size - in->end);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (n < 0) perror("read");
+            in->eof = 1;
+        } else {
+            in->end += n;
+        }
+    }
+}
+
+/** @brief Lecture de la ligne suivante. */
+const char* input_read_line(input_t* in, size_t* len) {
+    return in->data ? read_text_line(in, len) : read_stream_line(in, len);
+}
+
+/** @brief Fermeture d'une source. */
+void input_close(input_t* in) {
+    if (in->map_size) munmap((void*)in->data, in->map_size);
+    free(in->buf);
+    // Seul un descripteur ouvert par input_open_file() est fermé (l'entrée standard reste ouverte)
+    if (in->fd > STDERR_FILENO) close(in->fd);
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+}
@@ -0,0 +1,225 @@
+/** @file iocopy.c
+ * @brief Implementation of in-kernel data transfers between file descriptors
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation des transferts de données des commandes intégrées cat, tee, head et wc.
+ */
+
+#define _GNU_SOURCE // splice(), tee(), copy_file_range()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+
+#include "iocopy.h"
+
+/// Nombre maximal d'octets demandés à chaque appel de transfert dans le noyau
+#define IO_CHUNK (1 << 30)
+
+/// Tampon de la méthode *read()* et *write()* (le shell n'a qu'un fil d'exécution)
+static char io_buffer[IO_BUFFER_SIZE];
+
+/** @brief Méthodes de transfert, par ordre de préférence. */
+typedef enum {
+    COPY_FILE_RANGE, ///< *copy_file_range()* : fichier régulier vers fichier régulier
+    COPY_SPLICE,     ///< *splice()* : l'une des extrémités est un tube
+    COPY_SENDFILE,   ///< *sendfile()* : source régulière
+    COPY_BUFFER      ///< *read()* et *write()*
+} copy_method_t;
+
+/** @brief Vérification si une erreur signifie que la méthode ne s'applique pas à ces descripteurs (méthode suivante). */
+static int unsupported(int err) {
+    return err == EINVAL || err == EXDEV || err == ENOSYS || err == EOPNOTSUPP || err == EBADF;
+}
+
+/** @brief Écriture complète de *len* octets (reprise après écriture partielle ou EINTR). */
+static int write_full(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief Transfert d'au plus *len* octets avec la méthode donnée.
+ * @return ssize_t Nombre d'octets transférés, 0 en fin de source, -1 en cas d'erreur.
+ */
+static ssize_t copy_chunk(copy_method_t method, int in, int out, size_t len) {
+    switch (method) {
+        case COPY_FILE_RANGE:
+            return copy_file_range(in, NULL, out, NULL, len, 0);
+        case COPY_SPLICE:
+            return splice(in, NULL, out, NULL, len, SPLICE_F_MOVE | SPLICE_F_MORE);
+        case COPY_SENDFILE:
+            return sendfile(out, in, NULL, len);
+        default: {
+            if (len > sizeof(io_buffer)) len = sizeof(io_buffer);
+            ssize_t n = read(in, io_buffer, len);
+            if (n > 0 && write_full(out, io_buffer, n) != 0) return -1;
+            return n;
+        }
+    }
+}
+
+/** @brief Fonction de copie des données d'un descripteur vers un autre. */
+long long io_copy(int in, int out, long long limit) {
+    struct stat si, so;
+    int reg_in = fstat(in, &si) == 0 && S_ISREG(si.st_mode);
+    int pipe_in = !reg_in && S_ISFIFO(si.st_mode);
+    int reg_out = fstat(out, &so) == 0 && S_ISREG(so.st_mode);
+    int pipe_out = !reg_out && S_ISFIFO(so.st_mode);
+
+    copy_method_t method = COPY_BUFFER;
+    if (reg_in && reg_out) method = COPY_FILE_RANGE;
+    else if (pipe_in || pipe_out) method = COPY_SPLICE;
+    else if (reg_in) method = COPY_SENDFILE;
+    if (reg_in) posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    long long total = 0;
+    while (limit < 0 || total < limit) {
+        size_t len = (limit < 0 || limit - total > IO_CHUNK) ? IO_CHUNK : (size_t)(limit - total);
+        ssize_t n = copy_chunk(method, in, out, len);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (method == COPY_BUFFER || !unsupported(errno)) return -1;
+
+            // Méthode suivante applicable : les positions ont avancé de ce qui a déjà été transféré
+            do {
+                method++;
+            } while ((method == COPY_SPLICE && !pipe_in && !pipe_out) || (method == COPY_SENDFILE && !reg_in));
+            continue;
+        }
+        total += n;
+    }
+    return total;
+}
+
+/** @brief Déplacement d'exactement *len* octets d'un tube vers un descripteur, par *splice()* si possible.
+ * @param use_splice Passe à 0 si *splice()* ne s'applique pas à la destination.
+ */
+static int move_exact(int in, int out, size_t len, int* use_splice) {
+    while (len > 0) {
+        ssize_t n;
+        if (*use_splice) {
+            n = splice(in, NULL, out, NULL, len, SPLICE_F_MOVE);
+            if (n < 0 && unsupported(errno)) {
+                *use_splice = 0;
+                continue;
+            }
+        } else {
+            n = read(in, io_buffer, len < sizeof(io_buffer) ? len : sizeof(io_buffer));
+            if (n > 0 && write_full(out, io_buffer, n) != 0) return -1;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief Fonction de copie des données d'un descripteur vers plusieurs autres (commande tee). */
+long long io_tee(int in, const int* outs, int num_outs) {
+    if (num_outs == 1) return io_copy(in, outs[0], -1);
+
+    struct stat si, so;
+    int fast = num_outs == 2 && fstat(in, &si) == 0 && S_ISFIFO(si.st_mode) && fstat(outs[0], &so) == 0 && S_ISFIFO(so.st_mode);
+    int use_splice = 1;
+    long long total = 0;
+
+    // Tube vers tube : duplication par tee(), puis consommation des mêmes octets vers la seconde destination
+    while (fast) {
+        ssize_t n = tee(in, outs[0], IO_CHUNK, 0);
+        if (n == 0) return total;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (!unsupported(errno)) return -1;
+            break;
+        }
+        if (move_exact(in, outs[1], n, &use_splice) != 0) return -1;
+        total += n;
+    }
+
+    while (1) {
+        ssize_t n = read(in, io_buffer, sizeof(io_buffer));
+        if (n == 0) return total;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        for (int i = 0; i < num_outs; i++) {
+            if (write_full(outs[i], io_buffer, n) != 0) return -1;
+        }
+        total += n;
+    }
+}
+
+/** @brief Fonction de copie des *count* premières lignes d'un descripteur (commande head -n). */
+long long io_head_lines(int in, int out, long long count) {
+    long long lines = 0;
+
+    while (lines < count) {
+        ssize_t n = read(in, io_buffer, sizeof(io_buffer));
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        const char* end = io_buffer + n;
+        const char* p = io_buffer;
+        const char* nl;
+        while (lines < count && (nl = memchr(p, '\n', end - p)) != NULL) {
+            p = nl + 1;
+            lines++;
+        }
+        size_t keep = (lines < count) ? (size_t)n : (size_t)(p - io_buffer);
+        if (write_full(out, io_buffer, keep) != 0) return -1;
+
+        // Les octets lus au-delà de la dernière ligne sont rendus à la source si elle le permet (ESPIPE ignoré pour un tube)
+        if (keep < (size_t)n) lseek(in, (off_t)keep - n, SEEK_CUR);
+    }
+    return lines;
+}
+
+/** @brief Fonction de comptage des lignes et des octets d'un descripteur jusqu'à sa fin (commande wc). */
+int io_count(int in, long long* lines, long long* bytes) {
+    struct stat st;
+    int regular = fstat(in, &st) == 0 && S_ISREG(st.st_mode);
+
+    // Octets seulement : taille restante d'un fichier régulier (hors fichiers de taille inconnue comme ceux de /proc)
+    if (lines == NULL && regular && st.st_size > 0) {
+        off_t pos = lseek(in, 0, SEEK_CUR);
+        if (pos >= 0) {
+            *bytes = (st.st_size > pos) ? st.st_size - pos : 0;
+            lseek(in, 0, SEEK_END);
+            return 0;
+        }
+    }
+    if (regular) posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    *bytes = 0;
+    if (lines) *lines = 0;
+    while (1) {
+        ssize_t n = read(in, io_buffer, sizeof(io_buffer));
+        if (n == 0) return 0;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        *bytes += n;
+        if (lines == NULL) continue;
+
+        const char* end = io_buffer + n;
+        for (const char* p = io_buffer; (p = memchr(p, '\n', end - p)) != NULL; p++) (*lines)++;
+    }
+}
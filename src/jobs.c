@@ -0,0 +1,369 @@
+/** @file jobs.c
+ * @brief Implementation of job control
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table des tâches : tableau de tâches dans l'ordre de création, récupération des
+ *    processus par *waitpid(-1, WNOHANG)* déclenchée par un tube interne alimenté par le gestionnaire de SIGCHLD.
+ */
+
+#define _GNU_SOURCE // pipe2()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "jobs.h"
+
+static job_t** jobs = NULL;   // Tâches, dans l'ordre de création
+static size_t num_jobs = 0;
+static size_t max_jobs = 0;
+static int sigchld_pipe[2] = {-1, -1};
+
+/** @brief Nombre de statuts conservés pour les tâches retirées de la table sans avoir été attendues. */
+#define MAX_SAVED_STATUSES 64
+
+/** @brief Statut du dernier processus d'une tâche retirée de la table (attente ultérieure par wait $!). */
+typedef struct {
+    pid_t pid;
+    int status;
+} saved_status_t;
+
+static saved_status_t saved_statuses[MAX_SAVED_STATUSES]; // File circulaire : les plus anciens sont écrasés
+static size_t num_saved = 0;                              // Nombre total de statuts conservés depuis le lancement
+
+/** @brief Gestionnaire de SIGCHLD : réveil de jobs_update() via le tube interne. */
+static void on_sigchld(int sig) {
+    (void)sig;
+    int saved_errno = errno;
+    ssize_t n = write(sigchld_pipe[1], "", 1); // Tube plein : un réveil est déjà en attente
+    (void)n;
+    errno = saved_errno;
+}
+
+/** @brief Initialisation de la gestion des tâches. */
+int jobs_init(void) {
+    if (pipe2(sigchld_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        perror("pipe2");
+        return -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigchld;
+    sa.sa_flags = SA_RESTART; // La lecture des commandes n'est pas interrompue
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGCHLD, &sa, NULL) != 0) {
+        perror("sigaction");
+        return -1;
+    }
+    return 0;
+}
+
+/** @brief Noms des états, indexés par job_state_t. */
+static const char* state_names[] = {"En cours", "Stoppé", "Fini"};
+
+/** @brief Donne le terminal au groupe de processus *pgid* (shell interactif uniquement). */
+static void give_terminal(pid_t pgid) {
+    if (shell_interactive) tcsetpgrp(STDIN_FILENO, pgid);
+}
+
+/** @brief Durée écoulée depuis le lancement de la tâche (jusqu'à sa fin si elle est terminée), en secondes. */
+static double job_elapsed(const job_t* job) {
+    struct timespec end = job->end_time;
+    if (job->state != JOB_DONE) clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - job->start_time.tv_sec) + (end.tv_nsec - job->start_time.tv_nsec) / 1e9;
+}
+
+/** @brief Recalcul de l'état d'une tâche à partir de celui de ses processus. */
+static void job_refresh(job_t* job) {
+    int running = 0, stopped = 0;
+    for (int i = 0; i < job->num_procs; i++) {
+        if (job->procs[i].state == JOB_RUNNING) running++;
+        else if (job->procs[i].state == JOB_STOPPED) stopped++;
+    }
+    job_state_t state = running ? JOB_RUNNING : stopped ? JOB_STOPPED : JOB_DONE;
+    if (state != job->state) {
+        job->state = state;
+        job->notified = 0;
+        if (state == JOB_DONE) clock_gettime(CLOCK_MONOTONIC, &job->end_time);
+    }
+}
+
+/** @brief Mise à jour d'un processus de tâche à partir du statut retourné par *waitpid()*. */
+static void job_proc_update(job_proc_t* proc, int wstatus) {
+    if (WIFSTOPPED(wstatus)) {
+        proc->state = JOB_STOPPED;
+    } else if (WIFCONTINUED(wstatus)) {
+        proc->state = JOB_RUNNING;
+    } else {
+        proc->state = JOB_DONE;
+        proc->status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1; // Terminé par signal : même convention que wait_processus()
+    }
+}
+
+/** @brief Retrait d'une tâche de la table. */
+static void job_remove(job_t* job) {
+    for (size_t i = 0; i < num_jobs; i++) {
+        if (jobs[i] == job) {
+            memmove(&jobs[i], &jobs[i + 1], (num_jobs - i - 1) * sizeof(job_t*));
+            num_jobs--;
+            break;
+        }
+    }
+    free(job);
+}
+
+/** @brief Retrait d'une tâche terminée qui n'a pas été attendue : son statut reste disponible pour wait. */
+static void job_forget(job_t* job) {
+    saved_status_t* saved = &saved_statuses[num_saved++ % MAX_SAVED_STATUSES];
+    saved->pid = job->procs[job->num_procs - 1].pid;
+    saved->status = jobs_status(job);
+    job_remove(job);
+}
+
+/** @brief Ajout d'un tube à la table des tâches. */
+job_t* jobs_add(control_flow_t* first, job_state_t state) {
+    int num_procs = 0;
+    size_t command_len = 0;
+    for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+        if (cf->proc->pid > 0) num_procs++;
+        for (int i = 0; i < cf->proc->argc; i++) command_len += strlen(cf->proc->argv[i]) + 1;
+        command_len += 3;
+    }
+    if (num_procs == 0) return NULL;
+
+    if (num_jobs == max_jobs) {
+        size_t new_max = max_jobs ? max_jobs * 2 : 16;
+        job_t** new_jobs = realloc(jobs, new_max * sizeof(job_t*));
+        if (!new_jobs) return NULL;
+        jobs = new_jobs;
+        max_jobs = new_max;
+    }
+
+    // La tâche, ses processus et le texte de la commande sont alloués d'un seul bloc
+    job_t* job = malloc(sizeof(job_t) + num_procs * sizeof(job_proc_t) + command_len + 1);
+    if (!job) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return NULL;
+    }
+    memset(job, 0, sizeof(job_t));
+    job->id = num_jobs ? jobs[num_jobs - 1]->id + 1 : 1;
+    job->command = (char*)&job->procs[num_procs];
+    job->command[0] = '\0';
+    clock_gettime(CLOCK_MONOTONIC, &job->start_time);
+
+    char* p = job->command;
+    for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+        processus_t* proc = cf->proc;
+        job->invert |= proc->invert;
+        if (cf != first) p = stpcpy(p, " | ");
+        for (int i = 0; i < proc->argc; i++) {
+            if (i > 0) *p++ = ' ';
+            p = stpcpy(p, proc->argv[i]);
+        }
+        if (proc->pid <= 0) continue;
+
+        // Tube arrêté au premier plan : les étages déjà terminés ont été récupérés
+        job_proc_t* jp = &job->procs[job->num_procs++];
+        jp->pid = proc->pid;
+        jp->status = proc->status;
+        jp->state = (state == JOB_STOPPED && !proc->stopped) ? JOB_DONE : state;
+        if (!job->pgid) job->pgid = proc->pgid;
+    }
+    job->state = state;
+    job_refresh(job);
+    jobs[num_jobs++] = job;
+
+    if (state == JOB_RUNNING) {
+        last_background_pid = job->procs[job->num_procs - 1].pid;
+        if (shell_interactive) printf("[%d] %d\n", job->id, last_background_pid);
+    } else if (shell_interactive) {
+        printf("\n[%d]  %s\t%s\n", job->id, state_names[job->state], job->command);
+        job->notified = 1;
+    }
+    return job;
+}
+
+/** @brief Récupération des processus terminés ou arrêtés. */
+void jobs_update(void) {
+    char drain[64];
+    int woken = 0;
+    while (read(sigchld_pipe[0], drain, sizeof(drain)) > 0) woken = 1;
+    if (!woken) return;
+
+    int wstatus;
+    pid_t pid;
+    while ((pid = waitpid(-1, &wstatus, WNOHANG | WUNTRACED | WCONTINUED)) > 0) jobs_reap(pid, wstatus);
+}
+
+/** @brief Prise en compte du nouvel état d'un processus récupéré par *waitpid()*. */
+int jobs_reap(pid_t pid, int wstatus) {
+    for (size_t j = 0; j < num_jobs; j++) {
+        job_t* job = jobs[j];
+        for (int i = 0; i < job->num_procs; i++) {
+            if (job->procs[i].pid == pid) {
+                job_proc_update(&job->procs[i], wstatus);
+                job_refresh(job);
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+/** @brief Signalement des tâches terminées. */
+void jobs_notify(void) {
+    for (size_t j = 0; j < num_jobs; ) {
+        job_t* job = jobs[j];
+        if (job->state == JOB_DONE) {
+            if (shell_interactive) printf("[%d]  %s\t%s\n", job->id, state_names[JOB_DONE], job->command);
+            job_forget(job);
+            continue;
+        }
+        if (shell_interactive && !job->notified && job->state == JOB_STOPPED) {
+            printf("[%d]  %s\t%s\n", job->id, state_names[JOB_STOPPED], job->command);
+            job->notified = 1;
+        }
+        j++;
+    }
+    fflush(stdout);
+}
+
+/** @brief Recherche d'une tâche. */
+job_t* jobs_find(const char* spec) {
+    if (num_jobs == 0) return NULL;
+    if (spec == NULL || strcmp(spec, "%%") == 0 || strcmp(spec, "%+") == 0) return jobs[num_jobs - 1];
+
+    char* end;
+    if (spec[0] == '%') {
+        long id = strtol(spec + 1, &end, 10);
+        if (spec[1] == '\0' || *end != '\0') return NULL;
+        for (size_t j = 0; j < num_jobs; j++) {
+            if (jobs[j]->id == id) return jobs[j];
+        }
+        return NULL;
+    }
+
+    long pid = strtol(spec, &end, 10);
+    if (*spec == '\0' || *end != '\0') return NULL;
+    for (size_t j = 0; j < num_jobs; j++) {
+        for (int i = 0; i < jobs[j]->num_procs; i++) {
+            if (jobs[j]->procs[i].pid == pid) return jobs[j];
+        }
+    }
+    return NULL;
+}
+
+/** @brief Statut d'une tâche déjà retirée de la table. */
+int jobs_saved_status(const char* spec) {
+    char* end;
+    long pid = strtol(spec, &end, 10);
+    if (*spec == '\0' || *end != '\0') return -1;
+
+    // Du plus récent au plus ancien : un PID réutilisé désigne la dernière tâche qui l'a porté
+    size_t count = num_saved < MAX_SAVED_STATUSES ? num_saved : MAX_SAVED_STATUSES;
+    for (size_t k = 1; k <= count; k++) {
+        const saved_status_t* saved = &saved_statuses[(num_saved - k) % MAX_SAVED_STATUSES];
+        if (saved->pid == pid) return saved->status;
+    }
+    return -1;
+}
+
+/** @brief Recherche d'une tâche par groupe de processus. */
+job_t* jobs_find_pgid(pid_t pgid) {
+    for (size_t j = 0; j < num_jobs; j++) {
+        if (jobs[j]->pgid == pgid) return jobs[j];
+    }
+    return NULL;
+}
+
+/** @brief Statut d'une tâche. */
+int jobs_status(const job_t* job) {
+    int status = job->procs[job->num_procs - 1].status;
+    return job->invert ? !status : status;
+}
+
+/** @brief Attente bloquante d'une tâche. */
+int jobs_wait(job_t* job, int foreground) {
+    if (foreground) {
+        give_terminal(job->pgid);
+        if (job->state == JOB_STOPPED) jobs_continue(job);
+    }
+
+    for (int i = 0; i < job->num_procs; i++) {
+        job_proc_t* proc = &job->procs[i];
+        while (proc->state == JOB_RUNNING || (!foreground && proc->state == JOB_STOPPED)) {
+            // Attente de n'importe quel fils : les autres tâches qui se terminent entre-temps gardent leur date de fin
+            int wstatus;
+            pid_t pid = waitpid(-1, &wstatus, foreground ? WUNTRACED : 0);
+            if (pid == -1) {
+                if (errno == EINTR) continue;
+                // Déjà récupéré ailleurs : considéré comme terminé
+                proc->state = JOB_DONE;
+                break;
+            }
+            if (pid == proc->pid) job_proc_update(proc, wstatus);
+            else jobs_reap(pid, wstatus);
+            if (proc->state == JOB_STOPPED) break;
+        }
+    }
+    job_refresh(job);
+
+    if (foreground) give_terminal(getpgrp());
+    if (job->state != JOB_DONE) {
+        if (shell_interactive) {
+            printf("\n[%d]  %s\t%s\n", job->id, state_names[job->state], job->command);
+            job->notified = 1;
+        }
+        return -1;
+    }
+
+    int status = jobs_status(job);
+    job_remove(job);
+    return status;
+}
+
+/** @brief Attente de toutes les tâches en cours. */
+int jobs_wait_all(void) {
+    for (size_t j = 0; j < num_jobs; ) {
+        if (jobs[j]->state == JOB_STOPPED) {
+            j++;
+            continue;
+        }
+        jobs_wait(jobs[j], 0); // Retire la tâche de la table
+    }
+    return 0;
+}
+
+/** @brief Reprise d'une tâche arrêtée. */
+int jobs_continue(job_t* job) {
+    if (kill(-job->pgid, SIGCONT) != 0) {
+        perror("kill");
+        return -1;
+    }
+    for (int i = 0; i < job->num_procs; i++) {
+        if (job->procs[i].state == JOB_STOPPED) job->procs[i].state = JOB_RUNNING;
+    }
+    job_refresh(job);
+    return 0;
+}
+
+/** @brief Affichage de la table des tâches. */
+void jobs_print(outbuf_t* out) {
+    for (size_t j = 0; j < num_jobs; ) {
+        job_t* job = jobs[j];
+        out_printf(out, "[%d]%c %-9s %8.3fs  %s%s\n", job->id, (j == num_jobs - 1) ? '+' : ' ', state_names[job->state],
+               job_elapsed(job), job->command, job->state == JOB_RUNNING ? " &" : "");
+        if (job->state == JOB_DONE) {
+            job_forget(job);
+            continue;
+        }
+        j++;
+    }
+}
@@ -10,10 +10,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <signal.h>
 
 #include "parser.h"
 #include "processus.h"
 #include "builtins.h"
+#include "options.h"
+#include "input.h"
+#include "jobs.h"
+#include "trace.h"
 
 /** @brief Affiche le prompt du shell.
  * @details Affiche le prompt "$ " et force l'affichage immédiat avec fflush.
@@ -25,59 +31,109 @@ void prompt() {
 }
 
 /** @brief Fonction principale du shell.
- * @param argc Nombre d'arguments (non utilisé).
- * @param argv Tableau des arguments (non utilisé).
+ * @param argc Nombre d'arguments.
+ * @param argv Tableau des arguments.
  * @return int Code de retour du programme. Ce code pourrait être le code de retour du dernier processus exécuté (optionnel).
- * @details Cette fonction gère la boucle principale du shell:
- * - Affiche le prompt
+ * @details Modes d'exécution :
+ * - *minishell* : lecture des commandes sur l'entrée standard (prompt affiché si elle est reliée à un terminal)
+ * - *minishell script.sh [args...]* : exécution d'un script ($0 = script, $1... = args)
+ * - *minishell -c 'commandes' [nom args...]* : exécution d'une chaîne de commandes ($0 = nom, $1... = args)
+ *
+ * Cette fonction gère la boucle principale du shell:
+ * - Affiche le prompt (mode interactif uniquement)
  * - Lit la ligne de commande
  * - Parse la ligne de commande
  * - Exécute les commandes
  * En cas d'erreur lors de l'exécution, un message est affiché sur stderr et la boucle continue.
- * Le shell se termine proprement en cas d'EOF (Ctrl+D) ou d'erreur fatale.
+ * Le shell se termine proprement en cas d'EOF (Ctrl+D, fin du script) ou d'erreur fatale, avec le statut de la dernière commande.
  */
+int main(int argc, char* argv[]) {
+    // Initialisation des structures nécessaires
+    // (mise à zéro avant le premier init_command_line : l'arène est vide)
+    command_line_t cmdl = {0};
+    input_t input;
 
+    init_options();
 
+    // Choix de la source des commandes et des paramètres positionnels
+    if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+        if (argc < 3) {
+            fprintf(stderr, "%s: -c: argument requis\n", argv[0]);
+            return 2;
+        }
+        input_open_string(&input, argv[2]);
+        positional_params = (argc > 3) ? &argv[3] : &argv[0];
+        num_positional_params = (argc > 3) ? argc - 3 : 1;
+    } else if (argc > 1) {
+        if (input_open_file(&input, argv[1]) != 0) return 127;
+        positional_params = &argv[1];
+        num_positional_params = argc - 1;
+    } else {
+        input_open_stream(&input, STDIN_FILENO);
+        positional_params = &argv[0];
+        num_positional_params = 1;
 
-int main(int argc, char* argv[]) {
-    (void) argc; // Pour éviter les warnings inutilisés
-    (void) argv; // Pour éviter les warnings inutilisés
-    // Initialisation des structures nécessaires
-    command_line_t cmdl;
+        // En mode interactif, le terminal est donné au groupe de processus de chaque tube au premier plan :
+        // le shell ignore SIGTTOU pour pouvoir le reprendre ensuite
+        // Les signaux du terminal (Ctrl+C, Ctrl+\, Ctrl+Z) ne concernent que le tube au premier plan
+        shell_interactive = isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+        if (shell_interactive) {
+            signal(SIGTTOU, SIG_IGN);
+            signal(SIGTTIN, SIG_IGN);
+            signal(SIGINT, SIG_IGN);
+            signal(SIGQUIT, SIG_IGN);
+            signal(SIGTSTP, SIG_IGN);
+        }
+    }
+    jobs_init();
+
+    // Les corps des documents en ligne (<<) sont lus sur la même source que les commandes
+    cmdl.input = &input;
+
+    // Une commande intégrée écrivant dans un tube fermé reçoit EPIPE au lieu de terminer le shell
+    signal(SIGPIPE, SIG_IGN);
 
     // Boucle principale du shell
     while (1) {
         // Initialisation de la structure de ligne de commande
         // On s'assure ici que tous les champs sont remis à zéro ou à leur valeur par défaut
         init_command_line(&cmdl);
-        prompt();
 
-        // Lecture de la ligne de commande
-        if (fgets(cmdl.command_line, sizeof(cmdl.command_line), stdin) == NULL) {
+        // Récupération des tâches terminées depuis la ligne précédente
+        jobs_update();
+        jobs_notify();
+        if (shell_interactive) prompt();
+
+        // Lecture de la ligne de commande, sans limite de longueur
+        size_t len;
+        const char* line = input_read_line(&input, &len);
+        if (line == NULL) {
             // EOF ou erreur de lecture (provoqué par exemple par Ctrl+D)
+            char* exit_argv[] = {"exit", NULL};
             processus_t exit_cmd;
             init_processus(&exit_cmd);
-            exit_cmd.argv[0] = "exit";
-            builtin_exit(&exit_cmd);
-        }
-        // Suppression du saut de ligne final conservé par fgets
-        if (strlen(cmdl.command_line) > 0 && cmdl.command_line[strlen(cmdl.command_line) - 1] == '\n') {
-            cmdl.command_line[strlen(cmdl.command_line) - 1] = '\0';
+            exit_cmd.argv = exit_argv;
+            exit_cmd.argc = 1;
+            input_close(&input);
+            free_command_line(&cmdl);
+            exec_builtin(&exit_cmd);
         }
 
         // La ligne de commande est vide, on passe à la suivante
-        if (strlen(cmdl.command_line) == 0) {
+        if (len == 0) {
             continue;
         }
 
         // Parsing de la ligne de commande
-        if (parse_command_line(&cmdl, cmdl.command_line) != 0) {
+        if (parse_command_line(&cmdl, line, len) != 0) {
             fprintf(stderr, "Erreur lors de l'analyse de la ligne de commandes.\n");
             continue;
         }
         
-        // Traitement de la ligne de commande
-        if (launch_command_line(&cmdl) != 0) {
+        // Traitement de la ligne de commande, puis écriture du journal d'exécution hors du chemin mesuré
+        int ret = launch_command_line(&cmdl);
+        trace_flush();
+        if (ret != 0) {
             fprintf(stderr, "Erreur à l'exécution de la ligne de commandes.\n");
             continue;
         }
@@ -0,0 +1,99 @@
+/** @file options.c
+ * @brief Implementation of shell options
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation des fonctions de gestion des options du shell.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "options.h"
+#include "pipes.h"
+#include "trace.h"
+
+shell_options_t shell_options = {
+    .spawn = SPAWN_FORK,
+    .plancache = 256,
+    .trace = NULL,
+    .pipesize = 0,
+};
+
+/** @brief Noms des méthodes de création des processus, indexés par spawn_backend_t. */
+static const char* spawn_names[] = {"fork", "posix_spawn"};
+
+/** @brief Fonction d'initialisation des options à partir de l'environnement. */
+int init_options(void) {
+    int ret = 0;
+    const char* spawn = getenv("MINISHELL_SPAWN");
+
+    if (spawn != NULL && set_option("spawn", spawn) != 0) {
+        fprintf(stderr, "MINISHELL_SPAWN: valeur invalide '%s'\n", spawn);
+        ret = -1;
+    }
+
+    const char* plancache = getenv("MINISHELL_PLANCACHE");
+    if (plancache != NULL && set_option("plancache", plancache) != 0) {
+        fprintf(stderr, "MINISHELL_PLANCACHE: valeur invalide '%s'\n", plancache);
+        ret = -1;
+    }
+
+    const char* trace = getenv("MINISHELL_TRACE");
+    if (trace != NULL && set_option("trace", trace) != 0) {
+        fprintf(stderr, "MINISHELL_TRACE: impossible d'ouvrir '%s'\n", trace);
+        ret = -1;
+    }
+
+    const char* pipesize = getenv("MINISHELL_PIPESIZE");
+    if (pipesize != NULL && set_option("pipesize", pipesize) != 0) {
+        fprintf(stderr, "MINISHELL_PIPESIZE: valeur invalide '%s'\n", pipesize);
+        ret = -1;
+    }
+    return ret;
+}
+
+/** @brief Fonction de modification d'une option. */
+int set_option(const char* name, const char* value) {
+    if (!name || !value) return -1;
+
+    if (strcmp(name, "spawn") == 0) {
+        for (size_t i = 0; i < sizeof(spawn_names) / sizeof(spawn_names[0]); i++) {
+            if (strcmp(value, spawn_names[i]) == 0) {
+                shell_options.spawn = (spawn_backend_t)i;
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    if (strcmp(name, "plancache") == 0) {
+        char* end;
+        unsigned long n = strtoul(value, &end, 10);
+        if (*value == '\0' || *value == '-' || *end != '\0') return -1;
+        shell_options.plancache = n;
+        return 0;
+    }
+
+    if (strcmp(name, "trace") == 0) {
+        if (trace_open(value) != 0) return -1;
+        free(shell_options.trace);
+        shell_options.trace = (*value != '\0') ? strdup(value) : NULL;
+        return 0;
+    }
+
+    if (strcmp(name, "pipesize") == 0) {
+        return pipe_parse_size(value, strlen(value), &shell_options.pipesize);
+    }
+
+    return -1; // Option inconnue
+}
+
+/** @brief Fonction d'affichage des options. */
+void print_options(outbuf_t* out) {
+    out_printf(out, "spawn=%s\n", spawn_names[shell_options.spawn]);
+    out_printf(out, "plancache=%zu\n", shell_options.plancache);
+    out_printf(out, "trace=%s\n", shell_options.trace ? shell_options.trace : "");
+    out_printf(out, "pipesize=%zu\n", shell_options.pipesize);
+}
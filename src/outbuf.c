@@ -0,0 +1,104 @@
+/** @file outbuf.c
+ * @brief Implementation of buffered output on file descriptors
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation des tampons de sortie des commandes intégrées.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "outbuf.h"
+
+/** @brief Initialisation d'un tampon de sortie. */
+void out_init(outbuf_t* out, int fd) {
+    out->fd = fd;
+    out->unbuffered = 0;
+    out->error = 0;
+    out->sync = NULL;
+    out->len = 0;
+}
+
+/** @brief Écriture complète d'un ensemble de tranches (reprise après écriture partielle ou EINTR). */
+static int write_all(outbuf_t* out, struct iovec* iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(out->fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            out->error = 1;
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+/** @brief Vidage du tampon. */
+int out_flush(outbuf_t* out) {
+    if (out->len == 0 || out->error) {
+        out->len = 0;
+        return out->error ? -1 : 0;
+    }
+    struct iovec iov = {out->data, out->len};
+    out->len = 0;
+    return write_all(out, &iov, 1);
+}
+
+/** @brief Écriture de *len* octets. */
+int out_write(outbuf_t* out, const char* data, size_t len) {
+    if (out->error) return -1;
+    if (out->sync && out->sync->len > 0) out_flush(out->sync);
+
+    if (out->len + len <= OUTBUF_SIZE) {
+        memcpy(out->data + out->len, data, len);
+        out->len += len;
+        return out->unbuffered ? out_flush(out) : 0;
+    }
+
+    // Ne tient pas dans le tampon : contenu en attente et nouvelles données en un seul appel système
+    struct iovec iov[2] = {{out->data, out->len}, {(void*)data, len}};
+    int first = (out->len == 0);
+    out->len = 0;
+    return write_all(out, iov + first, 2 - first);
+}
+
+/** @brief Écriture d'une chaîne. */
+int out_puts(outbuf_t* out, const char* str) {
+    return out_write(out, str, strlen(str));
+}
+
+/** @brief Écriture formatée. */
+int out_printf(outbuf_t* out, const char* format, ...) {
+    char local[OUTBUF_SIZE];
+    va_list ap;
+
+    va_start(ap, format);
+    int n = vsnprintf(local, sizeof(local), format, ap);
+    va_end(ap);
+    if (n < 0) return -1;
+    if ((size_t)n < sizeof(local)) return out_write(out, local, n);
+
+    // Résultat plus long que le tampon local : mise en forme dans un tampon de la bonne taille
+    char* big = malloc(n + 1);
+    if (!big) return -1;
+    va_start(ap, format);
+    vsnprintf(big, n + 1, format, ap);
+    va_end(ap);
+    int ret = out_write(out, big, n);
+    free(big);
+    return ret;
+}
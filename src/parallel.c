@@ -0,0 +1,341 @@
+/** @file parallel.c
+ * @brief Implementation of the parallel job runner
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'exécuteur de la commande *parallel* : lecture des lignes à la demande, emplacements de
+ *    commandes en cours surveillés par *poll()* sur leurs tubes de sortie, sorties remises dans l'ordre des lignes.
+ */
+
+#define _GNU_SOURCE // F_DUPFD_CLOEXEC
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "parallel.h"
+#include "pipes.h"
+#include "processus.h"
+
+/// Taille des lectures sur le tube de sortie d'une commande
+#define PARALLEL_CHUNK (64 * 1024)
+
+/// Statut maximal de parallel_run() (nombre de commandes en échec)
+#define PARALLEL_MAX_FAILED 101
+
+/** @brief Commande lancée pour une ligne.
+ * @struct par_job_t
+ */
+typedef struct {
+    processus_t proc;  ///< Processus de la commande (*argv* alloué par make_argv())
+    unsigned long seq; ///< Rang de la ligne
+    int out_fd;        ///< Bout de lecture du tube de sortie de la commande, -1 après la fin des données
+    char* line;        ///< Ligne d'arguments
+    char* data;        ///< Sortie en attente d'affichage
+    size_t len;        ///< Nombre d'octets en attente
+    size_t cap;        ///< Taille allouée pour *data*
+} par_job_t;
+
+/** @brief Lecture des lignes de l'entrée.
+ * @struct line_reader_t
+ */
+typedef struct {
+    int fd;       ///< Descripteur lu
+    int eof;      ///< Fin de l'entrée atteinte
+    char* buf;    ///< Octets lus
+    size_t start; ///< Début de la prochaine ligne dans *buf*
+    size_t len;   ///< Nombre d'octets non consommés à partir de *start*
+    size_t cap;   ///< Taille allouée pour *buf*
+} line_reader_t;
+
+/** @brief Prochaine ligne non vide de l'entrée (allouée, sans '\n'), NULL à la fin de l'entrée. */
+static char* next_line(line_reader_t* r) {
+    while (1) {
+        char* nl = r->len ? memchr(r->buf + r->start, '\n', r->len) : NULL;
+        if (nl != NULL || (r->eof && r->len > 0)) {
+            size_t n = nl ? (size_t)(nl - (r->buf + r->start)) : r->len;
+            char* line = strndup(r->buf + r->start, n);
+            size_t used = nl ? n + 1 : n;
+            r->start += used;
+            r->len -= used;
+            if (n == 0) {
+                free(line);
+                continue;
+            }
+            return line;
+        }
+        if (r->eof) return NULL;
+
+        // Ligne incomplète : elle est ramenée au début du tampon, agrandi s'il est plein
+        if (r->len > 0) memmove(r->buf, r->buf + r->start, r->len);
+        r->start = 0;
+        if (r->len == r->cap) {
+            size_t cap = r->cap ? r->cap * 2 : 4096;
+            char* buf = realloc(r->buf, cap);
+            if (!buf) return NULL;
+            r->buf = buf;
+            r->cap = cap;
+        }
+        ssize_t n = read(r->fd, r->buf + r->len, r->cap - r->len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) r->eof = 1;
+        else r->len += n;
+    }
+}
+
+/** @brief Copie d'un argument du modèle dont chaque "{}" est remplacé par *line*. */
+static char* substitute(const char* arg, const char* line) {
+    size_t count = 0, line_len = strlen(line);
+    for (const char* p = strstr(arg, "{}"); p; p = strstr(p + 2, "{}")) count++;
+
+    char* res = malloc(strlen(arg) + count * line_len + 1);
+    if (!res) return NULL;
+    char* w = res;
+    for (const char* p = arg; *p; ) {
+        if (p[0] == '{' && p[1] == '}') {
+            memcpy(w, line, line_len);
+            w += line_len;
+            p += 2;
+        } else {
+            *w++ = *p++;
+        }
+    }
+    *w = '\0';
+    return res;
+}
+
+/** @brief Arguments de la commande d'une ligne (tableau et chaînes alloués), NULL en cas d'échec d'allocation. */
+static char** make_argv(char* const* cmd, const char* line, int* argc) {
+    int n = 0, placeholder = 0;
+    for (; cmd[n] != NULL; n++) placeholder |= (strstr(cmd[n], "{}") != NULL);
+
+    char** argv = calloc(n + 2, sizeof(char*));
+    if (!argv) return NULL;
+    for (int i = 0; i < n; i++) argv[i] = substitute(cmd[i], line);
+    if (!placeholder) argv[n++] = strdup(line);
+
+    for (int i = 0; i < n; i++) {
+        if (argv[i] == NULL) {
+            for (int j = 0; j < n; j++) free(argv[j]);
+            free(argv);
+            return NULL;
+        }
+    }
+    *argc = n;
+    return argv;
+}
+
+/** @brief Libération d'une commande terminée. */
+static void free_job(par_job_t* job) {
+    if (job->proc.argv) {
+        for (int i = 0; i < job->proc.argc; i++) free(job->proc.argv[i]);
+        free(job->proc.argv);
+    }
+    free(job->line);
+    free(job->data);
+    free(job);
+}
+
+/** @brief Arrêt d'une commande encore en cours (sortie prématurée) : tuée, attendue puis libérée. */
+static void abort_job(par_job_t* job) {
+    if (job->out_fd >= 0) close(job->out_fd);
+    if (job->proc.pid > 0) kill(job->proc.pid, SIGTERM);
+    wait_processus(&job->proc);
+    free_job(job);
+}
+
+/** @brief Lancement de la commande d'une ligne, dont la sortie standard est un tube lu par le shell.
+ * @return par_job_t* Commande lancée (ou déjà terminée si elle est introuvable), NULL en cas d'échec d'allocation.
+ */
+static par_job_t* start_job(char* const* cmd, char* line, unsigned long seq, int err_fd, pid_t pgid) {
+    par_job_t* job = calloc(1, sizeof(par_job_t));
+    if (!job) {
+        free(line);
+        return NULL;
+    }
+    job->seq = seq;
+    job->line = line;
+    job->out_fd = -1;
+    init_processus(&job->proc);
+
+    job->proc.argv = make_argv(cmd, line, &job->proc.argc);
+    if (!job->proc.argv) {
+        free_job(job);
+        return NULL;
+    }
+    job->proc.path = job->proc.argv[0];
+
+    int pfd[2];
+    if (pipe_open(pfd, 0) == -1) {
+        perror("parallel: pipe2");
+        job->proc.status = 126;
+        return job;
+    }
+    job->out_fd = pfd[0];
+
+    // Descripteurs propres à la commande : spawn_processus() ferme côté père ceux qui dépassent 2
+    job->proc.stdin_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    job->proc.stdout_fd = pfd[1];
+    job->proc.stderr_fd = (err_fd > STDERR_FILENO) ? fcntl(err_fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1) : err_fd;
+    if (job->proc.stdin_fd < 0) job->proc.stdin_fd = STDIN_FILENO;
+    if (job->proc.stderr_fd < 0) job->proc.stderr_fd = STDERR_FILENO;
+
+    if (spawn_processus(&job->proc, pgid) != 0) {
+        if (job->proc.stdin_fd > STDERR_FILENO) close(job->proc.stdin_fd);
+        if (job->proc.stderr_fd > STDERR_FILENO) close(job->proc.stderr_fd);
+        close(pfd[1]);
+        job->proc.pid = 0;
+        job->proc.status = 126;
+    }
+    return job;
+}
+
+/** @brief Lecture de la sortie d'une commande : affichée si c'est la plus ancienne, mise en attente sinon.
+ * @return ssize_t Nombre d'octets lus, 0 à la fin des données (ou en cas d'erreur).
+ */
+static ssize_t read_output(par_job_t* job, unsigned long head, outbuf_t* out) {
+    static char chunk[PARALLEL_CHUNK];
+    ssize_t n;
+    while ((n = read(job->out_fd, chunk, sizeof(chunk))) < 0 && errno == EINTR) {}
+    if (n <= 0) return 0;
+
+    if (job->seq == head) {
+        out_write(out, chunk, n);
+        return n;
+    }
+    if (job->len + n > job->cap) {
+        size_t cap = job->cap ? job->cap : PARALLEL_CHUNK;
+        while (cap < job->len + n) cap *= 2;
+        char* data = realloc(job->data, cap);
+        if (!data) return 0;
+        job->data = data;
+        job->cap = cap;
+    }
+    memcpy(job->data + job->len, chunk, n);
+    job->len += n;
+    return n;
+}
+
+/** @brief Écriture de la sortie en attente d'une commande. */
+static void write_pending(par_job_t* job, outbuf_t* out) {
+    if (job->len > 0) out_write(out, job->data, job->len);
+    job->len = 0;
+}
+
+/** @brief Fonction d'exécution d'une commande par ligne de l'entrée. */
+int parallel_run(char* const* cmd, int slots, int in, outbuf_t* out, outbuf_t* err) {
+    line_reader_t reader = {.fd = in};
+    par_job_t** running = calloc(slots, sizeof(par_job_t*));
+    struct pollfd* fds = calloc(slots, sizeof(struct pollfd));
+    par_job_t** done = NULL;
+    size_t num_done = 0, max_done = 0;
+    int num_running = 0, input_done = 0, no_memory = 0;
+    unsigned long next_seq = 0, head = 0, failed = 0;
+    // Shell interactif : les commandes rejoignent le groupe du shell, au premier plan pendant *parallel*
+    pid_t pgid = shell_interactive ? getpgrp() : 0;
+
+    if (!running || !fds) {
+        out_printf(err, "parallel: mémoire insuffisante\n");
+        free(running);
+        free(fds);
+        return 1;
+    }
+
+    while (1) {
+        // Emplacements libres : une ligne chacun, dans l'ordre de l'entrée
+        while (!input_done && num_running < slots) {
+            char* line = next_line(&reader);
+            if (line == NULL) {
+                input_done = 1;
+                break;
+            }
+            par_job_t* job = start_job(cmd, line, next_seq, err->fd, pgid);
+            if (job == NULL) {
+                out_printf(err, "parallel: mémoire insuffisante\n");
+                input_done = 1;
+                break;
+            }
+            next_seq++;
+            running[num_running++] = job;
+        }
+        if (num_running == 0) break;
+
+        int timeout = -1; // Commande sans tube (échec de pipe2()) : déjà terminée, pas d'attente
+        for (int i = 0; i < num_running; i++) {
+            fds[i] = (struct pollfd){running[i]->out_fd, POLLIN, 0};
+            if (running[i]->out_fd < 0) timeout = 0;
+        }
+        if (poll(fds, num_running, timeout) < 0 && errno != EINTR) {
+            perror("parallel: poll");
+            break;
+        }
+
+        // Parcours à rebours : une commande terminée est remplacée par la dernière, déjà traitée
+        for (int i = num_running - 1; i >= 0; i--) {
+            par_job_t* job = running[i];
+            if (job->out_fd >= 0 && !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (job->out_fd >= 0 && read_output(job, head, out) > 0) continue;
+
+            // Fin des données : la commande est attendue et passe dans la liste des commandes terminées
+            if (job->out_fd >= 0) close(job->out_fd);
+            job->out_fd = -1;
+            wait_processus(&job->proc);
+            running[i] = running[--num_running];
+            if (num_done == max_done) {
+                size_t new_max = max_done ? max_done * 2 : 16;
+                par_job_t** new_done = realloc(done, new_max * sizeof(par_job_t*));
+                if (!new_done) {
+                    out_printf(err, "parallel: mémoire insuffisante\n");
+                    free_job(job);
+                    no_memory = 1;
+                    break;
+                }
+                done = new_done;
+                max_done = new_max;
+            }
+            done[num_done++] = job;
+        }
+        if (no_memory) break;
+
+        // Affichage des commandes terminées dans l'ordre des lignes
+        for (size_t i = 0; i < num_done; ) {
+            par_job_t* job = done[i];
+            if (job->seq != head) {
+                i++;
+                continue;
+            }
+            write_pending(job, out);
+            if (job->proc.status != 0) {
+                failed++;
+                out_printf(err, "parallel: %s: statut %d\n", job->line, job->proc.status);
+            }
+            free_job(job);
+            done[i] = done[--num_done];
+            head++;
+            i = 0;
+
+            // La commande suivante en cours devient la plus ancienne : elle écrit désormais directement
+            for (int r = 0; r < num_running; r++) {
+                if (running[r]->seq == head) write_pending(running[r], out);
+            }
+        }
+        out_flush(out);
+    }
+
+    if (failed > 0) out_printf(err, "parallel: %lu commande(s) en échec sur %lu\n", failed, next_seq);
+
+    // Sortie prématurée (mémoire, poll()) : aucune commande n'est laissée sans être attendue
+    for (int i = 0; i < num_running; i++) abort_job(running[i]);
+    for (size_t i = 0; i < num_done; i++) free_job(done[i]);
+    free(running);
+    free(fds);
+    free(done);
+    free(reader.buf);
+    if (no_memory) return 1;
+    return failed > PARALLEL_MAX_FAILED ? PARALLEL_MAX_FAILED : (int)failed;
+}
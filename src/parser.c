@@ -6,6 +6,8 @@
  * @details Implémentation des fonctions d'analyse des lignes de commande.
  */
 
+#define _GNU_SOURCE // F_GETPIPE_SZ
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,429 +16,1211 @@
 #include <fcntl.h>
 
 #include "parser.h"
+#include "alias.h"
 #include "processus.h"
+#include "options.h"
+#include "pipes.h"
+#include "plancache.h"
+#include "subst.h"
+#include "trace.h"
+#include "vars.h"
+#include "wildcard.h"
 
 extern int last_status;
 
-/** @brief Fonction de suppression des espaces inutiles au début et à la fin. */
-int trim(char* str) {
-    if (!str) return -1;
-    size_t len = strlen(str);
-    if (len == 0) return 0;
+/** @brief Remplacement de sous-chaîne. */
+int replace(char* str, const char* s, const char* t, size_t max) {
+    size_t s_len = strlen(s), t_len = strlen(t);
+    char* p = (s_len > 0) ? strstr(str, s) : NULL;
 
-    // Suppression à la fin (y compris le \n de fgets)
-    char* end = str + len - 1;
-    while (end >= str && (isspace(*end) || *end == '\n')) {
-        end--;
-    }
-    *(end + 1) = '\0';
+    if (!p) return 0; // Pas d'occurrence
 
-    // Suppression au début
-    char* start = str;
-    while (*start && isspace(*start)) {
-        start++;
+    // Une seule passe : chaque occurrence est cherchée à partir de la fin de la précédente
+    char* buffer = malloc(max);
+    if (!buffer) return -1;
+    size_t len = 0;
+    const char* src = str;
+    for (; p != NULL; p = strstr(src, s)) {
+        size_t prefix_len = p - src;
+        if (len + prefix_len + t_len >= max) { free(buffer); return -1; }
+        memcpy(buffer + len, src, prefix_len);
+        memcpy(buffer + len + prefix_len, t, t_len);
+        len += prefix_len + t_len;
+        src = p + s_len;
     }
 
-    if (start != str) {
-        memmove(str, start, strlen(start) + 1);
-    }
+    // Suffixe
+    size_t suffix_len = strlen(src);
+    if (len + suffix_len >= max) { free(buffer); return -1; }
+    memcpy(buffer + len, src, suffix_len + 1);
+    memcpy(str, buffer, len + suffix_len + 1);
+    free(buffer);
     return 0;
 }
 
-/** @brief Fonction de nettoyage (suppression doublons d'espaces). */
-int clean(char* str) {
-    if (!str) return -1;
-    char *dest = str;
-    char *src = str;
-    int space_found = 0;
+/** @brief Tampon d'écriture borné utilisé par les expansions. */
+typedef struct {
+    char* data;  ///< Zone d'écriture
+    size_t len;  ///< Nombre d'octets écrits
+    size_t max;  ///< Taille de la zone
+} expand_buf_t;
 
-    while (*src) {
-        if (isspace(*src)) {
-            if (!space_found) {
-                *dest++ = ' ';
-                space_found = 1;
-            }
-        } else {
-            *dest++ = *src;
-            space_found = 0;
-        }
-        src++;
-    }
-    *dest = '\0';
-    return trim(str); 
-}
-
-/** @brief Ajout d'espaces autour des séparateurs. */
-int separate_s(char* str, char* s, size_t max) {
-    if (!str || !s) return -1;
-    
-    char buffer[MAX_CMD_LINE];
-    size_t i = 0, j = 0;
-    
-    while (str[i] != '\0' && j < max - 2) {
-        int is_sep = 0;
-        // Vérifie si le caractère courant est un séparateur
-        for (int k = 0; s[k] != '\0'; k++) {
-            if (str[i] == s[k]) {
-                is_sep = 1;
-                break;
-            }
-        }
+/** @brief Ajout de *n* octets au tampon (les zones peuvent se recouvrir). */
+static int buf_put(expand_buf_t* b, const char* s, size_t n) {
+    if (b->len + n > b->max) return -1;
+    memmove(b->data + b->len, s, n);
+    b->len += n;
+    return 0;
+}
 
-        if (is_sep) {
-            buffer[j++] = ' ';
-            buffer[j++] = str[i];
-            buffer[j++] = ' ';
-        } else {
-            buffer[j++] = str[i];
-        }
-        i++;
+/** @brief Expansion d'une référence de variable ($?, $VAR ou ${VAR}).
+ * @param src Pointeur sur le '$'.
+ * @param end Fin de la zone à analyser.
+ * @param b Tampon de destination.
+ * @return int Nombre de caractères consommés dans *src*, -1 en cas de dépassement de taille.
+ * @details Un '$' qui n'est suivi d'aucun nom de variable est conservé tel quel.
+ */
+static int expand_dollar(const char* src, const char* end, expand_buf_t* b) {
+    const char* p = src + 1;
+    const char* name;
+    size_t name_len;
+    int consumed;
+
+    /* ===== Gestion de $? ===== */
+    if (p < end && *p == '?') {
+        char status_str[16];
+        int n = snprintf(status_str, sizeof(status_str), "%d", last_status);
+        return buf_put(b, status_str, n) == 0 ? 2 : -1;
     }
-    buffer[j] = '\0';
-    
-    if (j >= max) return -1; // Dépassement de taille
-    
-    strcpy(str, buffer);
-    return clean(str); //  nettoie les espaces multiples créés
-}
 
-/** @brief Remplacement de sous-chaîne. */
-int replace(char* str, const char* s, const char* t, size_t max) {
-    char buffer[MAX_CMD_LINE];
-    char *p;
-    
-    if (!(p = strstr(str, s))) return 0; // Pas d'occurrence
+    /* ===== Gestion de $! (dernier processus en arrière-plan) ===== */
+    if (p < end && *p == '!') {
+        char pid_str[16];
+        int n = last_background_pid ? snprintf(pid_str, sizeof(pid_str), "%d", (int)last_background_pid) : 0;
+        return buf_put(b, pid_str, n) == 0 ? 2 : -1;
+    }
+
+    /* ===== Paramètres positionnels : $0 à $9, $#, $@ et $* ===== */
+    if (p < end && *p == '#') {
+        char count_str[16];
+        int n = snprintf(count_str, sizeof(count_str), "%d", num_positional_params > 0 ? num_positional_params - 1 : 0);
+        return buf_put(b, count_str, n) == 0 ? 2 : -1;
+    }
+    if (p < end && (*p == '@' || *p == '*')) {
+        // Pas de découpage en mots : les paramètres sont joints par des espaces
+        for (int i = 1; i < num_positional_params; i++) {
+            if ((i > 1 && buf_put(b, " ", 1) != 0) ||
+                buf_put(b, positional_params[i], strlen(positional_params[i])) != 0) return -1;
+        }
+        return 2;
+    }
+    if (p < end && isdigit((unsigned char)*p)) {
+        int i = *p - '0';
+        if (i < num_positional_params && buf_put(b, positional_params[i], strlen(positional_params[i])) != 0) return -1;
+        return 2;
+    }
 
-    // Copie préfixe
-    size_t prefix_len = p - str;
-    if (prefix_len >= max) return -1;
-    strncpy(buffer, str, prefix_len);
-    buffer[prefix_len] = '\0';
+    /* ===== Gestion ${VAR} et $VAR ===== */
+    if (p < end && *p == '{') {
+        const char* close = memchr(p + 1, '}', end - p - 1);
+        if (!close) return buf_put(b, "$", 1) == 0 ? 1 : -1;
+        name = p + 1;
+        name_len = close - name;
+        consumed = close + 1 - src;
+    } else {
+        name = p;
+        while (p < end && (isalnum((unsigned char)*p) || *p == '_')) p++;
+        name_len = p - name;
+        consumed = p - src;
+        if (name_len == 0) return buf_put(b, "$", 1) == 0 ? 1 : -1;
+    }
 
-    // Ajout remplacement + suffixe
-    snprintf(buffer + prefix_len, max - prefix_len, "%s%s", t, p + strlen(s));
+    // ${N} : paramètre positionnel au-delà de $9
+    if (name_len > 0 && isdigit((unsigned char)name[0])) {
+        int i = 0;
+        for (size_t k = 0; k < name_len && isdigit((unsigned char)name[k]) && i < num_positional_params; k++) i = i * 10 + (name[k] - '0');
+        if (i < num_positional_params && buf_put(b, positional_params[i], strlen(positional_params[i])) != 0) return -1;
+        return consumed;
+    }
 
-    if (strlen(buffer) >= max) return -1;
-    strcpy(str, buffer);
-    
-    // Appel récursif pour traiter les occurrences suivantes
-    return replace(str, s, t, max);
+    // Recherche directe dans la table des variables, sans copie du nom
+    const char* val = vars_get_n(name, name_len);
+    if (val && buf_put(b, val, strlen(val)) != 0) return -1;
+    return consumed;
 }
 
 /** @brief Substitution des variables d'environnement ($VAR). */
 int substenv(char* str, size_t max) {
-    char buffer[MAX_CMD_LINE] = {0};
-    char varname[MAX_ENV];
-    size_t i = 0, j = 0;
-    
-while (str[i] && j < max - 1) {
-
-    /* ===== Gestion de $? ===== */
-    if (str[i] == '$' && str[i + 1] == '?') {
-        char status_str[16];
-        snprintf(status_str, sizeof(status_str), "%d", last_status);
+    if (!str || max == 0) return -1;
+    char* buffer = malloc(max);
+    if (!buffer) return -1;
+    expand_buf_t b = {buffer, 0, max - 1};
+    const char* end = str + strlen(str);
+    const char* p = str;
 
-        size_t len = strlen(status_str);
-        if (j + len >= max) return -1;
+    while (p < end) {
+        const char* dollar = memchr(p, '$', end - p);
+        if (!dollar) dollar = end;
+        if (buf_put(&b, p, dollar - p) != 0) break;
+        p = dollar;
+        if (p < end) {
+            int n = expand_dollar(p, end, &b);
+            if (n < 0) break;
+            p += n;
+        }
+    }
 
-        strcpy(buffer + j, status_str);
-        j += len;
-        i += 2;
+    int ret = (p < end) ? -1 : 0; // Arrêt prématuré : dépassement de taille
+    if (ret == 0) {
+        buffer[b.len] = '\0';
+        memcpy(str, buffer, b.len + 1);
     }
+    free(buffer);
+    return ret;
+}
 
-    /* ===== Gestion $VAR ===== */
-    else if (str[i] == '$') {
-        i++; 
-        int v = 0;
+static const char* subst_close(const char* p, const char* end);
 
-        if (str[i] == '{') {
-            i++;
-            while (str[i] && str[i] != '}')
-                varname[v++] = str[i++];
-            if (str[i] == '}') i++;
-        } else {
-            while (str[i] && (isalnum(str[i]) || str[i] == '_'))
-                varname[v++] = str[i++];
+/** @brief Début d'une substitution de commande "$(" en *p*.
+ * @details "$((" (expansion arithmétique, non prise en charge) n'en est pas une : le texte reste littéral.
+ */
+static int is_subst(const char* p, const char* end) {
+    return end - p >= 2 && p[0] == '$' && p[1] == '(' && !(end - p >= 3 && p[2] == '(');
+}
+
+/** @brief Recherche du guillemet double fermant (les substitutions $(...) qu'il contient sont sautées).
+ * @param p Pointeur sur le guillemet ouvrant.
+ * @return const char* Pointeur sur le guillemet fermant, NULL s'il n'y en a pas avant *end*.
+ */
+static const char* dquote_close(const char* p, const char* end) {
+    for (p++; p < end; p++) {
+        if (*p == '"') return p;
+        if (*p == '\\') p++;
+        else if (is_subst(p, end)) {
+            p = subst_close(p, end);
+            if (!p) return NULL;
         }
-        varname[v] = '\0';
+    }
+    return NULL;
+}
 
-        char *val = getenv(varname);
-        if (val) {
-            size_t len = strlen(val);
-            if (j + len >= max) return -1;
-            strcpy(buffer + j, val);
-            j += len;
+/** @brief Recherche de la parenthèse fermante d'une substitution de commande.
+ * @param p Pointeur sur le '$' de "$(".
+ * @return const char* Pointeur sur la ')' correspondante, NULL si elle n'existe pas avant *end*.
+ * @details Les parenthèses sont comptées ; celles écrites entre guillemets ou protégées par '\\' sont ignorées.
+ */
+static const char* subst_close(const char* p, const char* end) {
+    int depth = 0;
+    for (p++; p < end; p++) {
+        if (*p == '(') depth++;
+        else if (*p == ')') {
+            if (--depth == 0) return p;
+        }
+        else if (*p == '\\') p++;
+        else if (*p == '\'') {
+            p = memchr(p + 1, '\'', end - p - 1);
+            if (!p) return NULL;
+        }
+        else if (*p == '"') {
+            p = dquote_close(p, end);
+            if (!p) return NULL;
         }
     }
+    return NULL;
+}
 
-    /* ===== Caractère normal ===== */
-    else {
-        buffer[j++] = str[i++];
+/** @brief Expansion d'une substitution de commande $(...) (voir subst.h).
+ * @param src Pointeur sur le '$'.
+ * @param split 1 : les blancs de la sortie (espace, tabulation, saut de ligne) sont remplacés par '\0', qui sépare les mots.
+ * @return int Nombre de caractères consommés dans *src*, -1 en cas de dépassement de taille.
+ * @details Une substitution non fermée laisse le '$' tel quel. Si la commande ne peut pas être lancée, la sortie est vide.
+ */
+static int expand_subst(const char* src, const char* end, expand_buf_t* b, int split) {
+    const char* close = subst_close(src, end);
+    if (!close) return buf_put(b, "$", 1) == 0 ? 1 : -1;
+
+    const char* out = "";
+    size_t len;
+    if (subst_run(src + 2, close - src - 2, &out, &len) != 0) len = 0;
+    if (buf_put(b, out, len) != 0) return -1;
+    if (split) {
+        for (size_t k = b->len - len; k < b->len; k++) {
+            if (b->data[k] == ' ' || b->data[k] == '\t' || b->data[k] == '\n') b->data[k] = '\0';
+        }
     }
+    return close + 1 - src;
 }
 
-    buffer[j] = '\0';
-    strcpy(str, buffer);
-    return 0;
+/// Modes d'expansion d'un mot (voir expand_word_mode())
+enum {
+    EXPAND_WORD,    ///< Mot final
+    EXPAND_PATTERN, ///< Motif de jokers
+    EXPAND_FIELDS   ///< Mots séparés par '\0' (sortie des substitutions hors guillemets découpée)
+};
+
+/** @brief Caractères à protéger dans un motif de jokers. */
+static int is_pattern_char(char c) {
+    return c == '*' || c == '?' || c == '[' || c == ']' || c == '\\';
 }
 
-/** @brief Découpage en tokens. */
-int strcut(char* str, char sep, char** tokens, size_t max) {
-    int count = 0;
-    char delim[2] = {sep, '\0'};
-    char* ptr = NULL;
-    
-    // strtok_r est thread-safe et plus robuste que strtok
-    char* token = strtok_r(str, delim, &ptr);
-    while (token != NULL && count < (int)max - 1) {
-        tokens[count++] = token;
-        token = strtok_r(NULL, delim, &ptr);
+/** @brief Protection par '\\' des caractères de motif écrits dans le tampon à partir de *from*.
+ * @details Utilisée pour le texte qui ne vient pas directement de la ligne (guillemets, variables, $HOME) : dans un
+ *    motif, il ne doit jamais être interprété comme un joker.
+ */
+static int buf_quote_from(expand_buf_t* b, size_t from) {
+    size_t count = 0;
+    for (size_t k = from; k < b->len; k++) count += is_pattern_char(b->data[k]);
+    if (count == 0) return 0;
+    if (b->len + count > b->max) return -1;
+
+    // Décalage de droite à gauche : chaque caractère de motif est précédé d'un '\\'
+    size_t r = b->len, w = b->len + count;
+    while (r > from) {
+        char c = b->data[--r];
+        b->data[--w] = c;
+        if (is_pattern_char(c)) b->data[--w] = '\\';
     }
-    tokens[count] = NULL;
-    return count;
+    b->len += count;
+    return 0;
 }
 
-/** @brief Analyse de la ligne de commande. */
-int parse_command_line(command_line_t* cmdl, const char* line) {
-    // 1. Copie et nettoyage initial
-    strncpy(cmdl->command_line, line, MAX_CMD_LINE - 1);
-    cmdl->command_line[MAX_CMD_LINE - 1] = '\0';
-
-    if (trim(cmdl->command_line) != 0) return -1;
-    if (clean(cmdl->command_line) != 0) return -1;
-
-    // 2. Séparation des opérateurs et substitution
-    // On sépare ; | & < > !
-    if (separate_s(cmdl->command_line, ";|&<>!", MAX_CMD_LINE) != 0) return -1;
-    if (substenv(cmdl->command_line, MAX_CMD_LINE) != 0) return -1;
-    
-    // 3. Tokenisation
-    int num_tokens = strcut(cmdl->command_line, ' ', cmdl->tokens, MAX_CMD_LINE / 2 + 1);
-    if (num_tokens < 0) return -1;
-    if (num_tokens == 0) return 0; 
-
-    // 4. Analyse logique
-    int token_index = 0;
-    int argv_index = 0;
-    processus_t* current_proc = add_processus(cmdl, UNCONDITIONAL);
-    if (!current_proc) return -1;
-
-    while (cmdl->tokens[token_index] != NULL) {
-        char* token = cmdl->tokens[token_index];
-        char* next_token = cmdl->tokens[token_index + 1];
-        char* next_next_token = (next_token) ? cmdl->tokens[token_index + 2] : NULL;
-        
-        int is_operator = 0;
-
-        // --- Opérateurs de Contrôle de flux --- //
-
-        // Cas : ;
-        if (strcmp(token, ";") == 0) {
-            is_operator = 1;
-            // Si ce n'est pas la fin de la ligne, on prépare la suite
-            if (next_token) {
-                current_proc = add_processus(cmdl, UNCONDITIONAL);
-                argv_index = 0;
-            }
+/** @brief Expansion d'un mot brut, en mot final, en motif de jokers ou en mots découpés.
+ * @param mode EXPAND_WORD : mot final ; EXPAND_PATTERN : motif où seuls les caractères écrits hors guillemets dans la ligne
+ *    restent des jokers, les autres étant protégés par '\\' (la zone de sortie ne doit alors pas recouvrir *src*) ;
+ *    EXPAND_FIELDS : mot final où la sortie des substitutions $(...) hors guillemets est découpée en mots séparés par '\0'.
+ */
+static int expand_word_mode(const char* src, size_t len, char* out, size_t max, int mode) {
+    int pattern = (mode == EXPAND_PATTERN);
+    expand_buf_t b = {out, 0, max};
+    size_t i = 0;
+    int in_dquote = 0;
+
+    // ~ ou ~/... en début de mot
+    if (len > 0 && src[0] == '~' && (len == 1 || src[1] == '/')) {
+        const char* home = vars_get("HOME");
+        if (home) {
+            if (buf_put(&b, home, strlen(home)) != 0) return -1;
+            if (pattern && buf_quote_from(&b, 0) != 0) return -1;
+            i = 1;
         }
-        // Cas : | ou ||
-        else if (strcmp(token, "|") == 0) {
-            is_operator = 1;
-            if (next_token && strcmp(next_token, "|") == 0) {
-                // C'est un OR (||)
-                token_index++; // On consomme le 2ème |
-                if (cmdl->tokens[token_index + 1]) {
-                    current_proc = add_processus(cmdl, ON_FAILURE);
-                    argv_index = 0;
-                }
+    }
+
+    while (i < len) {
+        char c = src[i];
+        size_t from = b.len;
+
+        if (c == '\'' && !in_dquote) {
+            // Guillemets simples : contenu littéral (fermeture garantie par l'analyse lexicale)
+            const char* close = memchr(src + i + 1, '\'', len - i - 1);
+            size_t n = close ? (size_t)(close - (src + i + 1)) : len - i - 1;
+            if (buf_put(&b, src + i + 1, n) != 0) return -1;
+            i += n + 2;
+        }
+        else if (c == '"') {
+            in_dquote = !in_dquote;
+            i++;
+        }
+        else if (c == '\\' && i + 1 < len) {
+            // Entre guillemets doubles, seuls " \ $ ` sont protégés
+            if (in_dquote && !strchr("\"\\$`", src[i + 1])) {
+                if (buf_put(&b, &c, 1) != 0) return -1;
+                i++;
             } else {
-                // C'est un PIPE (|)
-                int pfd[2];
-                if (pipe(pfd) == -1) {
-                    perror("pipe");
-                    close_fds(cmdl);
-                    return -1;
-                }
-                // Redirection sortie du courant -> entrée du tube
-                current_proc->stdout_fd = pfd[1];
-                add_fd(cmdl, pfd[1]);
-
-                // Création du processus suivant (connecté inconditionnellement)
-                current_proc = add_processus(cmdl, UNCONDITIONAL);
-                if (!current_proc) return -1;
-                argv_index = 0;
-
-                // Redirection entrée du suivant -> sortie du tube
-                current_proc->stdin_fd = pfd[0];
-                add_fd(cmdl, pfd[0]);
+                if (buf_put(&b, src + i + 1, 1) != 0) return -1;
+                i += 2;
             }
         }
-        else if (strcmp(token, "~") == 0) 
-        {
-            char *home = getenv("HOME");
-            if (!home) {
-                fprintf(stderr, "HOME not set\n");
+        else if (c == '$') {
+            int n = is_subst(src + i, src + len) ? expand_subst(src + i, src + len, &b, mode == EXPAND_FIELDS && !in_dquote)
+                                                 : expand_dollar(src + i, src + len, &b);
+            if (n < 0) return -1;
+            i += n;
+        }
+        else {
+            if (buf_put(&b, &c, 1) != 0) return -1;
+            i++;
+            if (!in_dquote) continue; // Seul cas où un caractère de motif reste un joker
+        }
+        if (pattern && buf_quote_from(&b, from) != 0) return -1;
+    }
+
+    return (int)b.len;
+}
+
+/** @brief Expansion d'un mot brut (guillemets, échappements, variables, ~). */
+int expand_word(const char* src, size_t len, char* out, size_t max) {
+    return expand_word_mode(src, len, out, max, EXPAND_WORD);
+}
+
+/** @brief Caractères qui terminent un mot et commencent un opérateur. */
+static int is_operator_char(char c) {
+    return c == '|' || c == '&' || c == ';' || c == '<' || c == '>';
+}
+
+/** @brief Analyse lexicale en une passe. */
+int lex_command_line(arena_t* arena, char* line, token_t** tokens) {
+    char* p = line;
+    const char* end = line + strlen(line); // Borne des recherches de fin de $(...) (le retrait des guillemets ne déplace pas le '\0')
+    size_t count = 0;
+    size_t max = 0;
+
+    *tokens = NULL;
+    while (1) {
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') break;
+        if (*p == '#') break; // Commentaire jusqu'à la fin de la ligne (ex: #!/bin/minishell en tête de script)
+
+        // Le tableau est la dernière allocation de l'arène : il grandit en général sur place
+        if (count == max) {
+            size_t new_max = max ? max * 2 : 16;
+            token_t* new_tokens = arena_realloc(arena, *tokens, max * sizeof(token_t), new_max * sizeof(token_t));
+            if (!new_tokens) {
+                fprintf(stderr, "Erreur: mémoire insuffisante\n");
                 return -1;
             }
-            current_proc->argv[argv_index++] = home;
-            current_proc->argv[argv_index] = NULL;
-        }
-        // Cas : & ou &&
-        else if (strcmp(token, "&") == 0) {
-            is_operator = 1;
-            if (next_token && strcmp(next_token, "&") == 0) {
-                // C'est un AND (&&)
-                token_index++; // On consomme le 2ème &
-                if (cmdl->tokens[token_index + 1]) {
-                    current_proc = add_processus(cmdl, ON_SUCCESS);
-                    argv_index = 0;
+            *tokens = new_tokens;
+            max = new_max;
+        }
+        token_t* tok = &(*tokens)[count++];
+        tok->start = p;
+        tok->flags = 0;
+
+        // --- Opérateurs --- //
+        if (*p == '|') {
+            tok->kind = (p[1] == '|') ? TOK_OR : TOK_PIPE;
+            // Capacité du tube : |{TAILLE}, lue par build_plan()
+            if (p[1] == '{') {
+                char* close = p + 2;
+                while (*close && *close != '}' && !isspace((unsigned char)*close)) close++;
+                if (*close != '}') { fprintf(stderr, "Erreur syntaxe : { non fermé après |\n"); return -1; }
+                tok->len = close + 1 - p;
+                p = close + 1;
+                continue;
+            }
+        }
+        else if (*p == '&') {
+            tok->kind = (p[1] == '&') ? TOK_AND : TOK_BACKGROUND;
+        }
+        else if (*p == ';') {
+            tok->kind = TOK_SEMICOLON;
+        }
+        else if (*p == '<') {
+            if (p[1] != '<') tok->kind = TOK_IN;
+            else if (p[2] == '<') tok->kind = TOK_HERESTRING;
+            else if (p[2] == '-') tok->kind = TOK_HEREDOC_TAB;
+            else tok->kind = TOK_HEREDOC;
+        }
+        else if (*p == '>') {
+            if (p[1] == '>') tok->kind = TOK_APPEND;
+            else if (p[1] == '&' && p[2] == '2') tok->kind = TOK_OUT_TO_ERR;
+            else tok->kind = TOK_OUT;
+        }
+        else if (*p == '2' && p[1] == '>') {
+            if (p[2] == '&' && p[3] == '1') tok->kind = TOK_ERR_TO_OUT;
+            else if (p[2] == '>') tok->kind = TOK_ERR_APPEND;
+            else tok->kind = TOK_ERR;
+        }
+        else if (*p == '!' && (p[1] == '\0' || isspace((unsigned char)p[1]))) {
+            tok->kind = TOK_BANG;
+        }
+        // --- Mots --- //
+        else {
+            int quoted = 0;
+            int glob = 0;
+            int split = 0;
+            int expand = (*p == '~');
+
+            tok->kind = TOK_WORD;
+            while (*p && !isspace((unsigned char)*p) && !is_operator_char(*p)) {
+                if (*p == '\'') {
+                    char* close = strchr(p + 1, '\'');
+                    if (!close) { fprintf(stderr, "Erreur syntaxe : ' non fermé\n"); return -1; }
+                    quoted = 1;
+                    p = close + 1;
                 }
-            } else {
-                // C'est un Background (&)
-                current_proc->is_background = 1;
-                // Si une commande suit immédiatement sans séparateur (ex: ls & ls), c'est implicitement un ;
-                if (next_token && strcmp(next_token, ";") != 0 && strcmp(next_token, "|") != 0) {
-                     // On laisse la boucle traiter, le prochain token sera une nouvelle commande
-                     // Mais add_processus n'a pas été appelé. 
-                     // Pour simplifier, on assume que & termine la commande courante.
-                     if (cmdl->tokens[token_index + 1]) {
-                        current_proc = add_processus(cmdl, UNCONDITIONAL);
-                        argv_index = 0;
-                     }
+                else if (*p == '"') {
+                    quoted = 1;
+                    p++;
+                    while (*p && *p != '"') {
+                        if (*p == '\\' && p[1]) p++;
+                        else if (*p == '$') {
+                            expand = 1;
+                            if (is_subst(p, end) && !(p = (char*)subst_close(p, end))) {
+                                fprintf(stderr, "Erreur syntaxe : $( non fermé\n");
+                                return -1;
+                            }
+                        }
+                        p++;
+                    }
+                    if (!*p) { fprintf(stderr, "Erreur syntaxe : \" non fermé\n"); return -1; }
+                    p++;
                 }
+                else if (*p == '\\' && p[1]) {
+                    quoted = 1;
+                    p += 2;
+                }
+                else if (is_subst(p, end)) {
+                    // Substitution de commande : blancs et opérateurs compris jusqu'à la parenthèse fermante
+                    char* close = (char*)subst_close(p, end);
+                    if (!close) { fprintf(stderr, "Erreur syntaxe : $( non fermé\n"); return -1; }
+                    expand = 1;
+                    split = 1;
+                    p = close + 1;
+                }
+                else {
+                    if (*p == '$') {
+                        expand = 1;
+                        if (p[1] == '?' || p[1] == '*') p++; // $? et $* ne sont pas des jokers
+                    }
+                    else if (*p == '*' || *p == '?' || *p == '[') glob = 1;
+                    p++;
+                }
+            }
+
+            tok->len = p - tok->start;
+            if (quoted) tok->flags |= TOK_F_QUOTED;
+            if (glob) tok->flags |= TOK_F_GLOB;
+            if (split) tok->flags |= TOK_F_SPLIT;
+            if (expand || (glob && quoted)) {
+                // Avec des jokers, les guillemets sont gardés : ils distinguent les caractères littéraux du motif
+                tok->flags |= TOK_F_EXPAND;
+            } else if (quoted) {
+                // Retrait des guillemets sur place : le mot ne peut que raccourcir
+                tok->len = expand_word(tok->start, tok->len, tok->start, tok->len);
             }
+            continue;
         }
 
-        // --- Redirections --- //
-        
-        // Entrée standard (< input)
-        else if (strcmp(token, "<") == 0) {
-            is_operator = 1;
-            token_index++; // On passe le <
-            if (!cmdl->tokens[token_index]) { fprintf(stderr, "Erreur syntaxe <\n"); return -1; }
-            
-            int fd = open(cmdl->tokens[token_index], O_RDONLY);
-            if (fd < 0) {
-                perror("open input");
-                // On peut marquer une erreur de statut sans crasher tout le shell
-                current_proc->status = 1; 
-            } else {
-                current_proc->stdin_fd = fd;
-                add_fd(cmdl, fd);
+        // Longueur des opérateurs
+        switch (tok->kind) {
+            case TOK_OR: case TOK_AND: case TOK_APPEND: case TOK_ERR: case TOK_HEREDOC: tok->len = 2; break;
+            case TOK_OUT_TO_ERR: case TOK_ERR_APPEND: case TOK_HEREDOC_TAB: case TOK_HERESTRING: tok->len = 3; break;
+            case TOK_ERR_TO_OUT: tok->len = 4; break;
+            default: tok->len = 1; break;
+        }
+        p += tok->len;
+    }
+
+    return (int)count;
+}
+
+/** @brief Texte des opérateurs, indexé par token_kind_t (messages d'erreur). */
+static const char* token_names[] = {
+    "mot", "|", "||", "&&", "&", ";", "<", ">", ">>", "2>", "2>>", "2>&1", ">&2", "!", "<<", "<<-", "<<<"
+};
+
+/** @brief Texte d'un mot du plan instancié, terminé par '\0'.
+ * @details Les mots sans expansion sont utilisés directement dans la copie du texte du plan ; les autres sont expansés dans l'arène de la ligne.
+ * @return char* Texte du mot, NULL en cas d'échec d'allocation.
+ */
+static char* word_text(command_line_t* cmdl, char* text, const plan_word_t* word) {
+    char* src = text + word->offset;
+    if (!(word->flags & TOK_F_EXPAND)) return src;
+
+    // Taille du résultat inconnue à l'avance : on double la zone tant que l'expansion déborde
+    size_t size = word->len + 64;
+    while (1) {
+        char* out = arena_alloc(&cmdl->arena, size);
+        if (!out) break;
+        int n = expand_word(src, word->len, out, size - 1);
+        if (n >= 0) {
+            out[n] = '\0';
+            return arena_realloc(&cmdl->arena, out, size, n + 1); // Rend l'excédent à l'arène
+        }
+        size *= 2;
+    }
+    fprintf(stderr, "Erreur: mémoire insuffisante\n");
+    return NULL;
+}
+
+/** @brief Ajout aux arguments des chemins qui correspondent à un mot contenant des jokers.
+ * @return int Nombre de chemins ajoutés (0 : aucun, le mot reste un argument tel quel), -1 en cas d'échec d'allocation.
+ */
+static int add_glob_matches(command_line_t* cmdl, processus_t* proc, char* text, const plan_word_t* word) {
+    char* src = text + word->offset;
+
+    // Motif : guillemets retirés, caractères protégés par '\\' sauf les jokers écrits hors guillemets
+    size_t size = 2 * word->len + 64;
+    char* pattern;
+    while (1) {
+        pattern = arena_alloc(&cmdl->arena, size);
+        if (!pattern) return -1;
+        int n = expand_word_mode(src, word->len, pattern, size - 1, EXPAND_PATTERN);
+        if (n >= 0) {
+            pattern[n] = '\0';
+            break;
+        }
+        size *= 2;
+    }
+    if (!wildcard_has_magic(pattern)) return 0;
+
+    char** matches;
+    int count = wildcard_expand(pattern, &cmdl->arena, &matches);
+    for (int i = 0; i < count; i++) {
+        if (add_argument(cmdl, proc, matches[i]) != 0) return -1;
+    }
+    return count;
+}
+
+/** @brief Ajout aux arguments des mots issus d'un mot qui contient une substitution $(...) hors guillemets.
+ * @details La sortie de la substitution est découpée aux blancs ; un mot vide après découpage ne donne aucun argument
+ *    (ex: *$(true)*).
+ * @return int 0 en cas de succès, -1 en cas d'échec d'allocation.
+ */
+static int add_fields(command_line_t* cmdl, processus_t* proc, char* text, const plan_word_t* word) {
+    char* src = text + word->offset;
+    size_t size = word->len + 64;
+    while (1) {
+        char* out = arena_alloc(&cmdl->arena, size);
+        if (!out) return -1;
+        int n = expand_word_mode(src, word->len, out, size - 1, EXPAND_FIELDS);
+        if (n >= 0) {
+            out[n] = '\0';
+            for (char* field = out; field < out + n; field += strlen(field) + 1) {
+                if (*field != '\0' && add_argument(cmdl, proc, field) != 0) return -1;
             }
+            return 0;
         }
+        size *= 2;
+    }
+}
 
-        // Gestion >&2 (stdout vers stderr)
-        if (next_token && strcmp(next_token, "&") == 0 &&
-            next_next_token && strcmp(next_next_token, "2") == 0) {
-            
-            current_proc->stdout_fd = STDERR_FILENO;
-            
-            token_index += 2; // on consomme > & 2
-            is_operator = 1;
-        }
-        // Sorties standards (> ou >>)
-        else if (strcmp(token, ">") == 0) {
-            is_operator = 1;
-        
-            // ===== Gestion >&2 (stdout -> stderr) =====
-            if (next_token && strcmp(next_token, "&") == 0 &&
-                next_next_token && strcmp(next_next_token, "2") == 0) {
-                
-                current_proc->stdout_fd = STDERR_FILENO;
-                
-                token_index += 2; // on consomme & et 2 (le > est déjà consommé)
+/** @brief Remplacement d'un descripteur d'IO d'un processus.
+ * @details L'ancien descripteur, s'il appartient à la ligne de commande (> 2), est fermé immédiatement :
+ *    c'est le cas du tube dans *a < f | b* ou d'une première redirection dans *a > f1 > f2*.
+ */
+static void set_io(command_line_t* cmdl, int* field, int fd) {
+    if (*field > STDERR_FILENO) remove_fd(cmdl, *field);
+    *field = fd;
+    if (fd > STDERR_FILENO) add_fd(cmdl, fd);
+}
+
+/** @brief Ajout du texte d'un token au texte du plan en construction. */
+static void plan_add_word(plan_word_t* word, char* text, uint32_t* text_size, const token_t* tok) {
+    word->offset = *text_size;
+    word->len = tok->len;
+    word->flags = tok->flags;
+    memcpy(text + *text_size, tok->start, tok->len);
+    text[*text_size + tok->len] = '\0';
+    *text_size += tok->len + 1;
+}
+
+/** @brief Vérification si un token est une affectation *NOM=valeur* (nom : lettres, chiffres et '_', sans chiffre en tête). */
+static int is_assignment(const token_t* tok) {
+    const char* p = tok->start;
+    const char* end = tok->start + tok->len;
+    if (p == end || !(isalpha((unsigned char)*p) || *p == '_')) return 0;
+    while (p < end && (isalnum((unsigned char)*p) || *p == '_')) p++;
+    return p < end && *p == '=';
+}
+
+/// Profondeur maximale des alias imbriqués (alias dont la valeur commence par un autre alias)
+#define ALIAS_MAX_DEPTH 16
+
+/** @brief Tokens de la ligne après remplacement des alias, en construction. */
+typedef struct {
+    token_t* data;  ///< Tokens (alloués dans l'arène de la ligne)
+    size_t len;     ///< Nombre de tokens
+    size_t max;     ///< Taille allouée
+    int cmd_pos;    ///< Le prochain mot est en position de nom de commande
+    int target;     ///< Le prochain mot est le fichier d'une redirection
+    int depth;      ///< Nombre d'alias en cours de remplacement
+    const alias_t* active[ALIAS_MAX_DEPTH]; ///< Alias en cours de remplacement (jamais remplacés de nouveau)
+} alias_splice_t;
+
+/** @brief Copie de *n* tokens, les mots en position de nom de commande étant remplacés par les tokens de leur alias. */
+static int splice_aliases(arena_t* arena, alias_splice_t* s, const token_t* toks, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const token_t* tok = &toks[i];
+
+        if (tok->kind == TOK_WORD && s->cmd_pos && !s->target && !(tok->flags & (TOK_F_EXPAND | TOK_F_QUOTED)) &&
+            s->depth < ALIAS_MAX_DEPTH) {
+            const alias_t* alias = alias_find(tok->start, tok->len);
+            for (int d = 0; alias != NULL && d < s->depth; d++) {
+                if (s->active[d] == alias) alias = NULL;
             }
-            else {
-                int flags = O_WRONLY | O_CREAT | O_TRUNC; // Mode >
-            
-                // Vérification >> (separate_s a séparé >> en > >)
-                if (next_token && strcmp(next_token, ">") == 0) {
-                    flags = O_WRONLY | O_CREAT | O_APPEND; // Mode >>
-                    token_index++; // On consomme le 2ème >
+            if (alias != NULL) {
+                s->active[s->depth++] = alias;
+                int ret = splice_aliases(arena, s, alias->tokens, alias->num_tokens);
+                s->depth--;
+                if (ret != 0) return -1;
+                // Valeur terminée par un blanc : le mot suivant est lui aussi candidat (ex: alias s='sudo ')
+                if (alias->blank) s->cmd_pos = 1;
+                continue;
+            }
+        }
+
+        if (s->len == s->max) {
+            size_t new_max = s->max * 2;
+            token_t* data = arena_realloc(arena, s->data, s->max * sizeof(token_t), new_max * sizeof(token_t));
+            if (!data) return -1;
+            s->data = data;
+            s->max = new_max;
+        }
+        s->data[s->len++] = *tok;
+
+        // Position du mot suivant : après un séparateur, une affectation ou time, c'est encore un nom de commande
+        switch (tok->kind) {
+            case TOK_WORD:
+                if (s->target) s->target = 0;
+                else s->cmd_pos = s->cmd_pos && (is_assignment(tok) || (tok->len == 4 && memcmp(tok->start, "time", 4) == 0));
+                break;
+            case TOK_IN: case TOK_OUT: case TOK_APPEND: case TOK_ERR: case TOK_ERR_APPEND:
+            case TOK_HEREDOC: case TOK_HEREDOC_TAB: case TOK_HERESTRING:
+                s->target = 1;
+                break;
+            case TOK_ERR_TO_OUT: case TOK_OUT_TO_ERR: case TOK_BANG:
+                break;
+            default:
+                s->cmd_pos = 1;
+                break;
+        }
+    }
+    return 0;
+}
+
+/** @brief Remplacement des alias dans les tokens de la ligne (*cmdl->tokens* est remplacé par un nouveau tableau). */
+static int expand_aliases(command_line_t* cmdl) {
+    alias_splice_t s = {.max = cmdl->num_tokens + 16, .cmd_pos = 1};
+    s.data = arena_alloc(&cmdl->arena, s.max * sizeof(token_t));
+    if (!s.data || splice_aliases(&cmdl->arena, &s, cmdl->tokens, cmdl->num_tokens) != 0) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return -1;
+    }
+    cmdl->tokens = s.data;
+    cmdl->num_tokens = s.len;
+    return 0;
+}
+
+/** @brief Construction du plan d'exécution. */
+int build_plan(command_line_t* cmdl, command_plan_t** plan) {
+    unsigned num_tokens = cmdl->num_tokens;
+
+    // Tableaux de travail dimensionnés au pire cas (un élément par token), compactés à la fin
+    size_t text_max = 1;
+    for (unsigned i = 0; i < num_tokens; i++) text_max += cmdl->tokens[i].len + 1;
+    plan_command_t* commands = arena_alloc(&cmdl->arena, (num_tokens + 1) * sizeof(plan_command_t));
+    plan_word_t* words = arena_alloc(&cmdl->arena, (num_tokens + 1) * sizeof(plan_word_t));
+    plan_redir_t* redirs = arena_alloc(&cmdl->arena, (num_tokens + 1) * sizeof(plan_redir_t));
+    char* text = arena_alloc(&cmdl->arena, text_max);
+    if (!commands || !words || !redirs || !text) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return -1;
+    }
+
+    uint32_t num_commands = 0, num_words = 0, num_redirs = 0, text_size = 0;
+    plan_command_t* current = NULL;
+    control_flow_mode_t mode = UNCONDITIONAL; // Mode de chaînage de la prochaine commande
+    size_t pipe_size = 0;                     // Capacité du tube vers la prochaine commande (|{TAILLE})
+    int empty = 1;      // La commande courante n'a encore ni mot ni redirection
+
+    for (unsigned i = 0; i < num_tokens; i++) {
+        token_t* tok = &cmdl->tokens[i];
+        int is_separator = (tok->kind == TOK_SEMICOLON || tok->kind == TOK_BACKGROUND ||
+                            tok->kind == TOK_PIPE || tok->kind == TOK_AND || tok->kind == TOK_OR);
+
+        if (is_separator && (current == NULL || empty)) {
+            fprintf(stderr, "Erreur syntaxe près de '%s'\n", token_names[tok->kind]);
+            return -1;
+        }
+
+        // Début d'une nouvelle commande
+        if (current == NULL) {
+            current = &commands[num_commands++];
+            memset(current, 0, sizeof(*current));
+            current->mode = mode;
+            current->pipe_size = (uint32_t)pipe_size;
+            current->first_word = num_words;
+            current->first_redir = num_redirs;
+            empty = 1;
+            // Les commandes chaînées par &&, || ou | appartiennent à la liste chronométrée de la précédente
+            if (mode != UNCONDITIONAL && num_commands > 1 && commands[num_commands - 2].timed) current->timed = TIMED_NEXT;
+        }
+
+        switch (tok->kind) {
+
+            // --- Opérateurs de Contrôle de flux --- //
+
+            case TOK_BACKGROUND:
+                // & termine la commande comme ;
+                current->background = 1;
+                // fallthrough
+            case TOK_SEMICOLON:
+                current = NULL;
+                mode = UNCONDITIONAL;
+                break;
+
+            case TOK_AND:
+                current = NULL;
+                mode = ON_SUCCESS;
+                break;
+
+            case TOK_OR:
+                current = NULL;
+                mode = ON_FAILURE;
+                break;
+
+            case TOK_PIPE:
+                // Le tube est créé à l'instanciation
+                pipe_size = 0;
+                if (tok->len > 1 && pipe_parse_size(tok->start + 2, tok->len - 3, &pipe_size) != 0) {
+                    fprintf(stderr, "Erreur syntaxe : taille de tube invalide '%.*s'\n", (int)tok->len, tok->start);
+                    return -1;
                 }
-            
-                token_index++; // On passe au nom du fichier
-                if (!cmdl->tokens[token_index]) {
-                    fprintf(stderr, "Erreur syntaxe >\n");
+                current = NULL;
+                mode = PIPE;
+                break;
+
+            // --- Redirections --- //
+
+            case TOK_IN:
+            case TOK_OUT:
+            case TOK_APPEND:
+            case TOK_ERR:
+            case TOK_ERR_APPEND:
+            case TOK_HEREDOC:
+            case TOK_HEREDOC_TAB:
+            case TOK_HERESTRING:
+                if (i + 1 >= num_tokens || cmdl->tokens[i + 1].kind != TOK_WORD) {
+                    fprintf(stderr, "Erreur syntaxe %s\n", token_names[tok->kind]);
                     return -1;
                 }
-            
-                int fd = open(cmdl->tokens[token_index], flags, 0644);
-                if (fd < 0) {
-                    perror("open output");
-                } else {
-                    current_proc->stdout_fd = fd;
-                    add_fd(cmdl, fd);
+                redirs[num_redirs].kind = tok->kind;
+                plan_add_word(&redirs[num_redirs].target, text, &text_size, &cmdl->tokens[++i]);
+                num_redirs++;
+                current->num_redirs++;
+                empty = 0;
+                break;
+
+            case TOK_ERR_TO_OUT:
+            case TOK_OUT_TO_ERR:
+                memset(&redirs[num_redirs], 0, sizeof(plan_redir_t));
+                redirs[num_redirs++].kind = tok->kind;
+                current->num_redirs++;
+                empty = 0;
+                break;
+
+            // --- Modificateurs --- //
+
+            case TOK_BANG:
+                // Uniquement si c'est au début de la commande, sinon c'est un argument
+                if (current->num_words == 0 && current->num_assigns == 0) {
+                    current->invert = 1;
+                    break;
                 }
-            }
+                tok->kind = TOK_WORD;
+                // fallthrough
+            case TOK_WORD:
+                // Mot-clé time en tête d'une liste (ni guillemets ni '!' avant lui) : chronométrage jusqu'au prochain ';' ou '&'
+                if (current->num_words == 0 && current->num_assigns == 0 && current->num_redirs == 0 && current->mode == UNCONDITIONAL &&
+                    !current->invert && !current->timed && tok->len == 4 && memcmp(tok->start, "time", 4) == 0) {
+                    current->timed = TIMED_START;
+                    break;
+                }
+                // Affectations avant le nom de la commande : rangées avant ses arguments
+                if (current->num_words == 0 && is_assignment(tok)) {
+                    plan_add_word(&words[num_words++], text, &text_size, tok);
+                    current->num_assigns++;
+                    empty = 0;
+                    break;
+                }
+                plan_add_word(&words[num_words++], text, &text_size, tok);
+                current->num_words++;
+                empty = 0;
+                break;
         }
+    }
+
+    // Un tube, && ou || ne peut pas terminer la ligne
+    if (current == NULL && (mode == PIPE || mode == ON_SUCCESS || mode == ON_FAILURE)) {
+        fprintf(stderr, "Erreur syntaxe : commande manquante en fin de ligne\n");
+        return -1;
+    }
+
+    // Assemblage du bloc : en-tête, commandes, mots, redirections, texte
+    size_t size = sizeof(command_plan_t) + num_commands * sizeof(plan_command_t) +
+                  num_words * sizeof(plan_word_t) + num_redirs * sizeof(plan_redir_t) + text_size;
+    command_plan_t* p = arena_alloc(&cmdl->arena, size);
+    if (!p) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return -1;
+    }
+    p->size = size;
+    p->num_commands = num_commands;
+    p->num_words = num_words;
+    p->num_redirs = num_redirs;
+    p->text_size = text_size;
+    memcpy(PLAN_COMMANDS(p), commands, num_commands * sizeof(plan_command_t));
+    memcpy(PLAN_WORDS(p), words, num_words * sizeof(plan_word_t));
+    memcpy(PLAN_REDIRS(p), redirs, num_redirs * sizeof(plan_redir_t));
+    memcpy(PLAN_TEXT(p), text, text_size);
 
-        // Sortie erreur (2> ou 2>>)
-        // Note: separate_s a séparé "2>" en "2" ">". 
-        // On détecte donc: Token="2", Next=">"
-        else if (strcmp(token, "2") == 0 && next_token && strcmp(next_token, ">") == 0) {
-            is_operator = 1;
-            token_index++; // On est sur >
-            
-            int flags = O_WRONLY | O_CREAT | O_TRUNC;
-            // Check >>
-            if (cmdl->tokens[token_index + 1] && strcmp(cmdl->tokens[token_index + 1], ">") == 0) {
-                flags = O_WRONLY | O_CREAT | O_APPEND;
-                token_index++; // On est sur le 2ème >
+    *plan = p;
+    return 0;
+}
+
+/** @brief Ajout d'une ligne au corps d'un document en ligne, suivie d'un saut de ligne.
+ * @details Avec *expand*, les variables et les substitutions $(...) sont remplacées par leur valeur et '\\' protège '$', '`' et '\\' ; les guillemets
+ *    restent des caractères ordinaires. Sans *expand* (délimiteur entre guillemets), la ligne est copiée telle quelle.
+ * @return int 0 en cas de succès, -1 en cas de dépassement de taille.
+ */
+static int heredoc_line(expand_buf_t* b, const char* line, size_t len, int expand) {
+    if (!expand) return (buf_put(b, line, len) == 0 && buf_put(b, "\n", 1) == 0) ? 0 : -1;
+
+    for (size_t i = 0; i < len; ) {
+        if (line[i] == '\\' && i + 1 < len && memchr("$`\\", line[i + 1], 3)) {
+            if (buf_put(b, line + i + 1, 1) != 0) return -1;
+            i += 2;
+        } else if (line[i] == '$') {
+            int n = is_subst(line + i, line + len) ? expand_subst(line + i, line + len, b, 0)
+                                                   : expand_dollar(line + i, line + len, b);
+            if (n < 0) return -1;
+            i += n;
+        } else {
+            if (buf_put(b, line + i, 1) != 0) return -1;
+            i++;
+        }
+    }
+    return buf_put(b, "\n", 1);
+}
+
+/** @brief Lecture du corps d'un document en ligne (<< ou <<-) sur la source de la ligne, jusqu'au délimiteur.
+ * @details Les lignes sont gardées telles quelles (sauf les tabulations de tête de <<-) : leur expansion n'a lieu qu'au lancement
+ *    de la commande (voir open_heredoc()).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message sur stderr, *body->data* reste NULL).
+ */
+static int read_heredoc(command_line_t* cmdl, char* text, const plan_redir_t* redir, here_body_t* body) {
+    char* delim = word_text(cmdl, text, &redir->target);
+    if (!delim) return -1;
+    if (cmdl->input == NULL) {
+        fprintf(stderr, "Erreur: document en ligne sans source de lignes\n");
+        return -1;
+    }
+    size_t delim_len = strlen(delim);
+
+    expand_buf_t raw = {malloc(4096), 0, 4096};
+    if (!raw.data) return -1;
+    while (1) {
+        if (shell_interactive) {
+            printf("> ");
+            fflush(stdout);
+        }
+        size_t len;
+        const char* line = input_read_line(cmdl->input, &len);
+        if (line == NULL) {
+            fprintf(stderr, "Avertissement : fin de l'entrée avant le délimiteur '%s' du document en ligne\n", delim);
+            break;
+        }
+        if (redir->kind == TOK_HEREDOC_TAB) {
+            while (len > 0 && *line == '\t') {
+                line++;
+                len--;
             }
-            
-            token_index++; // Fichier
-            if (!cmdl->tokens[token_index]) return -1;
-
-            // Gestion 2>&1
-            if (strcmp(cmdl->tokens[token_index], "&") == 0 && 
-                cmdl->tokens[token_index + 1] && 
-                strcmp(cmdl->tokens[token_index + 1], "1") == 0) {
-                    // current_proc->stderr_fd = current_proc->stdout_fd;
-                    current_proc->stderr_fd = -1;
-                    token_index++; // Passe &
-                    token_index++; // Passe 1 (sera incrémenté par la boucle)
-                    token_index--; // Ajustement car la boucle fait ++
-            } else {
-                int fd = open(cmdl->tokens[token_index], flags, 0644);
-                if (fd >= 0) {
-                    current_proc->stderr_fd = fd;
-                    add_fd(cmdl, fd);
-                } else {
-                    perror("open stderr");
-                }
+        }
+        if (len == delim_len && memcmp(line, delim, len) == 0) break;
+
+        // Dépassement : le corps est agrandi
+        if (raw.len + len + 1 > raw.max) {
+            size_t max = raw.max * 2;
+            while (max < raw.len + len + 1) max *= 2;
+            char* data = realloc(raw.data, max);
+            if (!data) {
+                free(raw.data);
+                fprintf(stderr, "Erreur: mémoire insuffisante\n");
+                return -1;
             }
+            raw.data = data;
+            raw.max = max;
         }
+        heredoc_line(&raw, line, len, 0);
+    }
+
+    // Copie dans l'arène : le corps vit aussi longtemps que le plan de la ligne
+    body->data = arena_strndup(&cmdl->arena, raw.data, raw.len);
+    body->len = raw.len;
+    free(raw.data);
+    if (!body->data) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return -1;
+    }
+    return 0;
+}
 
-        // --- Modificateurs --- //
-        
-        // Inversion !
-        else if (strcmp(token, "!") == 0) {
-            // Uniquement si c'est au début de la commande
-            if (argv_index == 0) {
-                current_proc->invert = 1;
-                is_operator = 1;
+/** @brief Ouverture en lecture du corps d'un document en ligne, après expansion de ses lignes si *expand*.
+ * @return int Descripteur en lecture sur le corps (voir pipe_open_data()), -1 en cas d'erreur.
+ */
+static int open_heredoc(const here_body_t* body, int expand) {
+    if (!expand) return pipe_open_data(body->data, body->len);
+
+    // Taille du résultat inconnue à l'avance : le corps est expansé de nouveau dans une zone double tant qu'il déborde
+    // (les substitutions déjà exécutées ne sont pas relancées, voir subst.h)
+    const char* end = body->data + body->len;
+    size_t size = body->len + 4096;
+    while (1) {
+        expand_buf_t b = {malloc(size), 0, size};
+        if (!b.data) return -1;
+        const char* line = body->data;
+        while (line < end) {
+            const char* nl = memchr(line, '\n', end - line);
+            if (heredoc_line(&b, line, nl - line, 1) != 0) break;
+            line = nl + 1;
+        }
+        if (line == end) {
+            int fd = pipe_open_data(b.data, b.len);
+            free(b.data);
+            return fd;
+        }
+        free(b.data);
+        size *= 2;
+    }
+}
+
+/** @brief Application d'une redirection du plan à un processus.
+ * @param body Corps déjà lu pour << et <<- (NULL si sa lecture a échoué), ignoré sinon.
+ * @return int 0 en cas de succès (y compris si le fichier ne peut pas être ouvert), -1 en cas d'échec d'allocation.
+ */
+static int apply_redir(command_line_t* cmdl, processus_t* proc, char* text, const plan_redir_t* redir, const here_body_t* body) {
+    if (redir->kind == TOK_HEREDOC || redir->kind == TOK_HEREDOC_TAB) {
+        // Expansion du corps seulement si le délimiteur n'a aucun guillemet
+        int fd = (body && body->data) ? open_heredoc(body, !(redir->target.flags & TOK_F_QUOTED)) : -1;
+        if (fd < 0) {
+            if (body && body->data) perror("heredoc");
+            proc->status = 1;
+        } else {
+            set_io(cmdl, &proc->stdin_fd, fd);
+            proc->stdin_pipe = 0;
+        }
+        return 0;
+    }
+    if (redir->kind == TOK_ERR_TO_OUT) {
+        // stderr suivra stdout dans le fils (voir launch_processus)
+        set_io(cmdl, &proc->stderr_fd, -1);
+        return 0;
+    }
+    if (redir->kind == TOK_OUT_TO_ERR) {
+        set_io(cmdl, &proc->stdout_fd, STDERR_FILENO);
+        return 0;
+    }
+
+    char* file = word_text(cmdl, text, &redir->target);
+    if (!file) return -1;
+
+    if (redir->kind == TOK_HERESTRING) {
+        // Mot suivi d'un saut de ligne
+        size_t len = strlen(file);
+        char* data = arena_alloc(&cmdl->arena, len + 1);
+        if (!data) return -1;
+        memcpy(data, file, len);
+        data[len] = '\n';
+        int fd = pipe_open_data(data, len + 1);
+        if (fd < 0) {
+            perror("herestring");
+            proc->status = 1;
+        } else {
+            set_io(cmdl, &proc->stdin_fd, fd);
+            proc->stdin_pipe = 0;
+        }
+        return 0;
+    }
+
+    uint64_t start = TRACE_ENABLED() ? trace_now() : 0;
+    if (redir->kind == TOK_IN) {
+        int fd = open(file, O_RDONLY | O_CLOEXEC);
+        if (TRACE_ENABLED()) trace_event(TRACE_OPEN, proc->cf->index, 0, start, trace_now(), fd);
+        if (fd < 0) {
+            perror("open input");
+            // On peut marquer une erreur de statut sans crasher tout le shell
+            proc->status = 1;
+        } else {
+            set_io(cmdl, &proc->stdin_fd, fd);
+            proc->stdin_pipe = 0;
+        }
+        return 0;
+    }
+
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    flags |= (redir->kind == TOK_APPEND || redir->kind == TOK_ERR_APPEND) ? O_APPEND : O_TRUNC;
+    int fd = open(file, flags, 0644);
+    if (TRACE_ENABLED()) trace_event(TRACE_OPEN, proc->cf->index, 0, start, trace_now(), fd);
+    if (fd < 0) {
+        perror((redir->kind == TOK_OUT || redir->kind == TOK_APPEND) ? "open output" : "open stderr");
+    } else if (redir->kind == TOK_OUT || redir->kind == TOK_APPEND) {
+        set_io(cmdl, &proc->stdout_fd, fd);
+    } else {
+        set_io(cmdl, &proc->stderr_fd, fd);
+    }
+    return 0;
+}
+
+/** @brief Instanciation d'un plan d'exécution. */
+int instantiate_plan(command_line_t* cmdl, const command_plan_t* plan) {
+    // Copie du plan dans l'arène : les arguments pointent dans son texte
+    command_plan_t* copy = arena_alloc(&cmdl->arena, plan->size);
+    if (!copy) {
+        fprintf(stderr, "Erreur: mémoire insuffisante\n");
+        return -1;
+    }
+    memcpy(copy, plan, plan->size);
+    cmdl->plan = copy;
+
+    plan_command_t* commands = PLAN_COMMANDS(copy);
+    plan_redir_t* redirs = PLAN_REDIRS(copy);
+    char* text = PLAN_TEXT(copy);
+
+    // Corps des documents en ligne, lus avant tout le reste : leurs lignes ne sont jamais exécutées comme des commandes,
+    // même si la ligne s'arrête avant la commande qui les lit
+    for (uint32_t r = 0; r < copy->num_redirs; r++) {
+        if (redirs[r].kind != TOK_HEREDOC && redirs[r].kind != TOK_HEREDOC_TAB) continue;
+        if (!cmdl->here_bodies) {
+            cmdl->here_bodies = arena_alloc(&cmdl->arena, copy->num_redirs * sizeof(here_body_t));
+            if (!cmdl->here_bodies) {
+                fprintf(stderr, "Erreur: mémoire insuffisante\n");
+                return -1;
             }
+            memset(cmdl->here_bodies, 0, copy->num_redirs * sizeof(here_body_t));
         }
+        read_heredoc(cmdl, text, &redirs[r], &cmdl->here_bodies[r]);
+    }
 
-        
-        if (!is_operator) {
-            if (argv_index < MAX_ARGS - 1) {
-                if (argv_index == 0) {
-                    current_proc->path = token;
-                }
-                current_proc->argv[argv_index++] = token; 
-                current_proc->argv[argv_index] = NULL;
-            } else {
-                fprintf(stderr, "Erreur: trop d'arguments (max %d)\n", MAX_ARGS);
+    // Processus et contrôle de flux ; mots, tubes et redirections attendent le lancement de chaque tube
+    for (uint32_t c = 0; c < copy->num_commands; c++) {
+        processus_t* proc = add_processus(cmdl, commands[c].mode);
+        if (!proc) return -1;
+        proc->invert = commands[c].invert;
+        proc->is_background = commands[c].background;
+        proc->timed = commands[c].timed;
+    }
+    return 0;
+}
+
+/** @brief Expansion des affectations et des arguments d'une commande du plan.
+ * @return int 0 en cas de succès, -1 en cas d'échec d'allocation.
+ */
+static int expand_command(command_line_t* cmdl, processus_t* proc, const plan_command_t* command, const plan_word_t* words, char* text) {
+    // Affectations propres à la commande : liste "NOM=valeur" terminée par NULL
+    if (command->num_assigns > 0) {
+        proc->envp = arena_alloc(&cmdl->arena, (command->num_assigns + 1) * sizeof(char*));
+        if (!proc->envp) return -1;
+        for (uint32_t a = 0; a < command->num_assigns; a++) {
+            proc->envp[a] = word_text(cmdl, text, &words[command->first_word + a]);
+            if (!proc->envp[a]) return -1;
+        }
+        proc->envp[command->num_assigns] = NULL;
+    }
+
+    for (uint32_t w = 0; w < command->num_words; w++) {
+        const plan_word_t* pw = &words[command->first_word + command->num_assigns + w];
+        if (pw->flags & TOK_F_GLOB) {
+            int count = add_glob_matches(cmdl, proc, text, pw);
+            if (count < 0) {
+                fprintf(stderr, "Erreur: mémoire insuffisante\n");
+                return -1;
+            }
+            if (count > 0) continue;
+        }
+        if (pw->flags & TOK_F_SPLIT) {
+            if (add_fields(cmdl, proc, text, pw) != 0) {
+                fprintf(stderr, "Erreur: mémoire insuffisante\n");
                 return -1;
             }
+            continue;
         }
+        char* word = word_text(cmdl, text, pw);
+        if (!word || add_argument(cmdl, proc, word) != 0) return -1;
+    }
+    return 0;
+}
 
+/** @brief Instanciation d'un tube, dans la portée des substitutions ouverte par instantiate_pipeline(). */
+static int instantiate_stages(command_line_t* cmdl, control_flow_t* first) {
+    const command_plan_t* plan = cmdl->plan;
+    const plan_command_t* commands = PLAN_COMMANDS(plan);
+    const plan_word_t* words = PLAN_WORDS(plan);
+    const plan_redir_t* redirs = PLAN_REDIRS(plan);
+    char* text = PLAN_TEXT(plan);
 
-        token_index++;
+    // 1. Mots de tous les étages, avant toute ouverture : une substitution $(...) ne voit aucun tube de la ligne
+    for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+        if (expand_command(cmdl, cf->proc, &commands[cf->index], words, text) != 0) return -1;
     }
 
+    // 2. Tubes entre les étages, puis redirections, prioritaires sur les tubes
+    processus_t* prev_proc = NULL;
+    for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+        const plan_command_t* command = &commands[cf->index];
+        processus_t* proc = cf->proc;
+
+        if (prev_proc) {
+            int pfd[2];
+            uint64_t start = TRACE_ENABLED() ? trace_now() : 0;
+            // Fermés automatiquement à l'exec : seuls les descripteurs copiés sur 0, 1 et 2 restent ouverts
+            if (pipe_open(pfd, command->pipe_size ? command->pipe_size : shell_options.pipesize) == -1) {
+                perror("pipe2");
+                return -1;
+            }
+            if (TRACE_ENABLED()) {
+                trace_event_ext(TRACE_PIPE, cf->index, 0, start, trace_now(), pfd[0], fcntl(pfd[0], F_GETPIPE_SZ));
+            }
+            // Redirection sortie du précédent -> entrée du tube, sauf si la sortie est déjà redirigée
+            if (prev_proc->stdout_fd == STDOUT_FILENO) {
+                set_io(cmdl, &prev_proc->stdout_fd, pfd[1]);
+            } else {
+                close(pfd[1]);
+            }
+            set_io(cmdl, &proc->stdin_fd, pfd[0]);
+            proc->stdin_pipe = 1;
+        }
+
+        for (uint32_t r = 0; r < command->num_redirs; r++) {
+            uint32_t index = command->first_redir + r;
+            const here_body_t* body = cmdl->here_bodies ? &cmdl->here_bodies[index] : NULL;
+            if (apply_redir(cmdl, proc, text, &redirs[index], body) != 0) return -1;
+        }
+        prev_proc = proc;
+    }
     return 0;
-}
\ No newline at end of file
+}
+
+/** @brief Instanciation d'un tube de la ligne, juste avant son lancement. */
+int instantiate_pipeline(control_flow_t* first) {
+    command_line_t* cmdl = first->cmdl;
+    if (cmdl->plan == NULL) return 0;
+
+    // Sorties des substitutions $(...) copiées dans l'arène de la ligne, oubliées à la fin de l'instanciation du tube
+    subst_scope_t saved;
+    subst_enter(&saved, &cmdl->arena);
+    int ret = instantiate_stages(cmdl, first);
+    subst_leave(&saved);
+    return ret;
+}
+
+/** @brief Analyse de la ligne de commande. */
+int parse_command_line(command_line_t* cmdl, const char* line, size_t len) {
+    // 1. Copie de la ligne dans l'arène (l'analyse lexicale la modifie)
+    cmdl->command_line = arena_strndup(&cmdl->arena, line, len);
+    if (!cmdl->command_line) return -1;
+
+    // 2. Plan déjà connu : ni analyse lexicale ni analyse logique
+    uint64_t start = TRACE_ENABLED() ? trace_now() : 0;
+    const command_plan_t* plan = plancache_lookup(line, len);
+    int cache_hit = (plan != NULL);
+    if (plan == NULL) {
+        // 3. Tokenisation en une passe
+        int num_tokens = lex_command_line(&cmdl->arena, cmdl->command_line, &cmdl->tokens);
+        if (num_tokens < 0) return -1;
+        cmdl->num_tokens = num_tokens;
+
+        // 4. Remplacement des alias par leurs tokens, découpés une fois pour toutes à leur définition
+        if (alias_count() > 0 && expand_aliases(cmdl) != 0) return -1;
+
+        // 5. Analyse logique et mise en cache du plan
+        command_plan_t* new_plan;
+        if (build_plan(cmdl, &new_plan) != 0) return -1;
+        plancache_insert(line, len, new_plan);
+        plan = new_plan;
+    }
+    if (TRACE_ENABLED()) trace_event(TRACE_PARSE, -1, 0, start, trace_now(), cache_hit);
+
+    // 6. Création des processus, expansions, tubes et redirections
+    return instantiate_plan(cmdl, plan);
+}
@@ -0,0 +1,191 @@
+/** @file pathcache.c
+ * @brief Implementation of the command path cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation du cache de résolution des commandes : table de hachage à adressage ouvert
+ *    (voir hashtable.h) indexée par le nom de la commande.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "pathcache.h"
+#include "hashtable.h"
+#include "vars.h"
+
+/// Valeur de PATH utilisée si la variable n'est pas définie (comme execvp)
+#define DEFAULT_PATH "/bin:/usr/bin"
+/// Capacité initiale de la table (puissance de 2)
+#define INITIAL_CAPACITY 64
+
+/** @brief Entrée de la table : résolution d'un nom de commande. */
+typedef struct {
+    hash_entry_t entry; ///< Nom de la commande (copie propre à l'entrée), sa longueur et son haché
+    char* path;         ///< Chemin de l'exécutable, NULL si la commande est introuvable
+    unsigned int hits;  ///< Nombre de résolutions servies par cette entrée
+} path_entry_t;
+
+/** @brief Répertoire de $PATH et sa date de modification lors du dernier contrôle. */
+typedef struct {
+    const char* dir;          ///< Chemin du répertoire (pointe dans *path_copy*)
+    struct timespec mtime;    ///< Date de modification connue
+} path_dir_t;
+
+static hash_table_t table = HASH_TABLE_INIT(path_entry_t, INITIAL_CAPACITY);
+
+static char* path_copy = NULL;     // Copie de PATH découpée en répertoires
+static path_dir_t* dirs = NULL;
+static size_t num_dirs = 0;
+static int dirs_loaded = 0;
+static int has_relative = 0;       // PATH contient un répertoire relatif (ou vide = CWD)
+static struct timespec last_check; // Date du dernier contrôle des répertoires
+
+/** @brief Suppression de toutes les entrées (la capacité de la table est conservée). */
+static void clear_entries(void) {
+    for (size_t i = 0; i < table.capacity; i++) {
+        path_entry_t* e = (path_entry_t*)HASH_SLOT(&table, i);
+        if (e->entry.key == NULL) continue;
+        free((char*)e->entry.key);
+        free(e->path);
+    }
+    hash_clear(&table);
+}
+
+/** @brief Lecture de PATH et mémorisation de la date de modification de chacun de ses répertoires. */
+static void load_dirs(void) {
+    const char* path = vars_get("PATH");
+    if (path == NULL) path = DEFAULT_PATH;
+
+    free(path_copy);
+    free(dirs);
+    path_copy = strdup(path);
+    num_dirs = 1;
+    for (const char* p = path; *p; p++) {
+        if (*p == ':') num_dirs++;
+    }
+    dirs = calloc(num_dirs, sizeof(path_dir_t));
+    if (!path_copy || !dirs) {
+        num_dirs = 0;
+        return;
+    }
+
+    has_relative = 0;
+    char* cursor = path_copy;
+    for (size_t i = 0; i < num_dirs; i++) {
+        char* sep = strchr(cursor, ':');
+        if (sep) *sep = '\0';
+        // Entrée vide : répertoire courant
+        dirs[i].dir = (*cursor == '\0') ? "." : cursor;
+        if (dirs[i].dir[0] != '/') has_relative = 1;
+
+        struct stat st;
+        if (stat(dirs[i].dir, &st) == 0) dirs[i].mtime = st.st_mtim;
+        cursor = sep ? sep + 1 : cursor + strlen(cursor);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &last_check);
+    dirs_loaded = 1;
+}
+
+/** @brief Vidage du cache si un répertoire de PATH a été modifié (contrôle au plus une fois par seconde). */
+static void check_dirs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    if (now.tv_sec - last_check.tv_sec < 1) return;
+    last_check = now;
+
+    int changed = 0;
+    for (size_t i = 0; i < num_dirs; i++) {
+        struct stat st;
+        struct timespec mtime = {0, 0};
+        if (stat(dirs[i].dir, &st) == 0) mtime = st.st_mtim;
+        if (mtime.tv_sec != dirs[i].mtime.tv_sec || mtime.tv_nsec != dirs[i].mtime.tv_nsec) {
+            dirs[i].mtime = mtime;
+            changed = 1;
+        }
+    }
+    if (changed) clear_entries();
+}
+
+/** @brief Recherche de *name* dans les répertoires de PATH.
+ * @return int 1 si un exécutable a été trouvé (son chemin est écrit dans *buf*), 0 sinon.
+ */
+static int search_path(const char* name, char* buf, size_t size) {
+    for (size_t i = 0; i < num_dirs; i++) {
+        struct stat st;
+        if ((size_t)snprintf(buf, size, "%s/%s", dirs[i].dir, name) >= size) continue;
+        if (stat(buf, &st) == 0 && S_ISREG(st.st_mode) && access(buf, X_OK) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** @brief Fonction de résolution d'une commande dans les répertoires de $PATH. */
+const char* pathcache_lookup(const char* name) {
+    static char buf[PATH_MAX];
+
+    if (!name) return NULL;
+    if (strchr(name, '/') != NULL) return name;
+
+    if (!dirs_loaded) load_dirs();
+
+    // Résultat dépendant du CWD : pas de mise en cache
+    if (has_relative) {
+        return search_path(name, buf, sizeof(buf)) ? buf : NULL;
+    }
+
+    check_dirs();
+
+    size_t len = strlen(name);
+    uint32_t h = hash_name(name, len);
+    path_entry_t* e = (path_entry_t*)hash_find(&table, name, len, h);
+    if (e != NULL) {
+        e->hits++;
+        return e->path;
+    }
+
+    // Absent du cache : recherche puis insertion (y compris si introuvable)
+    int found = search_path(name, buf, sizeof(buf));
+
+    char* key = strdup(name);
+    char* path = found ? strdup(buf) : NULL;
+    e = (key && (path || !found)) ? (path_entry_t*)hash_insert(&table, name, len, h) : NULL;
+    if (e == NULL) {
+        free(key);
+        free(path);
+        return found ? buf : NULL;
+    }
+    e->entry.key = key;
+    e->path = path;
+    e->hits = 1;
+    return path;
+}
+
+/** @brief Fonction de vidage du cache. */
+void pathcache_reset(void) {
+    clear_entries();
+    dirs_loaded = 0;
+}
+
+/** @brief Fonction d'affichage du contenu du cache. */
+void pathcache_print(outbuf_t* out) {
+    if (table.count == 0) {
+        out_printf(out, "hash: table vide\n");
+        return;
+    }
+    out_printf(out, "utilisations\tcommande\n");
+    for (size_t i = 0; i < table.capacity; i++) {
+        path_entry_t* e = (path_entry_t*)HASH_SLOT(&table, i);
+        if (e->entry.key == NULL) continue;
+        if (e->path) out_printf(out, "%12u\t%s\n", e->hits, e->path);
+        else out_printf(out, "%12u\t%s (introuvable)\n", e->hits, e->entry.key);
+    }
+}
@@ -0,0 +1,176 @@
+/** @file pipes.c
+ * @brief Implementation of pipeline pipes
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la création des tubes (capacité réglable) et du processus de mesure de leur débit.
+ */
+
+#define _GNU_SOURCE // pipe2(), splice(), F_SETPIPE_SZ, close_range(), memfd_create()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "pipes.h"
+#include "trace.h"
+
+/// Nombre maximal d'octets demandés à chaque *splice()* du processus de mesure
+#define METER_CHUNK (1 << 20)
+
+/** @brief Fonction de lecture d'une taille de tube. */
+int pipe_parse_size(const char* s, size_t len, size_t* size) {
+    size_t n = 0, i = 0;
+
+    if (len == 0) return -1;
+    for (; i < len && s[i] >= '0' && s[i] <= '9'; i++) {
+        n = n * 10 + (s[i] - '0');
+        if (n > PIPE_SIZE_MAX) return -1;
+    }
+    if (i == 0) return -1;
+    if (i + 1 == len && (s[i] == 'K' || s[i] == 'k')) n <<= 10;
+    else if (i + 1 == len && (s[i] == 'M' || s[i] == 'm')) n <<= 20;
+    else if (i != len) return -1;
+    if (n > PIPE_SIZE_MAX) return -1;
+
+    *size = n;
+    return 0;
+}
+
+/** @brief Capacité maximale d'un tube pour un utilisateur non privilégié (fichier /proc/sys/fs/pipe-max-size, lu une fois). */
+static size_t pipe_max_size(void) {
+    static size_t max = 0;
+    if (max != 0) return max;
+
+    max = 1 << 20; // Valeur par défaut du noyau
+    FILE* f = fopen("/proc/sys/fs/pipe-max-size", "re");
+    if (f) {
+        unsigned long value;
+        if (fscanf(f, "%lu", &value) == 1 && value > 0) max = value;
+        fclose(f);
+    }
+    return max;
+}
+
+/** @brief Fonction de création d'un tube entre deux étages. */
+int pipe_open(int pfd[2], size_t size) {
+    if (pipe2(pfd, O_CLOEXEC) == -1) return -1;
+    if (size > 0) {
+        if (size > pipe_max_size()) size = pipe_max_size();
+        fcntl(pfd[1], F_SETPIPE_SZ, (int)size); // Échec sans conséquence : capacité par défaut
+    }
+    return 0;
+}
+
+/** @brief Écriture complète de *len* octets (reprise après une écriture partielle ou une interruption). */
+static int write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief Fonction de création d'un descripteur en lecture sur un contenu en mémoire. */
+int pipe_open_data(const char* data, size_t len) {
+    int pfd[2];
+
+    // Petit contenu : un tube, si sa capacité réelle (réduite quand le quota de pages est atteint) suffit
+    if (pipe_open(pfd, 0) == 0) {
+        int size = fcntl(pfd[1], F_GETPIPE_SZ);
+        if (size > 0 && len <= (size_t)size && write_all(pfd[1], data, len) == 0) {
+            close(pfd[1]);
+            return pfd[0];
+        }
+        close(pfd[0]);
+        close(pfd[1]);
+    }
+
+    int fd = memfd_create("minishell-heredoc", MFD_CLOEXEC);
+    if (fd < 0) return -1;
+    if (write_all(fd, data, len) != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/** @brief Boucle du processus de mesure : entrée standard vers sortie standard, jusqu'à la fin des données.
+ * @details Le temps d'attente de place dans le tube de sortie est le temps pendant lequel l'écrivain aurait été
+ *    bloqué sur un tube unique. Le processus ne quitte pas sur SIGPIPE (ignoré par le shell) : EPIPE termine la boucle.
+ */
+static void meter_loop(int flow) {
+    uint64_t start = trace_now();
+    long long bytes = 0, stall = 0;
+
+    while (1) {
+        // Attente de données ; la fermeture du tube par le lecteur (POLLERR sur la sortie) met aussi fin à la mesure
+        struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {STDOUT_FILENO, 0, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLERR) break;
+
+        ssize_t n = splice(STDIN_FILENO, NULL, STDOUT_FILENO, NULL, METER_CHUNK, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            bytes += n;
+            continue;
+        }
+        if (n == 0) break; // Fin des données
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN) break;
+
+        // Tube de sortie plein : attente du lecteur
+        uint64_t t = trace_now();
+        struct pollfd out = {STDOUT_FILENO, POLLOUT, 0};
+        while (poll(&out, 1, -1) < 0 && errno == EINTR) {}
+        stall += trace_now() - t;
+        if (out.revents & POLLERR) break;
+    }
+    trace_event_ext(TRACE_PIPESTATS, flow, getpid(), start, trace_now(), bytes, stall);
+}
+
+/** @brief Fonction de lancement du processus de mesure d'un tube. */
+pid_t pipe_meter(int* read_fd, int flow, pid_t pgid) {
+    int pfd[2];
+    int size = fcntl(*read_fd, F_GETPIPE_SZ);
+    if (pipe_open(pfd, size > 0 ? (size_t)size : 0) == -1) return -1;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pfd[0]);
+        close(pfd[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        setpgid(0, pgid);
+        signal(SIGCHLD, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGQUIT, SIG_DFL);
+        signal(SIGTSTP, SIG_DFL);
+        signal(SIGTTIN, SIG_DFL);
+        if (dup2(*read_fd, STDIN_FILENO) == -1 || dup2(pfd[1], STDOUT_FILENO) == -1) _exit(1);
+        close_range(STDERR_FILENO + 1, ~0U, 0);
+        meter_loop(flow);
+        _exit(0);
+    }
+
+    setpgid(pid, pgid ? pgid : pid);
+    close(pfd[1]);
+    *read_fd = pfd[0];
+    return pid;
+}
@@ -0,0 +1,148 @@
+/** @file plancache.c
+ * @brief Implementation of the execution plan cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation du cache des plans d'exécution : table de hachage à chaînage indexée par le texte de la ligne,
+ *    et liste doublement chaînée des entrées dans l'ordre d'utilisation (la tête est la plus récente).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "plancache.h"
+#include "options.h"
+
+/// Nombre d'alvéoles de la table (puissance de 2)
+#define NUM_BUCKETS 1024
+
+/** @brief Entrée du cache : une ligne et son plan, alloués d'un seul bloc. */
+typedef struct plan_entry {
+    struct plan_entry* newer;  ///< Entrée utilisée plus récemment (NULL en tête)
+    struct plan_entry* older;  ///< Entrée utilisée moins récemment (NULL en queue)
+    struct plan_entry* chain;  ///< Entrée suivante dans la même alvéole
+    command_plan_t* plan;      ///< Plan (dans le même bloc, après la ligne)
+    uint64_t hash;             ///< Haché de la ligne
+    size_t len;                ///< Longueur de la ligne
+    char line[];               ///< Texte de la ligne
+} plan_entry_t;
+
+static plan_entry_t* buckets[NUM_BUCKETS];
+static plan_entry_t* newest = NULL;
+static plan_entry_t* oldest = NULL;
+static size_t count = 0;
+
+static unsigned long hits = 0;
+static unsigned long misses = 0;
+static unsigned long evictions = 0;
+
+/** @brief Haché FNV-1a 64 bits d'une ligne. */
+static uint64_t hash_line(const char* s, size_t len) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/** @brief Retrait d'une entrée de la liste LRU. */
+static void unlink_lru(plan_entry_t* entry) {
+    if (entry->newer) entry->newer->older = entry->older;
+    else newest = entry->older;
+    if (entry->older) entry->older->newer = entry->newer;
+    else oldest = entry->newer;
+}
+
+/** @brief Insertion d'une entrée en tête de la liste LRU. */
+static void push_lru(plan_entry_t* entry) {
+    entry->newer = NULL;
+    entry->older = newest;
+    if (newest) newest->newer = entry;
+    newest = entry;
+    if (!oldest) oldest = entry;
+}
+
+/** @brief Éviction de l'entrée la moins récemment utilisée. */
+static void evict_oldest(void) {
+    plan_entry_t* entry = oldest;
+    plan_entry_t** link = &buckets[entry->hash & (NUM_BUCKETS - 1)];
+    while (*link != entry) link = &(*link)->chain;
+    *link = entry->chain;
+    unlink_lru(entry);
+    free(entry);
+    count--;
+}
+
+/** @brief Recherche du plan d'une ligne. */
+const command_plan_t* plancache_lookup(const char* line, size_t len) {
+    if (shell_options.plancache == 0) {
+        // Cache désactivé par set -o plancache=0 : les plans conservés sont libérés
+        while (oldest) evict_oldest();
+        return NULL;
+    }
+
+    uint64_t h = hash_line(line, len);
+    for (plan_entry_t* entry = buckets[h & (NUM_BUCKETS - 1)]; entry; entry = entry->chain) {
+        if (entry->hash == h && entry->len == len && memcmp(entry->line, line, len) == 0) {
+            if (entry != newest) {
+                unlink_lru(entry);
+                push_lru(entry);
+            }
+            hits++;
+            return entry->plan;
+        }
+    }
+    misses++;
+    return NULL;
+}
+
+/** @brief Ajout du plan d'une ligne. */
+void plancache_insert(const char* line, size_t len, const command_plan_t* plan) {
+    if (shell_options.plancache == 0) return;
+
+    // La capacité a pu être réduite par set -o plancache=N depuis le dernier ajout
+    while (count >= shell_options.plancache) {
+        evict_oldest();
+        evictions++;
+    }
+
+    // Le plan suit la ligne, aligné sur 8 octets
+    size_t plan_offset = (sizeof(plan_entry_t) + len + 7) & ~(size_t)7;
+    plan_entry_t* entry = malloc(plan_offset + plan->size);
+    if (!entry) return;
+
+    entry->hash = hash_line(line, len);
+    entry->len = len;
+    memcpy(entry->line, line, len);
+    entry->plan = (command_plan_t*)((char*)entry + plan_offset);
+    memcpy(entry->plan, plan, plan->size);
+
+    plan_entry_t** bucket = &buckets[entry->hash & (NUM_BUCKETS - 1)];
+    entry->chain = *bucket;
+    *bucket = entry;
+    push_lru(entry);
+    count++;
+}
+
+/** @brief Vidage du cache. */
+void plancache_reset(void) {
+    plancache_flush();
+    hits = misses = evictions = 0;
+}
+
+/** @brief Vidage du cache, sans remise à zéro des compteurs. */
+void plancache_flush(void) {
+    while (oldest) evict_oldest();
+}
+
+/** @brief Affichage des statistiques du cache. */
+void plancache_print(outbuf_t* out) {
+    unsigned long lookups = hits + misses;
+    out_printf(out, "entrées\t\t%zu/%zu\n", count, shell_options.plancache);
+    out_printf(out, "succès\t\t%lu (%.1f%%)\n", hits, lookups ? 100.0 * hits / lookups : 0.0);
+    out_printf(out, "échecs\t\t%lu\n", misses);
+    out_printf(out, "évictions\t%lu\n", evictions);
+}
@@ -6,18 +6,36 @@
  * @details Implémentation des fonctions de gestion des processus.
  */
 
+#define _GNU_SOURCE // close_range(), posix_spawn_file_actions_addclosefrom_np()
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/time.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
 
 #include "processus.h"
+#include "parser.h"
 #include "builtins.h"
+#include "options.h"
+#include "pathcache.h"
+#include "jobs.h"
+#include "pipes.h"
+#include "trace.h"
+#include "vars.h"
+
+extern char **environ;
 
 int last_status = 0;
+int shell_interactive = 0;
+char** positional_params = NULL;
+int num_positional_params = 0;
+pid_t last_background_pid = 0;
 
 
 /**
@@ -36,45 +54,262 @@ int init_processus(processus_t* proc) {
     return 0;
 }
 
-/** * @brief Fonction de lancement d'un processus à partir d'une structure de processus.
+/** @brief Fermeture côté père des descripteurs propres à un processus (pipes, fichiers de redirection).
+ * @details Les descripteurs standards du shell (0, 1, 2) ne sont jamais fermés : *stdout_fd* vaut 2 dans le cas >&2.
+ *    Les descripteurs sont fermés via *remove_fd()*.
  */
-int launch_processus(processus_t* proc) {
-    if (!proc) return -1;
+static void release_fds(processus_t* proc) {
+    int* fds[3] = {&proc->stdin_fd, &proc->stdout_fd, &proc->stderr_fd};
+    int defaults[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+    for (int i = 0; i < 3; i++) {
+        if (*fds[i] > STDERR_FILENO) {
+            if (!proc->cf || !proc->cf->cmdl || remove_fd(proc->cf->cmdl, *fds[i]) != 0) close(*fds[i]);
+            *fds[i] = defaults[i];
+        }
+    }
+}
 
-    // 1. Gestion des commandes intégrées (Builtins)
-    if (is_builtin(proc)) {
-        // Sauvegarde des descripteurs standards actuels du shell père
-        int saved_stdin = dup(STDIN_FILENO);
-        int saved_stdout = dup(STDOUT_FILENO);
-        int saved_stderr = dup(STDERR_FILENO);
+/** @brief Donne le terminal au groupe de processus *pgid* (shell interactif uniquement). */
+static void give_terminal(pid_t pgid) {
+    if (shell_interactive) tcsetpgrp(STDIN_FILENO, pgid);
+}
 
-        // Application des redirections si nécessaire
-        if (proc->stdin_fd != STDIN_FILENO) dup2(proc->stdin_fd, STDIN_FILENO);
-        if (proc->stdout_fd != STDOUT_FILENO) dup2(proc->stdout_fd, STDOUT_FILENO);
-        if (proc->stderr_fd != STDERR_FILENO) dup2(proc->stderr_fd, STDERR_FILENO);
+/** @brief Conversion d'une date CLOCK_MONOTONIC en nanosecondes (horloge du journal d'exécution). */
+static uint64_t timespec_ns(const struct timespec* ts) {
+    return (uint64_t)ts->tv_sec * 1000000000u + ts->tv_nsec;
+}
 
-        // Exécution de la commande
-        int ret = exec_builtin(proc);
-        
-        // Mise à jour du statut
-        proc->status = ret;
-        if (proc->invert) proc->status = !proc->status;
+/** @brief Rang de la commande d'un processus dans sa ligne, -1 si le processus n'est pas rattaché à une ligne. */
+static int flow_index(const processus_t* proc) {
+    return proc->cf ? (int)proc->cf->index : -1;
+}
+
+/** @brief Environnement d'une commande : celui du shell, complété par ses affectations *NOM=valeur* éventuelles. */
+static char** command_environ(processus_t* proc) {
+    if (proc->envp == NULL || proc->cf == NULL) return vars_environ();
+    char** envp = vars_environ_overlay(proc->envp, &proc->cf->cmdl->arena);
+    return envp ? envp : vars_environ();
+}
+
+/** @brief Interpréteur des fichiers exécutables sans ligne #! (ENOEXEC). */
+#define SCRIPT_SHELL "/bin/sh"
+
+/** @brief Nombre d'entrées (NULL final compris) du vecteur construit par *script_argv()*. */
+static int script_argc(const processus_t* proc) {
+    int argc = 0;
+    while (proc->argv[argc] != NULL) argc++;
+    return argc + 2;
+}
+
+/** @brief Construction du vecteur "/bin/sh chemin arg1 ..." relançant un script sans ligne #!.
+ * @param sh_argv Tableau d'au moins *script_argc(proc)* entrées.
+ */
+static void script_argv(const processus_t* proc, char** sh_argv) {
+    sh_argv[0] = SCRIPT_SHELL;
+    sh_argv[1] = proc->path;
+    for (int i = 1; proc->argv[i - 1] != NULL; i++) sh_argv[i + 1] = proc->argv[i];
+}
+
+/** @brief Signalement d'un échec de lancement, commun aux deux modes de lancement.
+ * @details Le nom de la commande est suivi de "commande introuvable" pour ENOENT, du message de *strerror()* sinon.
+ * @param fd Descripteur sur lequel écrire le message.
+ * @param err Code d'erreur de *execve()* ou *posix_spawn()*.
+ * @return int Statut de la commande : 127 pour ENOENT, 126 (commande trouvée mais non exécutable) sinon.
+ */
+static int exec_failure(const processus_t* proc, int fd, int err) {
+    if (err == ENOENT) {
+        dprintf(fd, "%s: commande introuvable\n", proc->argv[0]);
+        return 127; // Code standard pour command not found
+    }
+    dprintf(fd, "%s: %s\n", proc->argv[0], strerror(err));
+    return 126;
+}
+
+/** @brief Partie "fils" d'un lancement : redirections puis exécution. Ne retourne jamais. */
+static void exec_child(processus_t* proc) {
+    // Le shell ignore SIGTTOU pour pouvoir reprendre le terminal : le fils doit retrouver le comportement par défaut
+    signal(SIGTTOU, SIG_DFL);
+    signal(SIGCHLD, SIG_DFL); // Gestionnaire de la table des tâches (conservé sans exec par une commande intégrée)
+    signal(SIGPIPE, SIG_DFL); // Ignoré par le shell (commandes intégrées écrivant dans un tube)
+    if (shell_interactive) {
+        // Signaux du terminal ignorés par le shell interactif
+        signal(SIGINT, SIG_DFL);
+        signal(SIGQUIT, SIG_DFL);
+        signal(SIGTSTP, SIG_DFL);
+        signal(SIGTTIN, SIG_DFL);
+    }
+
+    // Application des redirections
+    if (proc->stdin_fd != STDIN_FILENO) {
+        if (dup2(proc->stdin_fd, STDIN_FILENO) == -1) { perror("dup2 stdin"); _exit(1); }
+    }
+    if (proc->stdout_fd != STDOUT_FILENO) {
+        if (dup2(proc->stdout_fd, STDOUT_FILENO) == -1) { perror("dup2 stdout"); _exit(1); }
+    }
+    /* --- stderr --- */
+    if (proc->stderr_fd == -1) {
+        // Cas 2>&1 : stderr doit suivre stdout (déjà redirigé ou pipe)
+        if (dup2(STDOUT_FILENO, STDERR_FILENO) == -1) {
+            perror("dup2 stderr->stdout");
+            _exit(1);
+        }
+    }
+    else if (proc->stderr_fd != STDERR_FILENO) {
+        if (dup2(proc->stderr_fd, STDERR_FILENO) == -1) {
+            perror("dup2 stderr");
+            _exit(1);
+        }
+    }
+
+    // Commande intégrée lancée comme étage d'un tube : elle écrit désormais sur les descripteurs standards du fils
+    int builtin = is_builtin(proc);
+    if (builtin) {
+        proc->stdin_fd = STDIN_FILENO;
+        proc->stdout_fd = STDOUT_FILENO;
+        proc->stderr_fd = STDERR_FILENO;
+    }
 
-        // Restauration des descripteurs standards
-        dup2(saved_stdin, STDIN_FILENO); close(saved_stdin);
-        dup2(saved_stdout, STDOUT_FILENO); close(saved_stdout);
-        dup2(saved_stderr, STDERR_FILENO); close(saved_stderr);
+    // Les tubes et fichiers de la ligne sont ouverts avec O_CLOEXEC : *dup2()* retire l'indicateur des seules copies
+    // sur 0, 1 et 2, les autres se ferment à l'exec (CRUCIAL pour que la fin d'un tube soit détectée).
+    // Une commande intégrée ne passe pas par exec : elle ferme tout ce qui dépasse 2 en un appel.
+    if (builtin) {
+        close_range(STDERR_FILENO + 1, ~0U, 0);
+        exit(exec_builtin(proc));
+    }
+    // Filet de sécurité pour un descripteur ouvert sans O_CLOEXEC (sans effet avant Linux 5.11)
+    close_range(STDERR_FILENO + 1, ~0U, CLOSE_RANGE_CLOEXEC);
+
+    if (TRACE_ENABLED()) {
+        uint64_t now = trace_now();
+        trace_event(TRACE_EXEC, flow_index(proc), getpid(), now, now, 0);
+    }
+
+    // Exécution du chemin résolu par le cache ; s'il a disparu depuis, recherche classique dans PATH
+    char** envp = command_environ(proc);
+    execve(proc->path, proc->argv, envp);
+    if (errno == ENOEXEC) {
+        // Script sans ligne #! : interprété par /bin/sh, comme le fait execvp()
+        char* sh_argv[script_argc(proc)];
+        script_argv(proc, sh_argv);
+        execve(SCRIPT_SHELL, sh_argv, envp);
+    }
+    else if (errno == ENOENT) {
+        environ = envp; // Environnement transmis par execvp()
+        execvp(proc->argv[0], proc->argv);
+    }
+
+    // Si on arrive ici, c'est une erreur
+    _exit(exec_failure(proc, STDERR_FILENO, errno));
+}
 
-        // Fermeture des fichiers ouverts par cette commande (ex: fichier de redirection)
-        // Note : On ferme dans le père car pas de fork pour les builtins
-        if (proc->stdin_fd != STDIN_FILENO) close(proc->stdin_fd);
-        if (proc->stdout_fd != STDOUT_FILENO) close(proc->stdout_fd);
-        if (proc->stderr_fd != STDERR_FILENO) close(proc->stderr_fd);
+/** @brief Signalement d'un échec de lancement sur la sortie d'erreur (éventuellement redirigée) du processus.
+ * @details Aucun processus n'est créé : *pid* reste à 0 et *status* vaut 127 ou 126 (voir *exec_failure()*).
+ */
+static void spawn_failure(processus_t* proc, int err) {
+    int fd = (proc->stderr_fd == -1) ? proc->stdout_fd : proc->stderr_fd;
+    proc->pid = 0;
+    proc->status = exec_failure(proc, fd, err);
+}
 
+/** @brief Création du processus fils via *posix_spawn()*.
+ * @details Les redirections de *exec_child()* sont traduites en actions *dup2* et la fermeture des descripteurs
+ *    au-delà de 2 en une action *closefrom*. Le groupe de processus et la disposition par défaut de SIGTTOU, SIGPIPE
+ *    (et des signaux du terminal en mode interactif) sont fixés par les attributs. La glibc crée le fils avec *clone(CLONE_VM|CLONE_VFORK)* :
+ *    les tables de pages du shell ne sont pas copiées.
+ * @return int 0 en cas de succès (y compris commande introuvable), -1 en cas d'erreur système.
+ */
+static int spawn_posix(processus_t* proc, pid_t pgid) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigdefault;
+    pid_t pid;
+    int err;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    // Redirections, dans le même ordre que exec_child()
+    if (proc->stdin_fd != STDIN_FILENO) posix_spawn_file_actions_adddup2(&actions, proc->stdin_fd, STDIN_FILENO);
+    if (proc->stdout_fd != STDOUT_FILENO) posix_spawn_file_actions_adddup2(&actions, proc->stdout_fd, STDOUT_FILENO);
+    if (proc->stderr_fd == -1) posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    else if (proc->stderr_fd != STDERR_FILENO) posix_spawn_file_actions_adddup2(&actions, proc->stderr_fd, STDERR_FILENO);
+
+    // Descripteurs du shell : fermés à l'exec (O_CLOEXEC), et par une seule action en filet de sécurité
+    posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+
+    sigemptyset(&sigdefault);
+    sigaddset(&sigdefault, SIGTTOU);
+    sigaddset(&sigdefault, SIGPIPE);
+    if (shell_interactive) {
+        sigaddset(&sigdefault, SIGINT);
+        sigaddset(&sigdefault, SIGQUIT);
+        sigaddset(&sigdefault, SIGTSTP);
+        sigaddset(&sigdefault, SIGTTIN);
+    }
+    posix_spawnattr_setsigdefault(&attr, &sigdefault);
+    posix_spawnattr_setpgroup(&attr, pgid);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF);
+
+    uint64_t start = TRACE_ENABLED() ? trace_now() : 0;
+    char** envp = command_environ(proc);
+    err = posix_spawn(&pid, proc->path, &actions, &attr, proc->argv, envp);
+    if (err == ENOEXEC) {
+        // Script sans ligne #! : interprété par /bin/sh, comme dans exec_child()
+        char* sh_argv[script_argc(proc)];
+        script_argv(proc, sh_argv);
+        err = posix_spawn(&pid, SCRIPT_SHELL, &actions, &attr, sh_argv, envp);
+    }
+    else if (err == ENOENT) err = posix_spawnp(&pid, proc->argv[0], &actions, &attr, proc->argv, envp);
+    if (TRACE_ENABLED()) trace_event(TRACE_SPAWN, flow_index(proc), err == 0 ? pid : 0, start, trace_now(), 0);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    if (err != 0) {
+        spawn_failure(proc, err);
         return 0;
     }
 
-    // 2. Gestion des commandes externes
+    proc->pid = pid;
+    proc->pgid = pgid ? pgid : pid;
+    return 0;
+}
+
+/** @brief Fonction de création du processus fils d'une commande, sans attente. */
+int spawn_processus(processus_t* proc, pid_t pgid) {
+    clock_gettime(CLOCK_MONOTONIC, &proc->start_time);
+    proc->end_time = proc->start_time;
+
+    // Commande vide (ex: "< fichier") : rien à lancer
+    if (proc->argv == NULL || proc->argv[0] == NULL) {
+        proc->pid = 0;
+        proc->status = 0;
+        release_fds(proc);
+        return 0;
+    }
+
+    // Résolution dans le père pour que le cache profite aux lancements suivants
+    if (!is_builtin(proc)) {
+        const char* path = pathcache_lookup(proc->argv[0]);
+        if (path == NULL) {
+            spawn_failure(proc, ENOENT);
+            release_fds(proc);
+            return 0;
+        }
+        proc->path = (char*)path;
+    }
+
+    if (shell_options.spawn == SPAWN_POSIX_SPAWN && !is_builtin(proc)) {
+        int ret = spawn_posix(proc, pgid);
+        release_fds(proc);
+        return ret;
+    }
+
+    // Évite que le fils hérite (et réécrive) des données en attente dans le tampon de stdout
+    fflush(stdout);
+
+    uint64_t start = TRACE_ENABLED() ? trace_now() : 0;
     pid_t pid = fork();
 
     if (pid < 0) {
@@ -84,80 +319,259 @@ int launch_processus(processus_t* proc) {
 
     if (pid == 0) {
         // --- PROCESSUS FILS ---
-        
-        // Application des redirections
-        if (proc->stdin_fd != STDIN_FILENO) {
-            if (dup2(proc->stdin_fd, STDIN_FILENO) == -1) { perror("dup2 stdin"); exit(1); }
+        setpgid(0, pgid);
+        exec_child(proc);
+    }
+
+    // --- PROCESSUS PÈRE ---
+    if (TRACE_ENABLED()) trace_event(TRACE_FORK, flow_index(proc), pid, start, trace_now(), 0);
+
+    // setpgid est appelé des deux côtés pour éviter toute course avec le fils
+    proc->pid = pid;
+    proc->pgid = pgid ? pgid : pid;
+    setpgid(pid, proc->pgid);
+
+    // Fermeture des descripteurs côté père qui ont été passés au fils.
+    // C'est indispensable pour les pipes : si le père garde le bout d'écriture ouvert,
+    // le lecteur ne recevra jamais EOF.
+    release_fds(proc);
+    return 0;
+}
+
+/** @brief Mise à jour d'un processus attendu : statut, date de fin et ressources consommées.
+ * @details Un processus arrêté (Ctrl+Z, mode interactif) passe *stopped* à 1 et prend le statut 128 + signal.
+ */
+static void set_wait_status(processus_t* proc, int wstatus, const struct rusage* rusage) {
+    clock_gettime(CLOCK_MONOTONIC, &proc->end_time);
+    proc->rusage = *rusage;
+
+    if (WIFEXITED(wstatus)) {
+        proc->status = WEXITSTATUS(wstatus);
+    } else if (WIFSTOPPED(wstatus)) {
+        proc->stopped = 1;
+        proc->status = 128 + WSTOPSIG(wstatus);
+    } else {
+        proc->status = 1; // Terminé par signal ou autre erreur
+    }
+
+    if (TRACE_ENABLED()) {
+        trace_event(TRACE_WAIT, flow_index(proc), proc->pid, timespec_ns(&proc->start_time), timespec_ns(&proc->end_time), proc->status);
+    }
+}
+
+/** @brief Fonction d'attente de la fin d'un processus lancé par spawn_processus(). */
+void wait_processus(processus_t* proc) {
+    int wstatus;
+    struct rusage rusage;
+
+    if (proc->pid <= 0) return;
+
+    while (wait4(proc->pid, &wstatus, shell_interactive ? WUNTRACED : 0, &rusage) == -1) {
+        if (errno != EINTR) {
+            perror("wait4");
+            proc->status = 1;
+            return;
         }
-        if (proc->stdout_fd != STDOUT_FILENO) {
-            if (dup2(proc->stdout_fd, STDOUT_FILENO) == -1) { perror("dup2 stdout"); exit(1); }
+    }
+    set_wait_status(proc, wstatus, &rusage);
+}
+
+/** @brief Attente des étages d'un tube au premier plan dans l'ordre où ils se terminent.
+ * @details Chaque étage reçoit sa propre date de fin, même s'il se termine avant les étages précédents.
+ *    L'attente porte sur tous les fils : une tâche en arrière-plan qui se termine pendant ce temps est récupérée
+ *    aussitôt par jobs_reap(), avec sa vraie date de fin, au lieu d'attendre la ligne suivante.
+ */
+static void wait_pipeline(control_flow_t* first) {
+    int pending = 0;
+    for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+        if (cf->proc->pid > 0) pending++;
+    }
+
+    while (pending > 0) {
+        int wstatus;
+        struct rusage rusage;
+        pid_t pid = wait4(-1, &wstatus, shell_interactive ? WUNTRACED : 0, &rusage);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            perror("wait4");
+            return;
         }
-        /* --- stderr --- */
-        if (proc->stderr_fd == -1) {
-            // Cas 2>&1 : stderr doit suivre stdout (déjà redirigé ou pipe)
-            if (dup2(STDOUT_FILENO, STDERR_FILENO) == -1) {
-                perror("dup2 stderr->stdout");
-                exit(1);
-            }
+        control_flow_t* cf = first;
+        while (cf != NULL && cf->proc->pid != pid) cf = cf->pipe_next;
+        if (cf == NULL) {
+            jobs_reap(pid, wstatus); // Tâche en arrière-plan (ou processus de mesure, ignoré)
+            continue;
         }
-        else if (proc->stderr_fd != STDERR_FILENO) {
-            if (dup2(proc->stderr_fd, STDERR_FILENO) == -1) {
-                perror("dup2 stderr");
-                exit(1);
-            }
+        set_wait_status(cf->proc, wstatus, &rusage);
+        pending--;
+    }
+}
+
+/** @brief Exécution d'une commande intégrée dans le shell, sans *fork()* ni modification des descripteurs du shell.
+ * @details La commande écrit directement sur les descripteurs du processus (voir exec_builtin()), qui sont ensuite fermés.
+ */
+static void run_builtin(processus_t* proc) {
+    struct rusage before;
+    getrusage(RUSAGE_SELF, &before);
+    clock_gettime(CLOCK_MONOTONIC, &proc->start_time);
+
+    proc->pid = 0;
+    proc->status = exec_builtin(proc);
+    release_fds(proc);
+
+    // Ressources consommées par la commande : écart des compteurs du shell (la mémoire maximale est celle du shell)
+    clock_gettime(CLOCK_MONOTONIC, &proc->end_time);
+    getrusage(RUSAGE_SELF, &proc->rusage);
+    timersub(&proc->rusage.ru_utime, &before.ru_utime, &proc->rusage.ru_utime);
+    timersub(&proc->rusage.ru_stime, &before.ru_stime, &proc->rusage.ru_stime);
+    proc->rusage.ru_nvcsw -= before.ru_nvcsw;
+    proc->rusage.ru_nivcsw -= before.ru_nivcsw;
+
+    if (TRACE_ENABLED()) {
+        trace_event(TRACE_BUILTIN, flow_index(proc), getpid(), timespec_ns(&proc->start_time), timespec_ns(&proc->end_time), proc->status);
+    }
+}
+
+/** * @brief Fonction de lancement d'un processus à partir d'une structure de processus.
+ */
+int launch_processus(processus_t* proc) {
+    if (!proc) return -1;
+
+    // 0. Affectations seules (NOM=valeur sans commande) : variables du shell, exportées seulement si elles l'étaient déjà
+    if (proc->argv == NULL && proc->envp != NULL) {
+        proc->pid = 0;
+        proc->status = 0;
+        for (char** a = proc->envp; *a != NULL; a++) {
+            char* eq = strchr(*a, '=');
+            *eq = '\0';
+            if (vars_set(*a, eq + 1, 0) != 0) proc->status = 1;
+            *eq = '=';
+            if (strncmp(*a, "PATH=", 5) == 0) pathcache_reset();
         }
+        release_fds(proc);
+        if (proc->invert) proc->status = !proc->status;
+        return 0;
+    }
+
+    // 1. Gestion des commandes intégrées (Builtins) : exécutées dans le shell, sur les descripteurs du processus
+    // En arrière-plan, elles passent par un fils comme les autres commandes (tâche attendue, $! renseigné), de même que
+    // les commandes qui recopient un flux en mode interactif (interruptibles par Ctrl+C)
+    if (is_builtin(proc) && !proc->is_background && !(shell_interactive && is_stream_builtin(proc))) {
+        run_builtin(proc);
+        if (proc->invert) proc->status = !proc->status;
+        return 0;
+    }
+
+    // 2. Gestion des commandes externes
+    if (spawn_processus(proc, 0) != 0) {
+        return -1;
+    }
+
+    // Gestion de l'attente (pid nul : commande introuvable, statut déjà positionné)
+    if (proc->pid <= 0) {
+        // Rien à attendre
+    } else if (!proc->is_background) {
+        give_terminal(proc->pgid);
+        if (proc->cf) wait_pipeline(proc->cf);
+        else wait_processus(proc);
+        give_terminal(getpgrp());
+        if (proc->stopped) jobs_add(proc->cf, JOB_STOPPED);
+    } else {
+        // En background, le processus rejoint la table des tâches et on considère succès immédiat pour le flux
+        jobs_add(proc->cf, JOB_RUNNING);
+        proc->status = 0;
+    }
+
+    // Gestion de l'inversion (!)
+    if (proc->invert) {
+        proc->status = !proc->status;
+    }
 
+    return 0;
+}
 
-        // Fermeture de tous les descripteurs gérés par le shell (pipes, fichiers ouverts)
-        // C'est CRUCIAL pour que les pipes fonctionnent (EOF détecté quand tous les écriveurs ferment)
-        if (proc->cf && proc->cf->cmdl) {
-            close_fds(proc->cf->cmdl);
+/** @brief Insertion du processus de mesure (voir pipes.h) entre un étage et le tube qui l'alimente.
+ * @details Le lecteur reçoit le tube de sortie de la mesure ; le père ferme aussitôt le bout de lecture d'origine.
+ *    En cas d'échec, le tube est laissé tel quel, sans mesure.
+ */
+static void start_meter(processus_t* proc, pid_t pgid) {
+    command_line_t* cmdl = proc->cf->cmdl;
+    int fd = proc->stdin_fd;
+    pid_t pid = pipe_meter(&fd, flow_index(proc), pgid);
+    if (pid < 0) return;
+
+    remove_fd(cmdl, proc->stdin_fd);
+    proc->stdin_fd = fd;
+    add_fd(cmdl, fd);
+    proc->meter_pid = pid;
+}
+
+/** * @brief Fonction de lancement d'un tube (pipeline) complet.
+ */
+int launch_pipeline(control_flow_t* first) {
+    if (!first || !first->proc) return -1;
+
+    // Un seul étage : les commandes intégrées restent exécutées dans le shell
+    if (!first->pipe_next) return launch_processus(first->proc);
+
+    control_flow_t* last = first;
+    while (last->pipe_next) last = last->pipe_next;
+    int background = last->proc->is_background;
+
+    // Un étage au plus (le dernier éligible) est une commande intégrée pure exécutée dans le shell, une fois tous les autres
+    // étages lancés : ses voisins dans le tube sont alors des processus actifs, l'écriture ou la lecture ne peut pas bloquer
+    // indéfiniment. En mode interactif, une commande qui recopie un flux (et pourrait lire le terminal) reste dans un fils.
+    control_flow_t* in_shell = NULL;
+    if (!background) {
+        for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+            if (is_pure_builtin(cf->proc) && !(shell_interactive && is_stream_builtin(cf->proc))) in_shell = cf;
         }
+    }
 
-        // Exécution
-        execvp(proc->argv[0], proc->argv);
-        
-        // Si on arrive ici, c'est une erreur
-        fprintf(stderr, "%s: commande introuvable\n", proc->argv[0]);
-        exit(127); // Code standard pour command not found
-    } 
-    else {
-        // --- PROCESSUS PÈRE ---
-        proc->pid = pid;
-
-        // Fermeture des descripteurs côté père qui ont été passés au fils.
-        // C'est indispensable pour les pipes : si le père garde le bout d'écriture ouvert,
-        // le lecteur ne recevra jamais EOF.
-        if (proc->stdin_fd != STDIN_FILENO) close(proc->stdin_fd);
-        if (proc->stdout_fd != STDOUT_FILENO) close(proc->stdout_fd);
-        if (proc->stderr_fd != STDERR_FILENO) close(proc->stderr_fd);
-
-        // Gestion de l'attente
-        if (!proc->is_background) {
-            int wstatus;
-            if (waitpid(pid, &wstatus, 0) == -1) {
-                perror("waitpid");
-                proc->status = 1;
-            } else {
-                if (WIFEXITED(wstatus)) {
-                    proc->status = WEXITSTATUS(wstatus);
-                } else {
-                    proc->status = 1; // Terminé par signal ou autre erreur
-                }
-            }
-        } else {
-            // En background, on affiche le PID et on considère succès immédiat pour le flux
-            printf("[%d] %d\n", 1, pid); // Id job simulé à 1
-            proc->status = 0;
+    // 1. Lancement de tous les étages avant toute attente : ils s'exécutent en parallèle
+    pid_t pgid = 0;
+    int invert = 0;
+    int ret = 0;
+    for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) {
+        processus_t* proc = cf->proc;
+        invert |= proc->invert;
+        if (TRACE_ENABLED() && proc->stdin_pipe) start_meter(proc, pgid);
+        if (cf == in_shell) continue;
+
+        if (spawn_processus(proc, pgid) != 0) {
+            // Les étages suivants ne seront pas lancés, leurs descripteurs sont fermés par close_fds()
+            ret = -1;
+            break;
+        }
+        if (pgid == 0 && proc->pid > 0) {
+            pgid = proc->pgid;
+            if (!background) give_terminal(pgid);
         }
+    }
 
-        // Gestion de l'inversion (!)
-        if (proc->invert) {
-            proc->status = !proc->status;
+    if (in_shell && ret == 0) run_builtin(in_shell->proc);
+
+    // 2. Attente groupée des étages
+    if (background) {
+        jobs_add(first, JOB_RUNNING);
+        last->proc->status = 0;
+    } else {
+        int stopped = 0;
+        if (pgid != 0) wait_pipeline(first);
+        for (control_flow_t* cf = first; cf != NULL; cf = cf->pipe_next) stopped |= cf->proc->stopped;
+        // Processus de mesure terminés avec leur lecteur (tube arrêté : récupérés plus tard par jobs_update())
+        for (control_flow_t* cf = first; cf != NULL && !stopped; cf = cf->pipe_next) {
+            if (cf->proc->meter_pid > 0) while (waitpid(cf->proc->meter_pid, NULL, 0) == -1 && errno == EINTR) {}
         }
+        if (pgid != 0) give_terminal(getpgrp());
+        if (stopped) jobs_add(first, JOB_STOPPED);
     }
 
-    return 0;
+    // Le statut du tube est celui de son dernier étage
+    if (ret != 0 && last->proc->pid == 0) last->proc->status = 1;
+    if (invert) last->proc->status = !last->proc->status;
+
+    return ret;
 }
 
 /** * @brief Fonction d'initialisation d'une structure de contrôle de flux.
@@ -172,14 +586,15 @@ int init_control_flow(control_flow_t* cf) {
  */
 processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode) {
     if (!cmdl) return NULL;
-    if (cmdl->num_commands >= MAX_CMDS) {
-        fprintf(stderr, "Erreur: Trop de commandes.\n");
-        return NULL;
-    }
 
     // Récupération des pointeurs vers les nouvelles structures
-    processus_t* new_proc = &cmdl->commands[cmdl->num_commands];
-    control_flow_t* new_flow = &cmdl->flow[cmdl->num_commands];
+    processus_t* new_proc = next_processus(cmdl);
+    control_flow_t* new_flow = arena_alloc(&cmdl->arena, sizeof(control_flow_t));
+    if (!new_proc || !new_flow) {
+        fprintf(stderr, "Erreur: mémoire insuffisante.\n");
+        return NULL;
+    }
+    cmdl->next_proc = NULL;
 
     // Initialisation
     init_processus(new_proc);
@@ -188,11 +603,12 @@ processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode) {
     // Liaison bidirectionnelle
     new_flow->proc = new_proc;
     new_flow->cmdl = cmdl;
+    new_flow->index = cmdl->num_commands;
     new_proc->cf = new_flow;
 
     // Chaînage avec le processus précédent (s'il existe)
-    if (cmdl->num_commands > 0) {
-        control_flow_t* prev_flow = &cmdl->flow[cmdl->num_commands - 1];
+    if (cmdl->last_flow != NULL) {
+        control_flow_t* prev_flow = cmdl->last_flow;
         
         switch (mode) {
             case UNCONDITIONAL:
@@ -204,9 +620,15 @@ processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode) {
             case ON_FAILURE:
                 prev_flow->on_failure_next = new_flow;
                 break;
+            case PIPE:
+                prev_flow->pipe_next = new_flow;
+                break;
         }
+    } else {
+        cmdl->flow = new_flow;
     }
 
+    cmdl->last_flow = new_flow;
     cmdl->num_commands++;
     return new_proc;
 }
@@ -215,38 +637,74 @@ processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode) {
  */
 processus_t* next_processus(command_line_t* cmdl) {
     if (!cmdl) return NULL;
-    if (cmdl->num_commands >= MAX_CMDS) return NULL;
     
-    // Retourne un pointeur vers l'espace mémoire qui SERA utilisé par le prochain add_processus
+    // Réserve l'espace mémoire qui SERA utilisé par le prochain add_processus
     // Cela permet au parser de configurer les pipes avant même que le processus ne soit "ajouté" au flux.
-    return &cmdl->commands[cmdl->num_commands];
+    if (cmdl->next_proc == NULL) {
+        cmdl->next_proc = arena_alloc(&cmdl->arena, sizeof(processus_t));
+        if (cmdl->next_proc) init_processus(cmdl->next_proc);
+    }
+    return cmdl->next_proc;
+}
+
+/** * @brief Fonction d'ajout d'un argument à un processus.
+ */
+int add_argument(command_line_t* cmdl, processus_t* proc, char* arg) {
+    if (!cmdl || !proc) return -1;
+
+    // Agrandissement par doublement (place pour le NULL final comprise)
+    if (proc->argc + 2 > proc->argv_size) {
+        int new_size = proc->argv_size ? proc->argv_size * 2 : 8;
+        char** argv = arena_realloc(&cmdl->arena, proc->argv, proc->argv_size * sizeof(char*), new_size * sizeof(char*));
+        if (!argv) return -1;
+        proc->argv = argv;
+        proc->argv_size = new_size;
+    }
+
+    if (proc->argc == 0) proc->path = arg;
+    proc->argv[proc->argc++] = arg;
+    proc->argv[proc->argc] = NULL;
+    return 0;
 }
 
 /** * @brief Fonction d'ajout d'un descripteur de fichier à la structure de contrôle de flux.
  */
 int add_fd(command_line_t* cmdl, int fd) {
     if (!cmdl || fd < 0) return -1;
-    
-    // Taille du tableau opened_descriptors (défini dans processus.h comme MAX_CMDS * 3 + 1)
-    int max_fds = MAX_CMDS * 3 + 1;
 
-    for (int i = 0; i < max_fds; i++) {
-        if (cmdl->opened_descriptors[i] == -1) {
-            cmdl->opened_descriptors[i] = fd;
+    if (cmdl->num_descriptors == cmdl->max_descriptors) {
+        unsigned int new_max = cmdl->max_descriptors ? cmdl->max_descriptors * 2 : 16;
+        int* fds = arena_realloc(&cmdl->arena, cmdl->opened_descriptors,
+                                 cmdl->max_descriptors * sizeof(int), new_max * sizeof(int));
+        if (!fds) return -1;
+        cmdl->opened_descriptors = fds;
+        cmdl->max_descriptors = new_max;
+    }
+    cmdl->opened_descriptors[cmdl->num_descriptors++] = fd;
+    return 0;
+}
+
+/** * @brief Fonction de fermeture d'un descripteur de fichier et de retrait du tableau.
+ */
+int remove_fd(command_line_t* cmdl, int fd) {
+    if (!cmdl || fd < 0) return -1;
+
+    for (unsigned int i = 0; i < cmdl->num_descriptors; i++) {
+        if (cmdl->opened_descriptors[i] == fd) {
+            close(fd);
+            cmdl->opened_descriptors[i] = -1;
             return 0;
         }
     }
-    return -1; // Tableau plein
+    return -1;
 }
 
 /** * @brief Fonction de fermeture des descripteurs de fichiers listés.
  */
 int close_fds(command_line_t* cmdl) {
     if (!cmdl) return -1;
-    
-    int max_fds = MAX_CMDS * 3 + 1;
 
-    for (int i = 0; i < max_fds; i++) {
+    for (unsigned int i = 0; i < cmdl->num_descriptors; i++) {
         if (cmdl->opened_descriptors[i] != -1) {
             close(cmdl->opened_descriptors[i]);
             cmdl->opened_descriptors[i] = -1;
@@ -259,49 +717,157 @@ int close_fds(command_line_t* cmdl) {
  */
 int init_command_line(command_line_t* cmdl) {
     if (!cmdl) return -1;
-    
-    // Mise à zéro complète
-    memset(cmdl, 0, sizeof(command_line_t));
-    
-    // Initialisation spécifique du tableau des descripteurs à -1
-    int max_fds = MAX_CMDS * 3 + 1;
-    for (int i = 0; i < max_fds; i++) {
-        cmdl->opened_descriptors[i] = -1;
-    }
-    
+
+    // Libération en temps constant de toutes les données de la ligne précédente
+    arena_reset(&cmdl->arena);
+
+    cmdl->command_line = NULL;
+    cmdl->tokens = NULL;
+    cmdl->num_tokens = 0;
+    cmdl->flow = NULL;
+    cmdl->last_flow = NULL;
+    cmdl->next_proc = NULL;
+    cmdl->num_commands = 0;
+    cmdl->opened_descriptors = NULL;
+    cmdl->num_descriptors = 0;
+    cmdl->max_descriptors = 0;
+    cmdl->plan = NULL;
+    cmdl->here_bodies = NULL;
+
     return 0;
 }
 
+/** * @brief Fonction de libération de la mémoire d'une structure de ligne de commande.
+ */
+int free_command_line(command_line_t* cmdl) {
+    if (!cmdl) return -1;
+
+    close_fds(cmdl);
+    arena_free(&cmdl->arena);
+    return init_command_line(cmdl);
+}
+
+/** @brief Recherche du prochain tube à lancer après le tube terminé par *cf*, selon le statut *status*.
+ * @details Les tubes dont la condition (&& ou ||) n'est pas remplie sont sautés : l'évaluation reprend après eux
+ *    avec le même statut, comme dans *false && a || b*.
+ */
+static control_flow_t* next_pipeline(control_flow_t* cf, int status) {
+    while (1) {
+        control_flow_t* next;
+        control_flow_mode_t mode;
+
+        if (cf->on_success_next) { next = cf->on_success_next; mode = ON_SUCCESS; }
+        else if (cf->on_failure_next) { next = cf->on_failure_next; mode = ON_FAILURE; }
+        else if (cf->unconditionnal_next) { next = cf->unconditionnal_next; mode = UNCONDITIONAL; }
+        else return NULL;
+
+        if (mode == UNCONDITIONAL || (mode == ON_SUCCESS && status == 0) || (mode == ON_FAILURE && status != 0)) {
+            return next;
+        }
+
+        // Tube sauté : on repart de son dernier étage
+        cf = next;
+        while (cf->pipe_next) cf = cf->pipe_next;
+    }
+}
+
+/** @brief Structure de contrôle de flux suivante dans l'ordre de la ligne (quel que soit le chaînage). */
+static control_flow_t* next_flow(control_flow_t* cf) {
+    if (cf->pipe_next) return cf->pipe_next;
+    if (cf->on_success_next) return cf->on_success_next;
+    if (cf->on_failure_next) return cf->on_failure_next;
+    return cf->unconditionnal_next;
+}
+
+/** @brief Durée écoulée entre deux dates, en secondes. */
+static double elapsed(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** @brief Affichage d'une durée au format *NmS.SSSs*, précédée de son libellé. */
+static void print_duration(const char* label, double seconds) {
+    int minutes = (int)(seconds / 60);
+    fprintf(stderr, "%s\t%dm%.3fs\n", label, minutes, seconds - minutes * 60);
+}
+
+/** @brief Affichage sur la sortie d'erreur des mesures d'une liste préfixée par *time*.
+ * @param first Première commande de la liste.
+ * @param start Date de lancement de la liste.
+ * @details Les commandes sautées par le contrôle de flux (date de lancement nulle) ne sont pas comptées.
+ *    Avec plusieurs commandes, une ligne par commande précède le total pour repérer l'étage le plus coûteux.
+ */
+static void report_times(control_flow_t* first, const struct timespec* start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int num_run = 0;
+    for (control_flow_t* cf = first; cf != NULL && (cf == first || cf->proc->timed == TIMED_NEXT); cf = next_flow(cf)) {
+        if (cf->proc->start_time.tv_sec != 0 || cf->proc->start_time.tv_nsec != 0) num_run++;
+    }
+
+    double user = 0, sys = 0;
+    long max_rss = 0, nvcsw = 0, nivcsw = 0;
+    for (control_flow_t* cf = first; cf != NULL && (cf == first || cf->proc->timed == TIMED_NEXT); cf = next_flow(cf)) {
+        processus_t* proc = cf->proc;
+        if (proc->start_time.tv_sec == 0 && proc->start_time.tv_nsec == 0) continue;
+
+        const struct rusage* ru = &proc->rusage;
+        double proc_user = ru->ru_utime.tv_sec + ru->ru_utime.tv_usec / 1e6;
+        double proc_sys = ru->ru_stime.tv_sec + ru->ru_stime.tv_usec / 1e6;
+        user += proc_user;
+        sys += proc_sys;
+        if (ru->ru_maxrss > max_rss) max_rss = ru->ru_maxrss;
+        nvcsw += ru->ru_nvcsw;
+        nivcsw += ru->ru_nivcsw;
+
+        if (num_run > 1) {
+            fprintf(stderr, "réel %.3fs, utilisateur %.3fs, système %.3fs, mémoire max %ld Kio, commutations %ld/%ld :",
+                    elapsed(&proc->start_time, &proc->end_time), proc_user, proc_sys, ru->ru_maxrss, ru->ru_nvcsw, ru->ru_nivcsw);
+            for (int i = 0; i < proc->argc; i++) fprintf(stderr, " %s", proc->argv[i]);
+            fprintf(stderr, "\n");
+        }
+    }
+
+    print_duration("réel", elapsed(start, &end));
+    print_duration("utilisateur", user);
+    print_duration("système", sys);
+    fprintf(stderr, "mémoire max\t%ld Kio\n", max_rss);
+    fprintf(stderr, "commutations\t%ld volontaires, %ld involontaires\n", nvcsw, nivcsw);
+}
+
 /** * @brief Fonction de lancement d'une ligne de commande.
  */
 int launch_command_line(command_line_t* cmdl) {
     if (!cmdl || cmdl->num_commands == 0) return 0;
 
     // On commence par le premier élément du flux
-    control_flow_t* current = &cmdl->flow[0];
+    control_flow_t* current = cmdl->flow;
+    control_flow_t* timed_list = NULL; // Première commande de la liste chronométrée en cours
+    struct timespec timed_start;
 
     while (current != NULL) {
-        processus_t* proc = current->proc;
+        if (current->proc->timed == TIMED_START) {
+            timed_list = current;
+            clock_gettime(CLOCK_MONOTONIC, &timed_start);
+        }
 
-        if (launch_processus(proc) != 0) {
+        // Mots, tubes et redirections du tube instanciés au dernier moment : effets des tubes précédents visibles
+        if (instantiate_pipeline(current) != 0 || launch_pipeline(current) != 0) {
             fprintf(stderr, "Erreur au lancement du processus\n");
             break;
         }
 
-        last_status = proc->status;
-
-        if (proc->status == 0) {
-            if (current->on_success_next != NULL) {
-                current = current->on_success_next;
-            } else {
-                current = current->unconditionnal_next;
-            }
-        } else {
-            if (current->on_failure_next != NULL) {
-                current = current->on_failure_next;
-            } else {
-                current = current->unconditionnal_next;
-            }
+        // Le contrôle de flux se base sur le dernier étage du tube
+        control_flow_t* last = current;
+        while (last->pipe_next) last = last->pipe_next;
+
+        last_status = last->proc->status;
+        current = next_pipeline(last, last_status);
+
+        // Fin de la liste chronométrée : la commande suivante n'en fait pas partie
+        if (timed_list && (current == NULL || current->proc->timed != TIMED_NEXT)) {
+            report_times(timed_list, &timed_start);
+            timed_list = NULL;
         }
     }
 
@@ -310,4 +876,4 @@ int launch_command_line(command_line_t* cmdl) {
     close_fds(cmdl);
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,199 @@
+/** @file subst.c
+ * @brief Implementation of command substitution
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la substitution de commande : capture de la sortie standard dans un fichier anonyme en
+ *    mémoire, exécution dans le shell ou dans un fils selon les commandes de la ligne, table des résultats du tube en
+ *    cours d'instanciation.
+ */
+
+#define _GNU_SOURCE // memfd_create()
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "subst.h"
+#include "builtins.h"
+#include "parser.h"
+#include "processus.h"
+#include "trace.h"
+
+/** @brief Résultat d'une substitution déjà exécutée. */
+typedef struct {
+    const char* key; ///< Texte de la commande (adresse dans le texte du plan ou dans la ligne lue)
+    const char* out; ///< Sortie de la commande, dans l'arène de la ligne
+    size_t len;      ///< Longueur de la sortie
+} subst_result_t;
+
+static subst_result_t* results = NULL;
+static size_t num_results = 0;
+static size_t max_results = 0;
+static subst_scope_t scope = {0, NULL};
+
+/** @brief Fonction d'ouverture de la portée d'un tube. */
+void subst_enter(subst_scope_t* saved, arena_t* arena) {
+    *saved = scope;
+    scope.base = num_results;
+    scope.arena = arena;
+}
+
+/** @brief Fonction de fermeture de la portée d'un tube. */
+void subst_leave(const subst_scope_t* saved) {
+    num_results = scope.base;
+    scope = *saved;
+}
+
+/** @brief Vérification qu'une ligne peut être lancée par le shell lui-même sans modifier son état.
+ * @details Les mots ne sont expansés qu'au lancement de chaque tube : le nom de chaque commande est lu dans le plan.
+ * @return int 1 si toutes ses commandes sont au premier plan et sont des commandes intégrées pures ou des commandes
+ *    externes, 0 sinon (ex: *cd*, *exit*, affectation seule, '&', nom connu seulement après expansion).
+ */
+static int runs_in_shell(const command_line_t* cmdl) {
+    const command_plan_t* plan = cmdl->plan;
+    const plan_command_t* commands = PLAN_COMMANDS(plan);
+    const plan_word_t* words = PLAN_WORDS(plan);
+    char* text = PLAN_TEXT(plan);
+
+    for (uint32_t c = 0; c < plan->num_commands; c++) {
+        const plan_command_t* command = &commands[c];
+        if (command->background || command->num_words == 0) return 0;
+        const plan_word_t* name = &words[command->first_word + command->num_assigns];
+        if (name->flags & (TOK_F_EXPAND | TOK_F_GLOB)) return 0;
+
+        // Sans ses arguments, une commande intégrée pure est toujours reconnue : seul son nom compte
+        char* argv[] = {text + name->offset, NULL};
+        processus_t proc;
+        init_processus(&proc);
+        proc.argv = argv;
+        proc.argc = 1;
+        if (is_builtin(&proc) && !is_pure_builtin(&proc)) return 0;
+    }
+    return 1;
+}
+
+/** @brief Exécution d'une ligne analysée, sortie standard déjà redirigée vers le fichier de capture.
+ * @details Dans le shell si runs_in_shell(), sinon dans un fils qui se termine avec le statut de la ligne.
+ */
+static void run_line(command_line_t* cmdl) {
+    if (runs_in_shell(cmdl)) {
+        launch_command_line(cmdl);
+        return;
+    }
+
+    uint64_t start = TRACE_ENABLED() ? trace_now() : 0;
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        last_status = 1;
+        return;
+    }
+    if (pid == 0) {
+        // Sous-shell : *cd*, *exit* ou les affectations ne touchent que ce processus
+        launch_command_line(cmdl);
+        fflush(NULL);
+        _exit(last_status);
+    }
+    if (TRACE_ENABLED()) trace_event(TRACE_FORK, -1, pid, start, trace_now(), 0);
+
+    int wstatus;
+    while (waitpid(pid, &wstatus, 0) == -1) {
+        if (errno != EINTR) {
+            last_status = 1;
+            return;
+        }
+    }
+    last_status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1; // Terminé par signal : même convention que set_wait_status()
+}
+
+/** @brief Copie de la sortie capturée dans l'arène de la ligne, sans octets nuls ni sauts de ligne finaux. */
+static int read_capture(int fd, const char** out, size_t* out_len) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+    size_t size = st.st_size;
+    char* data = arena_alloc(scope.arena, size + 1);
+    if (!data) return -1;
+
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, data + done, size - done, done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += n;
+    }
+
+    size_t len = 0;
+    for (size_t i = 0; i < done; i++) {
+        if (data[i] != '\0') data[len++] = data[i];
+    }
+    while (len > 0 && data[len - 1] == '\n') len--;
+    data[len] = '\0';
+    *out = data;
+    *out_len = len;
+    return 0;
+}
+
+/** @brief Fonction d'exécution d'une substitution de commande. */
+int subst_run(const char* cmd, size_t len, const char** out, size_t* out_len) {
+    if (scope.arena == NULL) return -1;
+
+    // Substitution déjà exécutée pour ce texte (expansion recommencée après un dépassement)
+    for (size_t i = scope.base; i < num_results; i++) {
+        if (results[i].key == cmd) {
+            *out = results[i].out;
+            *out_len = results[i].len;
+            return 0;
+        }
+    }
+    if (num_results == max_results) {
+        size_t new_max = max_results ? max_results * 2 : 16;
+        subst_result_t* new_results = realloc(results, new_max * sizeof(subst_result_t));
+        if (!new_results) return -1;
+        results = new_results;
+        max_results = new_max;
+    }
+
+    int fd = memfd_create("minishell-subst", MFD_CLOEXEC);
+    if (fd < 0) {
+        perror("memfd_create");
+        return -1;
+    }
+
+    // Sortie standard du shell redirigée le temps de la commande : commandes intégrées et fils écrivent dans la capture
+    fflush(stdout);
+    int saved_stdout = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+    if (saved_stdout < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+        perror("dup2");
+        if (saved_stdout >= 0) close(saved_stdout);
+        close(fd);
+        return -1;
+    }
+
+    // Ligne imbriquée : sa propre arène, ses propres descripteurs
+    command_line_t sub = {0};
+    init_command_line(&sub);
+    if (parse_command_line(&sub, cmd, len) == 0) {
+        run_line(&sub);
+    } else {
+        last_status = 2;
+    }
+    free_command_line(&sub);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    int ret = read_capture(fd, out, out_len);
+    close(fd);
+    if (ret != 0) return -1;
+
+    results[num_results++] = (subst_result_t){cmd, *out, *out_len};
+    return 0;
+}
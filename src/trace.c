@@ -0,0 +1,181 @@
+/** @file trace.c
+ * @brief Implementation of the execution trace log
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'anneau d'événements partagé et de sa mise en forme en lignes JSON.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "trace.h"
+
+/** @brief Entrée de l'anneau : un événement sous forme binaire.
+ * @struct trace_entry_t
+ */
+typedef struct {
+    uint64_t seq;   ///< Indice de l'événement + 1 une fois l'entrée écrite (publié en dernier)
+    uint64_t start; ///< Début (ns)
+    uint64_t end;   ///< Fin (ns)
+    int64_t value;  ///< Valeur propre au type
+    int64_t extra;  ///< Seconde valeur propre au type
+    int32_t pid;    ///< Processus concerné
+    int32_t flow;   ///< Rang de la commande dans la ligne
+    uint32_t kind;  ///< Type (trace_kind_t)
+} trace_entry_t;
+
+/** @brief Anneau d'événements, projeté en mémoire partagée avec les fils.
+ * @struct trace_ring
+ */
+struct trace_ring {
+    uint64_t head;    ///< Prochain indice à réserver (partagé, modifié par compare-and-swap)
+    uint64_t tail;    ///< Prochain indice à écrire dans le fichier (modifié par le shell uniquement)
+    uint64_t dropped; ///< Événements perdus faute de place (partagé)
+    pid_t owner;      ///< Shell propriétaire : seul processus qui vide l'anneau
+    int fd;           ///< Fichier du journal
+    trace_entry_t entries[TRACE_RING_SIZE]; ///< Entrées, indexées modulo TRACE_RING_SIZE
+};
+
+struct trace_ring* trace_ring = NULL;
+
+/** @brief Noms des événements et de leurs valeurs, indexés par trace_kind_t (NULL : pas de valeur). */
+static const char* const kind_names[][3] = {
+    {"parse", "cache_hit", NULL}, {"pipe", "fd", "size"}, {"open", "fd", NULL}, {"fork", NULL, NULL},
+    {"spawn", NULL, NULL}, {"exec", NULL, NULL}, {"wait", "status", NULL}, {"builtin", "status", NULL},
+    {"pipestats", "bytes", "stall_ns"},
+};
+
+/** @brief Fonction de lecture de l'horloge des événements. */
+uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/** @brief Fermeture du journal en cours : derniers événements écrits, anneau libéré. */
+static void trace_close(void) {
+    if (trace_ring == NULL) return;
+    trace_flush();
+    close(trace_ring->fd);
+    munmap(trace_ring, sizeof(struct trace_ring));
+    trace_ring = NULL;
+}
+
+/** @brief Fonction d'activation ou de désactivation du journal. */
+int trace_open(const char* path) {
+    static int registered = 0;
+
+    if (path == NULL) return -1;
+    if (*path == '\0') {
+        trace_close();
+        return 0;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    struct trace_ring* ring = mmap(NULL, sizeof(struct trace_ring), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    trace_close();
+    ring->owner = getpid();
+    ring->fd = fd;
+    trace_ring = ring;
+    if (!registered) {
+        atexit(trace_flush);
+        registered = 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'enregistrement d'un événement. */
+void trace_event(trace_kind_t kind, int flow, pid_t pid, uint64_t start, uint64_t end, long value) {
+    trace_event_ext(kind, flow, pid, start, end, value, 0);
+}
+
+/** @brief Fonction d'enregistrement d'un événement à deux valeurs. */
+void trace_event_ext(trace_kind_t kind, int flow, pid_t pid, uint64_t start, uint64_t end, long long value, long long extra) {
+    struct trace_ring* ring = trace_ring;
+    if (ring == NULL) return;
+
+    // Réservation d'une entrée libre : l'indice n'avance que s'il reste de la place
+    uint64_t idx = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    do {
+        if (idx - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_SIZE) {
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&ring->head, &idx, idx + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    trace_entry_t* entry = &ring->entries[idx % TRACE_RING_SIZE];
+    entry->start = start;
+    entry->end = end;
+    entry->value = value;
+    entry->extra = extra;
+    entry->pid = pid;
+    entry->flow = flow;
+    entry->kind = kind;
+    __atomic_store_n(&entry->seq, idx + 1, __ATOMIC_RELEASE);
+
+    // Anneau presque plein dans le shell (longue ligne de commande) : vidage immédiat plutôt que des pertes
+    if (getpid() == ring->owner && idx + 1 - ring->tail >= TRACE_RING_SIZE * 3 / 4) trace_flush();
+}
+
+/** @brief Écriture complète d'un tampon dans le journal (les erreurs d'écriture sont ignorées). */
+static void write_buffer(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        buf += n;
+        len -= n;
+    }
+}
+
+/** @brief Fonction d'écriture des événements enregistrés dans le fichier du journal. */
+void trace_flush(void) {
+    struct trace_ring* ring = trace_ring;
+    if (ring == NULL || getpid() != ring->owner) return;
+
+    char buf[16384];
+    size_t len = 0;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    while (ring->tail < head) {
+        trace_entry_t* entry = &ring->entries[ring->tail % TRACE_RING_SIZE];
+        // Entrée réservée mais pas encore publiée (fils en cours d'écriture) : reprise au prochain vidage
+        if (__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE) != ring->tail + 1) break;
+
+        const char* const* names = kind_names[entry->kind];
+        len += snprintf(buf + len, sizeof(buf) - len, "{\"ts_ns\":%llu,\"event\":\"%s\",\"flow\":%d,\"pid\":%d,\"dur_ns\":%llu",
+                        (unsigned long long)entry->start, names[0], entry->flow, entry->pid,
+                        (unsigned long long)(entry->end - entry->start));
+        if (names[1] != NULL) len += snprintf(buf + len, sizeof(buf) - len, ",\"%s\":%lld", names[1], (long long)entry->value);
+        if (names[2] != NULL) len += snprintf(buf + len, sizeof(buf) - len, ",\"%s\":%lld", names[2], (long long)entry->extra);
+        len += snprintf(buf + len, sizeof(buf) - len, "}\n");
+        __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+
+        if (len > sizeof(buf) - 256) {
+            write_buffer(ring->fd, buf, len);
+            len = 0;
+        }
+    }
+
+    uint64_t dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+        len += snprintf(buf + len, sizeof(buf) - len, "{\"ts_ns\":%llu,\"event\":\"dropped\",\"count\":%llu}\n",
+                        (unsigned long long)trace_now(), (unsigned long long)dropped);
+    }
+    if (len > 0) write_buffer(ring->fd, buf, len);
+}
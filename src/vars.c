@@ -0,0 +1,206 @@
+/** @file vars.c
+ * @brief Implementation of the shell variable table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table des variables : table de hachage à adressage ouvert (voir hashtable.h)
+ *    indexée par le nom. Chaque entrée conserve la chaîne *NOM=valeur* complète, vers laquelle pointent son nom
+ *    et le tableau *envp*.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vars.h"
+#include "hashtable.h"
+
+extern char **environ;
+
+/// Capacité initiale de la table (puissance de 2)
+#define INITIAL_CAPACITY 256
+
+/** @brief Entrée de la table : une variable. */
+typedef struct {
+    hash_entry_t entry; ///< Nom (début de *str*), sa longueur et son haché ; la valeur commence à *str + key_len + 1*
+    char* str;          ///< Chaîne "NOM=valeur"
+    int exported;       ///< 1 si la variable fait partie de l'environnement des commandes lancées
+} var_entry_t;
+
+static hash_table_t table = HASH_TABLE_INIT(var_entry_t, INITIAL_CAPACITY);
+static size_t num_exported = 0;
+static int loaded = 0;
+
+static unsigned long generation = 1;  // Incrémenté à chaque modification d'une variable exportée
+static unsigned long envp_generation = 0; // Génération du tableau envp courant
+static char** envp = NULL;
+
+/** @brief Insertion ou remplacement de la chaîne "NOM=valeur" *str* (dont la table prend possession). */
+static int store(char* str, size_t name_len, int exported) {
+    var_entry_t* e = (var_entry_t*)hash_insert(&table, str, name_len, hash_name(str, name_len));
+    if (e == NULL) {
+        free(str);
+        return -1;
+    }
+
+    if (e->entry.key == NULL) e->exported = 0;
+    else free(e->str);
+
+    e->str = str;
+    e->entry.key = str;
+    if (exported && !e->exported) {
+        e->exported = 1;
+        num_exported++;
+    }
+    if (e->exported) generation++;
+    return 0;
+}
+
+/** @brief Chargement de l'environnement reçu au démarrage (toutes les variables sont exportées). */
+static void load_environ(void) {
+    loaded = 1;
+    for (char** env = environ; env && *env; env++) {
+        const char* eq = strchr(*env, '=');
+        if (eq == NULL || eq == *env) continue;
+        char* str = strdup(*env);
+        if (str) store(str, eq - *env, 1);
+    }
+}
+
+/** @brief Vérification d'un nom de variable (non vide, sans '='). */
+static int valid_name(const char* name) {
+    if (name == NULL || *name == '\0' || strchr(name, '=') != NULL) {
+        errno = EINVAL;
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Fonction de lecture d'une variable dont le nom n'est pas terminé par '\0'. */
+const char* vars_get_n(const char* name, size_t len) {
+    if (!loaded) load_environ();
+    var_entry_t* e = (var_entry_t*)hash_find(&table, name, len, hash_name(name, len));
+    return e ? e->str + e->entry.key_len + 1 : NULL;
+}
+
+/** @brief Fonction de lecture d'une variable. */
+const char* vars_get(const char* name) {
+    return name ? vars_get_n(name, strlen(name)) : NULL;
+}
+
+/** @brief Fonction de création ou de modification d'une variable. */
+int vars_set(const char* name, const char* value, int exported) {
+    if (!valid_name(name) || value == NULL) return -1;
+    if (!loaded) load_environ();
+
+    size_t name_len = strlen(name);
+    size_t value_len = strlen(value);
+    char* str = malloc(name_len + value_len + 2);
+    if (!str) return -1;
+    memcpy(str, name, name_len);
+    str[name_len] = '=';
+    memcpy(str + name_len + 1, value, value_len + 1);
+    return store(str, name_len, exported);
+}
+
+/** @brief Fonction de suppression d'une variable. */
+int vars_unset(const char* name) {
+    if (!valid_name(name)) return -1;
+    if (!loaded) load_environ();
+
+    size_t len = strlen(name);
+    var_entry_t* e = (var_entry_t*)hash_find(&table, name, len, hash_name(name, len));
+    if (e == NULL) return 0;
+
+    if (e->exported) {
+        num_exported--;
+        generation++;
+    }
+    free(e->str);
+    hash_remove(&table, &e->entry);
+    return 0;
+}
+
+/** @brief Fonction d'accès à l'environnement des commandes lancées. */
+char** vars_environ(void) {
+    if (!loaded) load_environ();
+    if (envp != NULL && envp_generation == generation) return envp;
+
+    char** new_envp = realloc(envp, (num_exported + 1) * sizeof(char*));
+    if (!new_envp) return envp ? envp : environ;
+    envp = new_envp;
+
+    size_t n = 0;
+    for (size_t i = 0; i < table.capacity; i++) {
+        var_entry_t* e = (var_entry_t*)HASH_SLOT(&table, i);
+        if (e->entry.key != NULL && e->exported) envp[n++] = e->str;
+    }
+    envp[n] = NULL;
+    envp_generation = generation;
+    return envp;
+}
+
+/** @brief Vérification si deux chaînes "NOM=valeur" portent le même nom. */
+static int same_name(const char* a, const char* b) {
+    while (*a == *b && *a != '=' && *a != '\0') {
+        a++;
+        b++;
+    }
+    return (*a == '=' || *a == '\0') && (*b == '=' || *b == '\0');
+}
+
+/** @brief Vérification si une chaîne "NOM=valeur" est masquée par l'une des *n* premières affectations. */
+static int masked(const char* str, char* const* overlay, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (overlay[i][0] == str[0] && same_name(overlay[i], str)) return 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction de construction de l'environnement d'une commande précédée d'affectations. */
+char** vars_environ_overlay(char* const* overlay, arena_t* arena) {
+    char** base = vars_environ();
+    size_t num_overlay = 0;
+    while (overlay[num_overlay] != NULL) num_overlay++;
+
+    char** env = arena_alloc(arena, (num_exported + num_overlay + 1) * sizeof(char*));
+    if (!env) return NULL;
+
+    size_t n = 0;
+    for (char** p = base; *p != NULL; p++) {
+        if (!masked(*p, overlay, num_overlay)) env[n++] = *p;
+    }
+    for (size_t i = 0; i < num_overlay; i++) {
+        if (!masked(overlay[i], overlay + i + 1, num_overlay - i - 1)) env[n++] = overlay[i];
+    }
+    env[n] = NULL;
+    return env;
+}
+
+/** @brief Comparaison de deux chaînes "NOM=valeur" par nom pour qsort(). */
+static int compare_vars(const void* a, const void* b) {
+    const char* x = *(char* const*)a;
+    const char* y = *(char* const*)b;
+    while (*x == *y && *x != '=' && *x != '\0') {
+        x++;
+        y++;
+    }
+    // '=' termine le nom : il passe avant tout autre caractère
+    unsigned char cx = (*x == '=') ? 0 : (unsigned char)*x;
+    unsigned char cy = (*y == '=') ? 0 : (unsigned char)*y;
+    return (cx > cy) - (cx < cy);
+}
+
+/** @brief Fonction d'affichage des variables exportées. */
+void vars_print_exported(outbuf_t* out) {
+    char** env = vars_environ();
+    size_t n = 0;
+    while (env[n] != NULL) n++;
+
+    char** sorted = malloc((n + 1) * sizeof(char*));
+    if (!sorted) return;
+    memcpy(sorted, env, n * sizeof(char*));
+    qsort(sorted, n, sizeof(char*), compare_vars);
+    for (size_t i = 0; i < n; i++) out_printf(out, "%s\n", sorted[i]);
+    free(sorted);
+}
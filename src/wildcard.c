@@ -0,0 +1,538 @@
+/** @file wildcard.c
+ * @brief Implementation of pathname wildcard expansion
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'expansion des jokers : compilation des composants du motif, parcours des répertoires
+ *    composant par composant et cache des contenus de répertoires lus par *getdents64()*.
+ */
+
+#define _GNU_SOURCE // getdents64(), qsort_r()
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "wildcard.h"
+
+/// Nombre de répertoires gardés dans le cache
+#define DIR_CACHE_SIZE 32
+
+/// Taille du tampon des lectures de *getdents64()*
+#define DIRENT_BUF_SIZE (64 * 1024)
+
+/** @brief Entrée renvoyée par *getdents64()* (structure du noyau, non définie par la glibc). */
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/** @brief Entrée d'un répertoire. */
+typedef struct {
+    uint32_t offset;    ///< Début du nom dans *names*
+    unsigned char type; ///< Type de l'entrée (DT_DIR, DT_REG... DT_UNKNOWN si le système de fichiers ne le donne pas)
+} dir_entry_t;
+
+/** @brief Contenu d'un répertoire gardé dans le cache. */
+typedef struct {
+    dev_t dev;               ///< Périphérique du répertoire
+    ino_t ino;               ///< Inode du répertoire
+    struct timespec mtime;   ///< Date de modification du répertoire à la lecture
+    int racy;                ///< Lu moins d'une seconde après *mtime* : relu à la prochaine utilisation
+    int pinned;              ///< Nombre de parcours en cours sur ce contenu (case non réutilisable)
+    char* names;             ///< Noms concaténés, chacun terminé par '\0'
+    dir_entry_t* entries;    ///< Entrées, triées par nom (ordre des octets)
+    size_t count;            ///< Nombre d'entrées ("." et ".." exclus)
+    unsigned long last_use;  ///< Horloge de la dernière utilisation, 0 si la case est vide
+} dir_listing_t;
+
+static dir_listing_t cache[DIR_CACHE_SIZE];
+static unsigned long use_clock = 0;
+static unsigned long hits = 0;
+static unsigned long misses = 0;
+
+/** @brief Types d'opérations d'un composant compilé. */
+typedef enum {
+    OP_LITERAL, ///< Texte littéral
+    OP_ANY,     ///< ? : un caractère quelconque
+    OP_STAR,    ///< * : suite quelconque de caractères
+    OP_CLASS    ///< [...] : un caractère de la classe
+} wc_op_kind_t;
+
+/** @brief Opération d'un composant compilé. */
+typedef struct {
+    wc_op_kind_t kind; ///< Type de l'opération
+    const char* text;  ///< Texte littéral (OP_LITERAL)
+    size_t len;        ///< Longueur du texte littéral
+    uint64_t set[4];   ///< Caractères acceptés (OP_CLASS), un bit par octet
+} wc_op_t;
+
+/** @brief Composant de motif compilé. */
+typedef struct {
+    wc_op_t* ops;      ///< Opérations, sans deux étoiles consécutives
+    size_t num_ops;    ///< Nombre d'opérations
+    char* text;        ///< Textes littéraux, sans les '\\' de protection
+    size_t min_len;    ///< Longueur minimale d'un nom accepté
+    int dot;           ///< Le composant commence par un '.' littéral (noms cachés acceptés)
+} wc_matcher_t;
+
+/** @brief Classes de caractères nommées ([:alpha:]...). */
+static const struct {
+    const char* name;
+    int (*accepts)(int);
+} named_classes[] = {
+    {"alnum", isalnum}, {"alpha", isalpha}, {"blank", isblank}, {"cntrl", iscntrl}, {"digit", isdigit}, {"graph", isgraph},
+    {"lower", islower}, {"print", isprint}, {"punct", ispunct}, {"space", isspace}, {"upper", isupper}, {"xdigit", isxdigit},
+};
+
+/** @brief Lecture d'une classe [...] du motif.
+ * @param p Pointeur sur le '['.
+ * @param len Nombre de caractères disponibles à partir de *p* (jusqu'à la fin du composant).
+ * @param set Caractères acceptés par la classe.
+ * @return size_t Nombre de caractères de la classe, ']' compris ; 0 si elle n'est pas fermée (le '[' est alors littéral).
+ */
+static size_t parse_class(const char* p, size_t len, uint64_t set[4]) {
+    size_t i = 1;
+    int negate = 0;
+
+    memset(set, 0, 4 * sizeof(uint64_t));
+    if (i < len && (p[i] == '!' || p[i] == '^')) {
+        negate = 1;
+        i++;
+    }
+
+    // Un ']' placé en premier fait partie de la classe
+    size_t first = i;
+    while (i < len && (p[i] != ']' || i == first)) {
+        if (p[i] == '[' && i + 1 < len && p[i + 1] == ':') {
+            const char* end = memmem(p + i + 2, len - i - 2, ":]", 2);
+            size_t k = 0, name_len = end ? (size_t)(end - (p + i + 2)) : 0;
+            for (; end && k < sizeof(named_classes) / sizeof(named_classes[0]); k++) {
+                if (strlen(named_classes[k].name) == name_len && memcmp(named_classes[k].name, p + i + 2, name_len) == 0) break;
+            }
+            if (end && k < sizeof(named_classes) / sizeof(named_classes[0])) {
+                for (unsigned c = 0; c < 256; c++) {
+                    if (named_classes[k].accepts(c)) set[c >> 6] |= (uint64_t)1 << (c & 63);
+                }
+                i = end + 2 - p;
+                continue;
+            }
+        }
+
+        unsigned char lo = p[i];
+        if (lo == '\\' && i + 1 < len) lo = p[++i];
+        i++;
+        unsigned char hi = lo;
+        if (i + 1 < len && p[i] == '-' && p[i + 1] != ']') {
+            i++;
+            hi = p[i];
+            if (hi == '\\' && i + 1 < len) hi = p[++i];
+            i++;
+        }
+        for (unsigned c = lo; c <= hi; c++) set[c >> 6] |= (uint64_t)1 << (c & 63);
+    }
+    if (i >= len) return 0;
+
+    if (negate) {
+        for (int k = 0; k < 4; k++) set[k] = ~set[k];
+    }
+    return i + 1;
+}
+
+/** @brief Détection des jokers dans les *len* premiers caractères d'un motif. */
+static int has_magic(const char* p, size_t len) {
+    uint64_t set[4];
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] == '\\') i++;
+        else if (p[i] == '*' || p[i] == '?') return 1;
+        else if (p[i] == '[' && parse_class(p + i, strcspn(p + i, "/"), set) > 0) return 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction de détection des jokers dans un motif. */
+int wildcard_has_magic(const char* pattern) {
+    return has_magic(pattern, strlen(pattern));
+}
+
+/** @brief Compilation d'un composant de motif (sans '/').
+ * @return int 0 en cas de succès, -1 en cas d'échec d'allocation.
+ */
+static int compile_component(const char* p, size_t len, wc_matcher_t* m) {
+    m->ops = malloc((len + 1) * sizeof(wc_op_t));
+    m->text = malloc(len + 1);
+    m->num_ops = 0;
+    m->min_len = 0;
+    if (!m->ops || !m->text) {
+        free(m->ops);
+        free(m->text);
+        return -1;
+    }
+
+    size_t text_len = 0;
+    for (size_t i = 0; i < len; ) {
+        wc_op_t* last = m->num_ops ? &m->ops[m->num_ops - 1] : NULL;
+        wc_op_t* op = &m->ops[m->num_ops];
+        size_t n;
+
+        if (p[i] == '*') {
+            if (!last || last->kind != OP_STAR) {
+                op->kind = OP_STAR;
+                m->num_ops++;
+            }
+            i++;
+        } else if (p[i] == '?') {
+            op->kind = OP_ANY;
+            m->num_ops++;
+            m->min_len++;
+            i++;
+        } else if (p[i] == '[' && (n = parse_class(p + i, len - i, op->set)) > 0) {
+            op->kind = OP_CLASS;
+            m->num_ops++;
+            m->min_len++;
+            i += n;
+        } else {
+            // Caractère littéral, ajouté au littéral précédent s'il le suit directement
+            char c = p[i];
+            if (c == '\\' && i + 1 < len) c = p[++i];
+            i++;
+            if (!last || last->kind != OP_LITERAL) {
+                op->kind = OP_LITERAL;
+                op->text = m->text + text_len;
+                op->len = 0;
+                m->num_ops++;
+                last = op;
+            }
+            m->text[text_len++] = c;
+            last->len++;
+            m->min_len++;
+        }
+    }
+    m->dot = m->num_ops > 0 && m->ops[0].kind == OP_LITERAL && m->ops[0].text[0] == '.';
+    return 0;
+}
+
+/** @brief Confrontation d'un nom à un composant compilé.
+ * @details Les opérations autres que '*' acceptent un nombre fixe de caractères : en cas d'échec, il suffit de
+ *    laisser la dernière étoile rencontrée absorber un caractère de plus, sans retour plus loin en arrière.
+ */
+static int match_name(const wc_matcher_t* m, const char* s, size_t len) {
+    if (len < m->min_len) return 0;
+    if (s[0] == '.' && !m->dot) return 0;
+
+    size_t i = 0, j = 0, star_i = SIZE_MAX, star_j = 0;
+    while (1) {
+        if (i < m->num_ops) {
+            const wc_op_t* op = &m->ops[i];
+            unsigned char c = (j < len) ? (unsigned char)s[j] : 0;
+            switch (op->kind) {
+                case OP_STAR:
+                    star_i = i++;
+                    star_j = j;
+                    if (i == m->num_ops) return 1; // Étoile finale : le reste du nom est accepté
+                    continue;
+                case OP_ANY:
+                    if (j < len) { i++; j++; continue; }
+                    break;
+                case OP_CLASS:
+                    if (j < len && (op->set[c >> 6] >> (c & 63) & 1)) { i++; j++; continue; }
+                    break;
+                case OP_LITERAL:
+                    if (len - j >= op->len && memcmp(s + j, op->text, op->len) == 0) { i++; j += op->len; continue; }
+                    break;
+            }
+        } else if (j == len) {
+            return 1;
+        }
+
+        // Échec : la dernière étoile absorbe un caractère de plus (jusqu'au prochain début possible du littéral qui la suit)
+        if (star_i == SIZE_MAX || star_j >= len) return 0;
+        star_j++;
+        const wc_op_t* next = &m->ops[star_i + 1];
+        if (next->kind == OP_LITERAL) {
+            const char* q = memchr(s + star_j, next->text[0], len - star_j);
+            if (!q) return 0;
+            star_j = q - s;
+        }
+        i = star_i + 1;
+        j = star_j;
+    }
+}
+
+/** @brief Comparaison de deux entrées par nom (qsort_r, *arg* : noms concaténés). */
+static int compare_entries(const void* a, const void* b, void* arg) {
+    const char* names = arg;
+    return strcmp(names + ((const dir_entry_t*)a)->offset, names + ((const dir_entry_t*)b)->offset);
+}
+
+/** @brief Lecture complète d'un répertoire ouvert dans une case du cache.
+ * @return int 0 en cas de succès, -1 en cas d'erreur de lecture ou d'échec d'allocation (la case est alors vidée).
+ */
+static int read_listing(int fd, dir_listing_t* l) {
+    static char buf[DIRENT_BUF_SIZE];
+    char* names = NULL;
+    dir_entry_t* entries = NULL;
+    size_t names_len = 0, names_cap = 0, count = 0, cap = 0;
+    ssize_t n;
+
+    while ((n = getdents64(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t pos = 0; pos < n; ) {
+            const struct linux_dirent64* d = (const struct linux_dirent64*)(buf + pos);
+            pos += d->d_reclen;
+            const char* name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            size_t len = strlen(name) + 1;
+            if (names_len + len > names_cap) {
+                names_cap = names_cap ? names_cap * 2 : 4096;
+                while (names_len + len > names_cap) names_cap *= 2;
+                char* new_names = realloc(names, names_cap);
+                if (!new_names) goto error;
+                names = new_names;
+            }
+            if (count == cap) {
+                cap = cap ? cap * 2 : 256;
+                dir_entry_t* new_entries = realloc(entries, cap * sizeof(dir_entry_t));
+                if (!new_entries) goto error;
+                entries = new_entries;
+            }
+            memcpy(names + names_len, name, len);
+            entries[count++] = (dir_entry_t){(uint32_t)names_len, d->d_type};
+            names_len += len;
+        }
+    }
+    if (n < 0) goto error;
+
+    if (count > 1) qsort_r(entries, count, sizeof(dir_entry_t), compare_entries, names);
+    free(l->names);
+    free(l->entries);
+    l->names = names;
+    l->entries = entries;
+    l->count = count;
+    return 0;
+
+error:
+    free(names);
+    free(entries);
+    free(l->names);
+    free(l->entries);
+    memset(l, 0, sizeof(*l));
+    return -1;
+}
+
+/** @brief Contenu d'un répertoire, depuis le cache s'il n'a pas été modifié depuis sa lecture.
+ * @return dir_listing_t* Contenu du répertoire, NULL s'il est illisible (ou si toutes les cases sont en cours de parcours).
+ */
+static dir_listing_t* get_listing(const char* dir) {
+    struct stat st;
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) return NULL;
+
+    dir_listing_t* slot = NULL;
+    dir_listing_t* victim = NULL;
+    for (int i = 0; i < DIR_CACHE_SIZE; i++) {
+        dir_listing_t* l = &cache[i];
+        if (l->last_use != 0 && l->dev == st.st_dev && l->ino == st.st_ino) {
+            slot = l;
+            break;
+        }
+        if (!l->pinned && (victim == NULL || l->last_use < victim->last_use)) victim = l;
+    }
+
+    // Contenu à jour (ou en cours de parcours : il ne peut pas être remplacé)
+    if (slot != NULL && (slot->pinned || (!slot->racy && slot->mtime.tv_sec == st.st_mtim.tv_sec &&
+                                          slot->mtime.tv_nsec == st.st_mtim.tv_nsec))) {
+        hits++;
+        slot->last_use = ++use_clock;
+        return slot;
+    }
+    misses++;
+    if (slot == NULL) slot = victim;
+    if (slot == NULL) return NULL;
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+
+    // Date lue avant le contenu : une modification postérieure à la lecture donnera une date plus récente
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    int ret = read_listing(fd, slot);
+    close(fd);
+    if (ret != 0) return NULL;
+
+    slot->dev = st.st_dev;
+    slot->ino = st.st_ino;
+    slot->mtime = st.st_mtim;
+    slot->racy = (now.tv_sec - st.st_mtim.tv_sec) * 1000000000LL + (now.tv_nsec - st.st_mtim.tv_nsec) < 1000000000LL;
+    slot->last_use = ++use_clock;
+    return slot;
+}
+
+/** @brief Parcours en cours : chemin construit et chemins trouvés. */
+typedef struct {
+    char path[PATH_MAX]; ///< Chemin du répertoire courant, terminé par '/' s'il n'est pas vide
+    char** matches;      ///< Chemins trouvés (alloués dans l'arène)
+    size_t count;        ///< Nombre de chemins trouvés
+    size_t cap;          ///< Taille allouée pour *matches*
+    arena_t* arena;      ///< Arène des chemins
+    int error;           ///< Échec d'allocation
+} walk_t;
+
+/** @brief Ajout du chemin courant (de longueur *len*) aux chemins trouvés. */
+static void add_match(walk_t* w, size_t len) {
+    if (w->count == w->cap) {
+        size_t cap = w->cap ? w->cap * 2 : 16;
+        char** matches = realloc(w->matches, cap * sizeof(char*));
+        if (!matches) {
+            w->error = 1;
+            return;
+        }
+        w->matches = matches;
+        w->cap = cap;
+    }
+    char* match = arena_strndup(w->arena, w->path, len);
+    if (!match) {
+        w->error = 1;
+        return;
+    }
+    w->matches[w->count++] = match;
+}
+
+/** @brief Vérification qu'une entrée est un répertoire (*d_type*, ou *stat()* pour un lien ou un type inconnu). */
+static int is_directory(walk_t* w, size_t len, unsigned char type) {
+    if (type == DT_DIR) return 1;
+    if (type != DT_LNK && type != DT_UNKNOWN) return 0;
+    struct stat st;
+    w->path[len] = '\0';
+    return stat(w->path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/** @brief Expansion des composants *rest* du motif dans le répertoire *w->path* (de longueur *len*). */
+static void walk(walk_t* w, size_t len, const char* rest) {
+    size_t comp_len = strcspn(rest, "/");
+    const char* next = rest + comp_len;
+    while (*next == '/') next++;
+    int last = (*next == '\0');
+    int dir_only = last && rest[comp_len] == '/'; // Motif terminé par '/' : répertoires uniquement
+
+    // Composant sans joker : ajouté tel quel au chemin (sans les '\\' de protection)
+    if (!has_magic(rest, comp_len)) {
+        size_t n = len;
+        for (size_t i = 0; i < comp_len && n < PATH_MAX - 2; i++) {
+            if (rest[i] == '\\' && i + 1 < comp_len) i++;
+            w->path[n++] = rest[i];
+        }
+        if (n >= PATH_MAX - 2) return;
+        if (!last) {
+            w->path[n++] = '/';
+            walk(w, n, next);
+            return;
+        }
+        struct stat st;
+        w->path[n] = '\0';
+        if (lstat(w->path, &st) != 0) return;
+        if (dir_only) {
+            if (!is_directory(w, n, S_ISLNK(st.st_mode) ? DT_LNK : (S_ISDIR(st.st_mode) ? DT_DIR : DT_REG))) return;
+            w->path[n++] = '/';
+        }
+        add_match(w, n);
+        return;
+    }
+
+    wc_matcher_t m;
+    if (compile_component(rest, comp_len, &m) != 0) {
+        w->error = 1;
+        return;
+    }
+    w->path[len] = '\0';
+    dir_listing_t* l = get_listing(len ? w->path : ".");
+    if (l != NULL) {
+        l->pinned++;
+        for (size_t e = 0; e < l->count && !w->error; e++) {
+            const char* name = l->names + l->entries[e].offset;
+            size_t name_len = strlen(name);
+            if (!match_name(&m, name, name_len) || len + name_len + 2 > PATH_MAX) continue;
+
+            memcpy(w->path + len, name, name_len);
+            size_t n = len + name_len;
+            if ((!last || dir_only) && !is_directory(w, n, l->entries[e].type)) continue;
+            if (!last) {
+                w->path[n] = '/';
+                walk(w, n + 1, next);
+            } else {
+                if (dir_only) w->path[n++] = '/';
+                add_match(w, n);
+            }
+        }
+        l->pinned--;
+    }
+    free(m.ops);
+    free(m.text);
+}
+
+/** @brief Fonction d'expansion d'un motif en chemins existants. */
+int wildcard_expand(const char* pattern, arena_t* arena, char*** matches) {
+    walk_t* w = malloc(sizeof(walk_t));
+    if (!w) return -1;
+    w->matches = NULL;
+    w->count = w->cap = 0;
+    w->arena = arena;
+    w->error = 0;
+
+    // Chemin absolu : la racine est le premier répertoire parcouru
+    size_t len = 0;
+    if (pattern[0] == '/') {
+        w->path[len++] = '/';
+        while (*pattern == '/') pattern++;
+    }
+    if (*pattern != '\0') walk(w, len, pattern);
+
+    int count = (int)w->count;
+    *matches = NULL;
+    if (!w->error && count > 0) {
+        *matches = arena_alloc(arena, count * sizeof(char*));
+        if (*matches) memcpy(*matches, w->matches, count * sizeof(char*));
+    }
+    if (w->error || (count > 0 && *matches == NULL)) count = -1;
+    free(w->matches);
+    free(w);
+    return count;
+}
+
+/** @brief Fonction de vidage du cache des répertoires. */
+void wildcard_reset(void) {
+    for (int i = 0; i < DIR_CACHE_SIZE; i++) {
+        if (cache[i].pinned) continue;
+        free(cache[i].names);
+        free(cache[i].entries);
+        memset(&cache[i], 0, sizeof(cache[i]));
+    }
+    hits = misses = 0;
+}
+
+/** @brief Fonction d'affichage des statistiques du cache des répertoires. */
+void wildcard_print(outbuf_t* out) {
+    size_t used = 0, entries = 0;
+    for (int i = 0; i < DIR_CACHE_SIZE; i++) {
+        if (cache[i].last_use == 0) continue;
+        used++;
+        entries += cache[i].count;
+    }
+    unsigned long lookups = hits + misses;
+    out_printf(out, "répertoires\t%zu/%d\n", used, DIR_CACHE_SIZE);
+    out_printf(out, "noms\t\t%zu\n", entries);
+    out_printf(out, "succès\t\t%lu (%.1f%%)\n", hits, lookups ? 100.0 * hits / lookups : 0.0);
+    out_printf(out, "échecs\t\t%lu\n", misses);
+}
@@ -28,6 +28,14 @@ run "Commande inconnue" "commande_inconnue"
 # ==================================================
 run "Foreground" "sleep 1; echo done"
 run "Background (&)" $'sleep 1 &\necho bg_ok'
+run "Tâches : wait et jobs" $'sleep 0.2 &\nfalse &\nwait $!\necho statut $?\nwait\njobs\nwait %9\necho statut $?\nsleep 0.1 & wait $!; echo meme ligne $?\nfalse & wait $! %9\necho statut $?'
+run "Tâches terminées retirées en début de ligne" $'false &\nsleep 0.1\njobs\nwait $!\necho statut $?'
+
+# Tâche terminée pendant une attente au premier plan : sa durée est celle du processus, pas celle de la ligne
+echo ">>> Date de fin d'une tâche en arrière-plan" >> "$OUT"
+$SHELL_BIN -c 'sleep 0.1 & sleep 0.6; jobs' | awk '{ print ($3 + 0 < 0.5) ? "fin à la terminaison" : "fin tardive " $3 }' >> "$OUT"
+echo "----------------------------------------" >> "$OUT"
+run "parallel (ordre des sorties, échecs)" $'seq 4 | parallel -j 3 sh -c \'sleep 0.$((5-{})); echo fin {}\'\nprintf "0\\\\n3\\\\n\\\\n0\\\\n" | parallel -j0 sh -c \'exit {}\'\necho statut $?\nparallel\necho x | parallel -j commande_inconnue'
 
 # ==================================================
 # 3. INVERSION (!)
@@ -62,6 +70,12 @@ run "Redirection stdout >" $'echo hello > out.txt\ncat out.txt'
 run "Redirection stdout >>" $'echo world >> out.txt\ncat out.txt'
 run "Redirection stderr 2>" $'ls fichier_inexistant 2> err.txt\ncat err.txt'
 run "Redirection stderr 2>>" $'ls fichier_inexistant 2>> err.txt\ncat err.txt'
+run "Documents en ligne << <<- <<<" $'export V=1\ncat <<FIN\nv=$V \\\\$V "g"\nFIN\ncat <<\'BRUT\' | wc -c\n$V\nBRUT\ntr a-z A-Z <<-FIN\n\tindente\n\tFIN\nwc -w <<< "un deux $V"\ncat <<A <<B\nignore\nA\ngarde\nB\necho fin'
+
+# Petit corps dans un tube, gros corps (plus que la capacité d'un tube) dans un fichier anonyme en mémoire
+echo ">>> Document en ligne : tube ou fichier en mémoire" >> "$OUT"
+{ printf '%s\n' 'readlink /proc/self/fd/0 <<FIN' petit FIN 'wc -l <<FIN'; seq 20000; printf '%s\n' FIN 'readlink /proc/self/fd/0 <<FIN'; seq 20000; echo FIN; } | $SHELL_BIN 2>&1 | sed 's/pipe:\[[0-9]*\]/pipe/' >> "$OUT"
+echo "----------------------------------------" >> "$OUT"
 
 # ==================================================
 # 8. REDIRECTIONS AVANCEES
@@ -91,12 +105,25 @@ run "cd /" $'cd /\npwd'
 run "cd ~" $'cd ~\npwd'
 run "cd erreur" "cd dossier_inexistant"
 run "export / unset" $'export TEST=42\necho $TEST\nunset TEST\necho $TEST'
+run "Environnement des commandes" $'export A_VAR=1\nenv | grep ^A_VAR=\nexport A_VAR=2\nexport B_VAR=3\nsh -c \'echo $A_VAR\'\nunset A_VAR\nenv | grep -c ^A_VAR=\nexport | grep ^B_VAR'
+run "Affectations NOM=valeur" $'A_VAR=1 B_VAR=2 env | grep _VAR= | sort\nA_VAR=1 A_VAR=3 sh -c \'echo $A_VAR\'\necho [$A_VAR]\nC_VAR=5\necho $C_VAR\nenv | grep -c ^C_VAR=\nexport C_VAR\nenv | grep ^C_VAR=\nD_VAR=5; echo meme ligne $D_VAR'
+run "alias / unalias" $'alias ll=\'echo -n un; echo deux\' e=\'echo \' x=arg\nll\ne x\nalias a2=ll ls=\'ls -d /\'\na2 | wc -l\nls\n\\\\ll\nalias\nunalias ll\nll\nalias ll\necho $?'
 
 # ==================================================
 # 12. VARIABLES ET SUBSTITUTIONS
 # ==================================================
 run "Variable d'environnement" "echo $HOME"
 run "Substitution $?" $'true\necho $?\nfalse\necho $?'
+run "Guillemets et echappements" $'echo "a  b" \'$HOME\' c\\ d "$HOME"'
+run "echo et printf intégrés" $'echo -n a; echo -e "b\\\\tc"\nprintf "%s=%03d|%-4s|%x\\\\n" n 7 ab 255 a 1\nprintf "%b\\\\n" "x\\\\ty"'
+run "test et [ intégrés" $'test 1 -lt 2 -a -d /\necho $?\n[ a = b ] || echo faux\n! [ -z "" ]\necho $?\n[ 1 -eq x\necho $?'
+run "Substitution de commande" $'echo [$(pwd | wc -l)] "$(echo a   b)" x$(true)y\nprintf "<%s>\\\\n" $(printf "un\\\\ndeux trois\\\\n\\\\n")\necho $(echo $(echo imbrique)) "$(echo "(x)")"\necho $(cd /; pwd)\n[ "$(pwd)" = / ] || echo cwd inchange\necho $(exit 3) suite\nX=$(ls -d /)\necho "$X"\ncat <<FIN\ncorps $(echo ok)\nFIN\necho $(echo\nfalse && echo $(touch sidefx)\n[ -e sidefx ] || echo commande sautee sans effet\ncd /; echo $(pwd) $(ls -d b*)\necho $((1)) "$((2))"'
+run "Substitution de commande tuée par un signal" $'echo [$(cd /; sh -c "kill -9 \\$PPID")] $?\nsh -c "kill -9 \\$\\$"\necho $?'
+run "Jokers * ? [...]" $'mkdir -p jk/d1 jk/d2\ntouch jk/a.c jk/b.c jk/c.h jk/.cache jk/d1/m.c\ncd jk\necho *.c\necho * .*\necho .? .[.] .*/\necho "*".c \\\\* [!a].c ?.h\necho */ */m.c\necho aucun*\ncd ..\nrm -r jk\nglobcache -r\nls -d /e?c > /dev/null\nls -d /e?c\nglobcache | grep -v noms'
+run "Ligne de plus de 4096 caracteres" "echo $(printf 'a%.0s' {1..5000}) | wc -c"
+run "Ligne de plus de 64 Kio" "echo $(printf 'a%.0s' {1..70000}) | wc -c"
+run "Continuation de ligne (\\)" $'echo un \\\\\ndeux \\\\\n| wc -w'
+run "Operateurs sans espaces" $'echo a>out.txt;cat<out.txt&&echo OK'
 
 # ==================================================
 # 13. SYNTAX ERRORS
@@ -113,6 +140,57 @@ printf "exit 42\n" | $SHELL_BIN
 echo "Code de sortie minishell (bash): $?" >> "$OUT"
 echo "----------------------------------------" >> "$OUT"
 
+# ==================================================
+# 15. OPTIONS DU SHELL
+# ==================================================
+run "hash (cache PATH)" $'ls > /dev/null\ncommande_inconnue 2> /dev/null\nhash\nhash -r\nhash'
+mkdir -p nsb
+printf 'echo from-script $1\n' > nsb/s && chmod +x nsb/s
+printf 'echo jamais\n' > nsb/np && chmod -x nsb/np
+run "Script sans #! (ENOEXEC)" $'./nsb/s arg\necho statut $?'
+run "Fichier non exécutable" $'./nsb/np\necho statut $?'
+run "Échecs de lancement : fork et posix_spawn" $'set -o spawn=fork\n./nsb/s a\n./nsb/np; echo statut $?\ncommande_inconnue; echo statut $?\nset -o spawn=posix_spawn\n./nsb/s a\n./nsb/np; echo statut $?\ncommande_inconnue; echo statut $?'
+rm -r nsb
+run "set -o spawn=posix_spawn" $'set -o spawn=posix_spawn\nset\necho hello | wc -c\ncommande_inconnue'
+run "plancache (lignes répétées)" $'export X=1\necho $X | cat\nexport X=2\necho $X | cat\nplancache -r\necho a > /dev/null\necho a > /dev/null\nplancache\nset -o plancache=0\nplancache'
+
+# ==================================================
+# 16. MODES SCRIPT ET -c
+# ==================================================
+echo ">>> minishell -c" >> "$OUT"
+$SHELL_BIN -c $'echo $0 $# $1\nfalse' nom arg >> "$OUT" 2>&1
+echo "statut $?" >> "$OUT"
+echo "----------------------------------------" >> "$OUT"
+
+echo ">>> minishell script.sh" >> "$OUT"
+printf '%s\n' '#!/usr/bin/env minishell' '# commentaire' 'echo script $1 $2 | wc -w' 'exit 4' > test_script.sh
+$SHELL_BIN test_script.sh a b >> "$OUT" 2>&1
+echo "statut $?" >> "$OUT"
+rm -f test_script.sh
+echo "----------------------------------------" >> "$OUT"
+
+# Les durées varient d'une exécution à l'autre : seuls les libellés du rapport de time sont comparés
+echo ">>> time (liste && et tube)" >> "$OUT"
+$SHELL_BIN -c 'time false && echo non || echo oui | cat' 2>&1 | sed 's/[0-9][0-9.]*/N/g' >> "$OUT"
+echo "----------------------------------------" >> "$OUT"
+
+# Journal d'exécution : seuls le type et le rang de chaque événement sont comparés
+echo ">>> journal d'exécution (MINISHELL_TRACE)" >> "$OUT"
+rm -f trace.log
+MINISHELL_TRACE=trace.log $SHELL_BIN -c $'ls < /dev/null | cat > /dev/null\nls > /dev/null\nls > /dev/null' >> "$OUT" 2>&1
+sed 's/.*"event":"\([a-z]*\)","flow":\(-*[0-9]*\).*/\1 \2/' trace.log | sort | uniq -c >> "$OUT"
+rm -f trace.log
+echo "----------------------------------------" >> "$OUT"
+
+# Substitution de commande : commandes intégrées pures dans le shell (aucun fork), cd dans un sous-shell
+echo ">>> substitution sans fork (MINISHELL_TRACE)" >> "$OUT"
+rm -f trace.log
+MINISHELL_TRACE=trace.log $SHELL_BIN -c 'echo $(pwd) > /dev/null; echo $(echo a) $(printf b)' >> "$OUT" 2>&1
+MINISHELL_TRACE=trace.log $SHELL_BIN -c 'echo $(cd /; pwd)' >> "$OUT" 2>&1
+sed 's/.*"event":"\([a-z]*\)","flow":\(-*[0-9]*\).*/\1 \2/' trace.log | sort | uniq -c >> "$OUT"
+rm -f trace.log
+echo "----------------------------------------" >> "$OUT"
+
 # ==================================================
 # FIN
 # ==================================================
@@ -60,6 +60,9 @@ run "stdout vers stderr puis pipe" "echo hello >&2 | wc -c"
 # 9. PIPE + BUILTIN
 # ==================================================
 run "builtin dans pipe (pwd | wc -c)" "pwd | wc -c"
+run "builtin en fin de pipe (ls | pwd | wc -l)" "ls | pwd | wc -l"
+run "builtin vers pipe fermé (pwd | true)" $'pwd | true\necho $?'
+run "cat, tee, head et wc intégrés" $'seq 1 1000 > nums.txt\ncat nums.txt | tee copie.txt | head -n 3\nwc -l copie.txt\nhead -c 4 < nums.txt | wc -c\nyes | head -n 2\ncat absent.txt\nwc -w nums.txt\nrm -f nums.txt copie.txt'
 
 # ==================================================
 # 10. PIPE EN DEBUT (ERREUR)
@@ -77,6 +80,24 @@ run "Pipe en fin (erreur)" "ls |"
 run "Pipe + &&" "ls | wc -l && echo OK"
 run "Pipe + ||" "ls fichier_inexistant | wc -l || echo FAIL"
 
+# ==================================================
+# 13. ETAGES CONCURRENTS (plus de 64 Kio dans le tube)
+# ==================================================
+run "Gros volume dans un tube" "seq 1 200000 | wc -l"
+run "Tube saute puis ||" "false && ls | wc -l || echo SKIP"
+
+# ==================================================
+# 14. DESCRIPTEURS HERITES (seuls 0, 1, 2 et celui de ls)
+# ==================================================
+run "Descripteurs des étages" $'echo a | ls /proc/self/fd < /dev/null | cat\nset -o spawn=posix_spawn\nls /proc/self/fd 2> /dev/null | wc -l'
+run "Tube de 500 étages" "echo fin$(printf ' | cat%.0s' {1..500})"
+
+# ==================================================
+# 15. CAPACITE DES TUBES (option pipesize, |{TAILLE})
+# ==================================================
+run "Capacité des tubes" $'set -o pipesize=1M\nset | grep pipesize\nseq 1 200000 |{256K} wc -l\nseq 1 200000 | cat |{64k} wc -c'
+run "Taille de tube invalide" $'echo a |{1G} cat\nset -o pipesize=x\necho statut $?'
+
 # ==================================================
 # FIN
 # ==================================================